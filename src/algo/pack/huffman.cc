@@ -16,11 +16,37 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/huffman.h"
-#include "io/msb_bit_stream.h"
+#include <algorithm>
+#include <array>
+#include "algo/range.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::algo::pack;
 
+// children of decoder nodes are either node indices, leaves marked with
+// leaf_flag, or missing_child for codes that were never assigned
+static const u32 leaf_flag = 0x10000;
+static const u32 symbol_mask = 0xFFFF;
+static const u32 missing_child = 0xFFFFFFFF;
+
+namespace
+{
+    enum class EntryType : u8
+    {
+        Leaf,
+        Node,
+        Invalid,
+    };
+
+    struct TableEntry final
+    {
+        u32 value;
+        u8 length;
+        EntryType type;
+    };
+}
+
 static int init_huffman_impl(
     io::BaseBitStream &input_stream, u16 nodes[2][512], int &size)
 {
@@ -48,20 +74,228 @@ HuffmanTree::HuffmanTree(const bstr &data)
     root = init_huffman_impl(input_stream, nodes, size);
 }
 
+struct HuffmanDecoder::Priv final
+{
+    Priv(const size_t lookup_bits);
+
+    u32 add_node();
+    u32 add_tree_node(
+        const HuffmanTree &huffman_tree, const u16 value, const size_t depth);
+    void add_code(const u32 code, const size_t length, const u16 symbol);
+    void build_table();
+    void fill_table(const u32 child, const size_t depth, const u32 prefix);
+
+    const size_t lookup_bits;
+    size_t table_bits;
+    size_t max_depth;
+    u32 root;
+    std::vector<std::array<u32, 2>> nodes;
+    std::vector<TableEntry> table;
+};
+
+HuffmanDecoder::Priv::Priv(const size_t lookup_bits) :
+    lookup_bits(lookup_bits),
+    table_bits(0),
+    max_depth(0),
+    root(missing_child)
+{
+}
+
+u32 HuffmanDecoder::Priv::add_node()
+{
+    nodes.push_back({missing_child, missing_child});
+    return nodes.size() - 1;
+}
+
+u32 HuffmanDecoder::Priv::add_tree_node(
+    const HuffmanTree &huffman_tree, const u16 value, const size_t depth)
+{
+    max_depth = std::max(max_depth, depth);
+    if (value < 256 || value > 511)
+        return leaf_flag | value;
+    const auto node = add_node();
+    for (const auto i : algo::range(2))
+    {
+        const auto child = add_tree_node(
+            huffman_tree, huffman_tree.nodes[i][value], depth + 1);
+        nodes[node][i] = child;
+    }
+    return node;
+}
+
+void HuffmanDecoder::Priv::add_code(
+    const u32 code, const size_t length, const u16 symbol)
+{
+    auto node = root;
+    const auto last_bit = static_cast<int>(length) - 1;
+    for (const auto i : algo::range(length))
+    {
+        const auto bit = (code >> (last_bit - i)) & 1;
+        auto &child = nodes[node][bit];
+        if (i == last_bit)
+        {
+            if (child != missing_child)
+                throw err::CorruptDataError("Overlapping Huffman codes");
+            child = leaf_flag | symbol;
+            break;
+        }
+        if (child == missing_child)
+        {
+            // take the index first, add_node() invalidates the reference
+            const auto new_node = add_node();
+            nodes[node][bit] = new_node;
+            node = new_node;
+        }
+        else if (child & leaf_flag)
+            throw err::CorruptDataError("Overlapping Huffman codes");
+        else
+            node = child;
+    }
+}
+
+void HuffmanDecoder::Priv::fill_table(
+    const u32 child, const size_t depth, const u32 prefix)
+{
+    if (child == missing_child || (child & leaf_flag))
+    {
+        const auto start = prefix << (table_bits - depth);
+        const auto count = 1u << (table_bits - depth);
+        const auto type = child == missing_child
+            ? EntryType::Invalid
+            : EntryType::Leaf;
+        for (const auto i : algo::range(start, start + count))
+        {
+            table[i].value = child & symbol_mask;
+            table[i].length = depth;
+            table[i].type = type;
+        }
+        return;
+    }
+    if (depth == table_bits)
+    {
+        table[prefix].value = child;
+        table[prefix].length = depth;
+        table[prefix].type = EntryType::Node;
+        return;
+    }
+    fill_table(nodes[child][0], depth + 1, prefix << 1);
+    fill_table(nodes[child][1], depth + 1, (prefix << 1) | 1);
+}
+
+void HuffmanDecoder::Priv::build_table()
+{
+    table_bits = std::min(lookup_bits, max_depth);
+    table.resize(1 << table_bits);
+    fill_table(root, 0, 0);
+}
+
+HuffmanDecoder::HuffmanDecoder(
+    const HuffmanTree &huffman_tree, const size_t lookup_bits)
+        : p(new Priv(lookup_bits))
+{
+    p->root = p->add_tree_node(huffman_tree, huffman_tree.root, 0);
+    p->build_table();
+}
+
+HuffmanDecoder::HuffmanDecoder(
+    const std::vector<u8> &code_lengths, const size_t lookup_bits)
+        : p(new Priv(lookup_bits))
+{
+    size_t max_length = 0;
+    for (const auto length : code_lengths)
+        max_length = std::max<size_t>(max_length, length);
+    if (!max_length)
+        throw err::CorruptDataError("No Huffman codes");
+    if (max_length > 32)
+        throw err::NotSupportedError("Huffman codes are too long");
+
+    std::vector<u32> length_counts(max_length + 1);
+    for (const auto length : code_lengths)
+        length_counts[length]++;
+    length_counts[0] = 0;
+
+    std::vector<u32> next_codes(max_length + 1);
+    u32 code = 0;
+    for (const auto length : algo::range(1, max_length + 1))
+    {
+        code = (code + length_counts[length - 1]) << 1;
+        next_codes[length] = code;
+    }
+
+    p->root = p->add_node();
+    p->max_depth = max_length;
+    for (const auto symbol : algo::range(code_lengths.size()))
+    {
+        const auto length = code_lengths[symbol];
+        if (!length)
+            continue;
+        if (next_codes[length] >> length)
+            throw err::CorruptDataError("Too many Huffman codes");
+        p->add_code(next_codes[length]++, length, symbol);
+    }
+    p->build_table();
+}
+
+HuffmanDecoder::~HuffmanDecoder()
+{
+}
+
+u16 HuffmanDecoder::decode(io::MsbBitStream &input_stream) const
+{
+    const auto &entry = p->table[input_stream.peek(p->table_bits)];
+    if (entry.type == EntryType::Leaf)
+    {
+        input_stream.read(entry.length);
+        return entry.value;
+    }
+    input_stream.read(entry.length);
+    if (entry.type == EntryType::Invalid)
+        throw err::CorruptDataError("Bad Huffman code");
+
+    auto node = entry.value;
+    while (true)
+    {
+        const auto child = p->nodes[node][input_stream.read(1)];
+        if (child == missing_child)
+            throw err::CorruptDataError("Bad Huffman code");
+        if (child & leaf_flag)
+            return child & symbol_mask;
+        node = child;
+    }
+}
+
+size_t HuffmanDecoder::decode(
+    io::MsbBitStream &input_stream,
+    u8 *output,
+    const size_t output_size) const
+{
+    auto bits_left = input_stream.left();
+    size_t output_pos = 0;
+    while (output_pos < output_size && bits_left)
+    {
+        const auto &entry = p->table[input_stream.peek(p->table_bits)];
+        if (entry.type == EntryType::Leaf && entry.length <= bits_left)
+        {
+            input_stream.read(entry.length);
+            bits_left -= entry.length;
+            output[output_pos++] = entry.value;
+            continue;
+        }
+        const auto pos = input_stream.pos();
+        output[output_pos++] = decode(input_stream);
+        bits_left -= input_stream.pos() - pos;
+    }
+    return output_pos;
+}
+
 bstr algo::pack::decode_huffman(
     const HuffmanTree &huffman_tree,
     const bstr &input,
     const size_t target_size)
 {
-    bstr output;
-    output.resize(target_size);
+    bstr output(target_size);
     io::MsbBitStream input_stream(input);
-    while (output.size() < target_size && input_stream.left())
-    {
-        auto byte = huffman_tree.root;
-        while (byte >= 256 && byte <= 511)
-            byte = huffman_tree.nodes[input_stream.read(1)][byte];
-        output += static_cast<const u8>(byte);
-    }
+    output.resize(HuffmanDecoder(huffman_tree).decode(
+        input_stream, output.get<u8>(), output.size()));
     return output;
 }
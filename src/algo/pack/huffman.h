@@ -17,12 +17,18 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
 #include "io/base_bit_stream.h"
+#include "io/msb_bit_stream.h"
 
 namespace au {
 namespace algo {
 namespace pack {
 
+    // Tree stored as a preorder sequence of bits: 1 introduces an inner node
+    // followed by its two subtrees, 0 introduces an 8-bit leaf value. Inner
+    // nodes are numbered from 256 up.
     struct HuffmanTree final
     {
         HuffmanTree(const bstr &data);
@@ -33,6 +39,39 @@ namespace pack {
         u16 nodes[2][512];
     };
 
+    // Decodes MSB-first Huffman codes with a lookup table indexed by the
+    // next lookup_bits bits of input. Codes that fit the table take one
+    // lookup, longer ones continue bit by bit from where the table ended.
+    class HuffmanDecoder final
+    {
+    public:
+        // Builds the decoder from an explicit tree. Leaves keep the values
+        // stored in the tree.
+        HuffmanDecoder(
+            const HuffmanTree &huffman_tree, const size_t lookup_bits = 10);
+
+        // Builds the decoder for a canonical code (as in DEFLATE) given the
+        // code length of every symbol, 0 meaning the symbol is unused.
+        HuffmanDecoder(
+            const std::vector<u8> &code_lengths,
+            const size_t lookup_bits = 10);
+
+        ~HuffmanDecoder();
+
+        u16 decode(io::MsbBitStream &input_stream) const;
+
+        // Decodes byte-sized symbols until the output is full or the input
+        // ends, and returns how many bytes were decoded.
+        size_t decode(
+            io::MsbBitStream &input_stream,
+            u8 *output,
+            const size_t output_size) const;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
     bstr decode_huffman(
         const HuffmanTree &huffman_tree,
         const bstr &input,
@@ -16,9 +16,13 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/lzss.h"
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include "algo/endian.h"
 #include "algo/ptr.h"
 #include "algo/range.h"
+#include "err.h"
 #include "io/memory_byte_stream.h"
 #include "io/msb_bit_stream.h"
 
@@ -80,6 +84,223 @@ namespace
     };
 }
 
+namespace
+{
+    // Reads MSB-first bits straight from memory, without going through the
+    // virtual io::BaseBitStream interface.
+    class MemoryBitReader final
+    {
+    public:
+        MemoryBitReader(const bstr &input);
+        inline u32 read(const size_t bits);
+
+    private:
+        void refill(const size_t bits);
+
+        const u8 *input_ptr;
+        const u8 *const input_end;
+        u64 buffer;
+        size_t bits_available;
+    };
+
+    class StreamBitReader final
+    {
+    public:
+        StreamBitReader(io::BaseBitStream &input_stream);
+        inline u32 read(const size_t bits);
+
+    private:
+        io::BaseBitStream &input_stream;
+    };
+
+    template<size_t position_bits, size_t size_bits, size_t min_match_size>
+        struct FixedBitwiseParams final
+    {
+        FixedBitwiseParams(const algo::pack::BitwiseLzssSettings &)
+        {
+        }
+
+        constexpr size_t get_position_bits() const { return position_bits; }
+        constexpr size_t get_size_bits() const { return size_bits; }
+        constexpr size_t get_min_match_size() const { return min_match_size; }
+    };
+
+    struct DynamicBitwiseParams final
+    {
+        DynamicBitwiseParams(const algo::pack::BitwiseLzssSettings &settings)
+            : settings(settings)
+        {
+        }
+
+        size_t get_position_bits() const { return settings.position_bits; }
+        size_t get_size_bits() const { return settings.size_bits; }
+        size_t get_min_match_size() const { return settings.min_match_size; }
+
+        const algo::pack::BitwiseLzssSettings &settings;
+    };
+}
+
+MemoryBitReader::MemoryBitReader(const bstr &input) :
+    input_ptr(input.get<const u8>()),
+    input_end(input.end<const u8>()),
+    buffer(0),
+    bits_available(0)
+{
+}
+
+inline u32 MemoryBitReader::read(const size_t bits)
+{
+    if (bits_available < bits)
+        refill(bits);
+    bits_available -= bits;
+    return (buffer >> bits_available) & ((1ull << bits) - 1);
+}
+
+void MemoryBitReader::refill(const size_t bits)
+{
+    if (input_end - input_ptr >= 8)
+    {
+        const auto count = (63 - bits_available) >> 3;
+        u64 word;
+        std::memcpy(&word, input_ptr, 8);
+        word = algo::from_big_endian<u64>(word);
+        buffer = (buffer << (count << 3)) | (word >> (64 - (count << 3)));
+        bits_available += count << 3;
+        input_ptr += count;
+        return;
+    }
+    while (bits_available < bits && input_ptr < input_end)
+    {
+        buffer = (buffer << 8) | *input_ptr++;
+        bits_available += 8;
+    }
+    if (bits_available < bits)
+        throw err::EofError();
+}
+
+StreamBitReader::StreamBitReader(io::BaseBitStream &input_stream)
+    : input_stream(input_stream)
+{
+}
+
+inline u32 StreamBitReader::read(const size_t bits)
+{
+    return input_stream.read(bits);
+}
+
+// Both flavors keep the dictionary as a window sliding over the output: the
+// byte at dictionary position look_behind_pos is the one written distance
+// bytes ago. Positions that no output byte has reached yet still hold the
+// zeros the dictionary starts with.
+static inline size_t get_distance(
+    const size_t look_behind_pos,
+    const size_t output_pos,
+    const size_t initial_dictionary_pos,
+    const size_t dict_size)
+{
+    return ((initial_dictionary_pos + output_pos - look_behind_pos - 1)
+        & (dict_size - 1)) + 1;
+}
+
+static inline void copy_match(
+    const u8 *output_start,
+    u8 *&output_ptr,
+    const u8 *output_end,
+    const size_t distance,
+    size_t size)
+{
+    size = std::min<size_t>(size, output_end - output_ptr);
+    const size_t output_pos = output_ptr - output_start;
+    if (distance > output_pos)
+    {
+        const auto zeros = std::min(size, distance - output_pos);
+        std::memset(output_ptr, 0, zeros);
+        output_ptr += zeros;
+        size -= zeros;
+    }
+    const auto *source_ptr = output_ptr - distance;
+    if (distance >= size)
+    {
+        std::memcpy(output_ptr, source_ptr, size);
+        output_ptr += size;
+        return;
+    }
+    while (size--)
+        *output_ptr++ = *source_ptr++;
+}
+
+template<typename Params, typename BitReader>
+    static bstr decompress_bitwise_impl(
+    BitReader &bit_reader,
+    const size_t output_size,
+    const algo::pack::BitwiseLzssSettings &settings)
+{
+    const Params params(settings);
+    const size_t dict_size = 1ull << params.get_position_bits();
+    bstr output(output_size);
+    const auto output_start = output.get<u8>();
+    const auto output_end = output.end<const u8>();
+    auto output_ptr = output_start;
+    while (output_ptr < output_end)
+    {
+        if (bit_reader.read(1))
+        {
+            *output_ptr++ = bit_reader.read(8);
+            continue;
+        }
+        const auto look_behind_pos
+            = bit_reader.read(params.get_position_bits());
+        const auto size = bit_reader.read(params.get_size_bits())
+            + params.get_min_match_size();
+        const auto distance = get_distance(
+            look_behind_pos,
+            output_ptr - output_start,
+            settings.initial_dictionary_pos,
+            dict_size);
+        copy_match(output_start, output_ptr, output_end, distance, size);
+    }
+    return output;
+}
+
+// Picks a specialization for the configurations used by the decoders, so
+// that the compiler sees constant bit counts in the hot loop.
+template<typename BitReader> static bstr decompress_bitwise(
+    BitReader &bit_reader,
+    const size_t output_size,
+    const algo::pack::BitwiseLzssSettings &settings)
+{
+    const auto p = settings.position_bits;
+    const auto s = settings.size_bits;
+    const auto m = settings.min_match_size;
+    if (p == 13 && s == 4 && m == 3)
+    {
+        return decompress_bitwise_impl<FixedBitwiseParams<13, 4, 3>>(
+            bit_reader, output_size, settings);
+    }
+    if (p == 12 && s == 4 && m == 3)
+    {
+        return decompress_bitwise_impl<FixedBitwiseParams<12, 4, 3>>(
+            bit_reader, output_size, settings);
+    }
+    if (p == 12 && s == 4 && m == 2)
+    {
+        return decompress_bitwise_impl<FixedBitwiseParams<12, 4, 2>>(
+            bit_reader, output_size, settings);
+    }
+    if (p == 11 && s == 4 && m == 2)
+    {
+        return decompress_bitwise_impl<FixedBitwiseParams<11, 4, 2>>(
+            bit_reader, output_size, settings);
+    }
+    if (p == 8 && s == 4 && m == 2)
+    {
+        return decompress_bitwise_impl<FixedBitwiseParams<8, 4, 2>>(
+            bit_reader, output_size, settings);
+    }
+    return decompress_bitwise_impl<DynamicBitwiseParams>(
+        bit_reader, output_size, settings);
+}
+
 BitwiseLzssWriter::BitwiseLzssWriter() : bit_stream(byte_stream)
 {
 }
@@ -164,14 +385,79 @@ bstr algo::pack::lzss_decompress(
     const size_t output_size,
     const BitwiseLzssSettings &settings)
 {
-    io::MsbBitStream bit_stream(input);
-    return lzss_decompress(bit_stream, output_size, settings);
+    MemoryBitReader bit_reader(input);
+    return decompress_bitwise(bit_reader, output_size, settings);
 }
 
 bstr algo::pack::lzss_decompress(
     io::BaseBitStream &input_stream,
     const size_t output_size,
     const BitwiseLzssSettings &settings)
+{
+    StreamBitReader bit_reader(input_stream);
+    return decompress_bitwise(bit_reader, output_size, settings);
+}
+
+bstr algo::pack::lzss_decompress(
+    const bstr &input,
+    const size_t output_size,
+    const BytewiseLzssSettings &settings)
+{
+    static const size_t dict_size = 0x1000;
+    bstr output(output_size);
+    const auto output_start = output.get<u8>();
+    const auto output_end = output.end<const u8>();
+    auto output_ptr = output_start;
+    auto input_ptr = input.get<const u8>();
+    const auto input_end = input.end<const u8>();
+
+    while (output_ptr < output_end)
+    {
+        if (input_ptr >= input_end)
+            break;
+        auto control = *input_ptr++;
+        for (auto i = 0; i < 8 && output_ptr < output_end; i++, control >>= 1)
+        {
+            if (control & 1)
+            {
+                if (input_ptr >= input_end)
+                    return output;
+                *output_ptr++ = *input_ptr++;
+            }
+            else
+            {
+                if (input_end - input_ptr < 2)
+                    return output;
+                const auto lo = *input_ptr++;
+                const auto hi = *input_ptr++;
+                const auto look_behind_pos = lo | ((hi & 0xF0) << 4);
+                const auto size = (hi & 0xF) + 3;
+                const auto distance = get_distance(
+                    look_behind_pos,
+                    output_ptr - output_start,
+                    settings.initial_dictionary_pos,
+                    dict_size);
+                copy_match(
+                    output_start, output_ptr, output_end, distance, size);
+            }
+        }
+    }
+    return output;
+}
+
+bstr algo::pack::lzss_decompress_reference(
+    const bstr &input,
+    const size_t output_size,
+    const BitwiseLzssSettings &settings)
+{
+    io::MsbBitStream bit_stream(input);
+    return lzss_decompress_reference(bit_stream, output_size, settings);
+}
+
+bstr algo::pack::lzss_decompress_reference(
+    io::BaseBitStream &input_stream,
+    const size_t output_size,
+    const BitwiseLzssSettings &settings)
 {
     std::vector<u8> dict(1 << settings.position_bits, 0);
     auto dict_ptr
@@ -207,7 +493,7 @@ bstr algo::pack::lzss_decompress(
     return output;
 }
 
-bstr algo::pack::lzss_decompress(
+bstr algo::pack::lzss_decompress_reference(
     const bstr &input,
     const size_t output_size,
     const BytewiseLzssSettings &settings)
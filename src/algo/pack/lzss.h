@@ -67,6 +67,23 @@ namespace pack {
         const size_t output_size,
         const BytewiseLzssSettings &settings = BytewiseLzssSettings());
 
+    // Straightforward implementations going through a separate cyclic
+    // dictionary, kept to check the optimized functions above against.
+    bstr lzss_decompress_reference(
+        const bstr &input,
+        const size_t output_size,
+        const BitwiseLzssSettings &settings);
+
+    bstr lzss_decompress_reference(
+        io::BaseBitStream &input_stream,
+        const size_t output_size,
+        const BitwiseLzssSettings &settings);
+
+    bstr lzss_decompress_reference(
+        const bstr &input,
+        const size_t output_size,
+        const BytewiseLzssSettings &settings = BytewiseLzssSettings());
+
     bstr lzss_compress(
         const bstr &input, const algo::pack::BitwiseLzssSettings &settings);
 
@@ -16,25 +16,116 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/zlib.h"
+#include <algorithm>
 #include <cstring>
-#include <memory>
 #include <zlib.h>
 #include "algo/format.h"
 #include "err.h"
-#include "io/memory_byte_stream.h"
+#if LIBDEFLATE_FOUND
+    #include <libdeflate.h>
+#endif
 
 using namespace au;
 using namespace au::algo::pack;
 
 static const int buffer_size = 8192;
 
-static bstr process_stream(
-    io::BaseByteStream &input_stream,
-    const ZlibKind kind,
-    const std::function<int(z_stream &s, const int window_bits)> &init_func,
-    const std::function<int(z_stream &s)> &process_func,
-    const std::function<int(z_stream &s)> &end_func,
-    const std::string &error_message)
+namespace
+{
+    // Hands input to zlib. Data that sits in contiguous memory is passed as
+    // it is, other streams are read in chunks.
+    class InputFeeder final
+    {
+    public:
+        InputFeeder(io::BaseByteStream &input_stream);
+        InputFeeder(const bstr &input);
+
+        void feed(z_stream &s);
+        bool finished() const;
+        uoff_t size() const;
+
+        #if LIBDEFLATE_FOUND
+            // The whole input, if it sits in contiguous memory.
+            const u8 *data() const;
+        #endif
+
+        // Moves the input stream right after the consumed bytes.
+        void rewind(const uoff_t consumed);
+
+    private:
+        io::BaseByteStream *input_stream;
+        const uoff_t initial_pos;
+        const uoff_t input_size;
+        const u8 *input_data;
+        uoff_t fed;
+        bstr input_chunk;
+    };
+}
+
+InputFeeder::InputFeeder(io::BaseByteStream &input_stream) :
+    input_stream(&input_stream),
+    initial_pos(input_stream.pos()),
+    input_size(input_stream.left()),
+    input_data(input_stream.contiguous_data()),
+    fed(0)
+{
+    if (input_data)
+        input_data += initial_pos;
+}
+
+InputFeeder::InputFeeder(const bstr &input) :
+    input_stream(nullptr),
+    initial_pos(0),
+    input_size(input.size()),
+    input_data(input.get<const u8>()),
+    fed(0)
+{
+}
+
+void InputFeeder::feed(z_stream &s)
+{
+    if (s.avail_in)
+        return;
+    if (input_data)
+    {
+        // avail_in is only 32 bits wide
+        const auto size = std::min<uoff_t>(input_size - fed, 0x40000000);
+        s.next_in = const_cast<Bytef*>(input_data + fed);
+        s.avail_in = size;
+        fed += size;
+        return;
+    }
+    input_chunk = input_stream->read(
+        std::min<uoff_t>(input_size - fed, buffer_size));
+    s.next_in = input_chunk.get<Bytef>();
+    s.avail_in = input_chunk.size();
+    fed += input_chunk.size();
+}
+
+bool InputFeeder::finished() const
+{
+    return fed == input_size;
+}
+
+uoff_t InputFeeder::size() const
+{
+    return input_size;
+}
+
+#if LIBDEFLATE_FOUND
+const u8 *InputFeeder::data() const
+{
+    return input_data;
+}
+#endif
+
+void InputFeeder::rewind(const uoff_t consumed)
+{
+    if (input_stream)
+        input_stream->seek(initial_pos + consumed);
+}
+
+static int get_window_bits(const ZlibKind kind)
 {
     const int window_bits
         = kind == ZlibKind::RawDeflate ? -MAX_WBITS
@@ -43,44 +134,118 @@ static bstr process_stream(
         : 0;
     if (!window_bits)
         throw std::logic_error("Bad zlib kind");
+    return window_bits;
+}
+
+#if LIBDEFLATE_FOUND
+// libdeflate works on whole buffers only, so it takes over just when the
+// input is in memory and the output size is known or can be bounded.
+// Whenever it fails, zlib gets to redo the work and report the error.
+static bool inflate_with_libdeflate(
+    InputFeeder &input_feeder,
+    const ZlibKind kind,
+    const size_t output_size,
+    bstr &output)
+{
+    if (!input_feeder.data() || !output_size)
+        return false;
+    const auto func
+        = kind == ZlibKind::RawDeflate ? libdeflate_deflate_decompress_ex
+        : kind == ZlibKind::PlainZlib ? libdeflate_zlib_decompress_ex
+        : libdeflate_gzip_decompress_ex;
+    const std::unique_ptr<
+        libdeflate_decompressor,
+        decltype(&libdeflate_free_decompressor)>
+            decompressor(
+                libdeflate_alloc_decompressor(),
+                libdeflate_free_decompressor);
+    if (!decompressor)
+        return false;
+    output.resize(output_size);
+    size_t input_used = 0, output_used = 0;
+    const auto result = func(
+        decompressor.get(),
+        input_feeder.data(),
+        input_feeder.size(),
+        output.get<u8>(),
+        output.size(),
+        &input_used,
+        &output_used);
+    if (result != LIBDEFLATE_SUCCESS)
+        return false;
+    output.resize(output_used);
+    input_feeder.rewind(input_used);
+    return true;
+}
 
+static bool deflate_with_libdeflate(
+    const bstr &input,
+    const ZlibKind kind,
+    const CompressionLevel compression_level,
+    bstr &output)
+{
+    const std::vector<int> levels = {12, 6, 1, 0};
+    const std::unique_ptr<
+        libdeflate_compressor,
+        decltype(&libdeflate_free_compressor)>
+            compressor(
+                libdeflate_alloc_compressor(
+                    levels.at(static_cast<int>(compression_level))),
+                libdeflate_free_compressor);
+    if (!compressor)
+        return false;
+    const auto bound_func
+        = kind == ZlibKind::RawDeflate ? libdeflate_deflate_compress_bound
+        : kind == ZlibKind::PlainZlib ? libdeflate_zlib_compress_bound
+        : libdeflate_gzip_compress_bound;
+    const auto func
+        = kind == ZlibKind::RawDeflate ? libdeflate_deflate_compress
+        : kind == ZlibKind::PlainZlib ? libdeflate_zlib_compress
+        : libdeflate_gzip_compress;
+    output.resize(bound_func(compressor.get(), input.size()));
+    const auto output_used = func(
+        compressor.get(),
+        input.get<const u8>(),
+        input.size(),
+        output.get<u8>(),
+        output.size());
+    if (!output_used)
+        return false;
+    output.resize(output_used);
+    return true;
+}
+#endif
+
+static bstr process_stream(
+    InputFeeder &input_feeder,
+    const ZlibKind kind,
+    const size_t output_size,
+    const std::function<int(z_stream &s, const int window_bits)> &init_func,
+    const std::function<int(z_stream &s, const bool finish)> &process_func,
+    const std::function<int(z_stream &s)> &end_func,
+    const std::string &error_message)
+{
     z_stream s;
     std::memset(&s, 0, sizeof(s));
-    if (init_func(s, window_bits) != Z_OK)
+    if (init_func(s, get_window_bits(kind)) != Z_OK)
         throw std::logic_error("Failed to initialize zlib stream");
 
-    bstr output, input_chunk, output_chunk(buffer_size);
-    size_t written = 0;
+    // with a known size the output goes straight to its final place,
+    // otherwise the buffer doubles whenever zlib fills it up
+    bstr output(output_size ? output_size : buffer_size);
     int ret;
-    const auto initial_pos = input_stream.pos();
     do
     {
-        if (s.avail_in == 0)
-        {
-            input_chunk = input_stream.read(
-                std::min<size_t>(input_stream.left(), buffer_size));
-            s.next_in = const_cast<Bytef*>(input_chunk.get<const Bytef>());
-            s.avail_in = input_chunk.size();
-        }
-
-        s.next_out = output_chunk.get<Bytef>();
-        s.avail_out = output_chunk.size();
-
-        ret = process_func(s);
-        output += output_chunk.substr(0, s.total_out - written);
-        written = s.total_out;
-        if (ret == Z_BUF_ERROR)
-        {
-            input_chunk += input_stream.read(
-                std::min<size_t>(input_stream.left(), buffer_size));
-            s.next_in = const_cast<Bytef*>(input_chunk.get<const Bytef>());
-            s.avail_in = input_chunk.size();
-        }
+        input_feeder.feed(s);
+        if (s.total_out == output.size())
+            output.resize(output.size() * 2);
+        s.next_out = output.get<Bytef>() + s.total_out;
+        s.avail_out = output.size() - s.total_out;
+        ret = process_func(s, input_feeder.finished());
     }
     while (ret == Z_OK);
 
-    input_stream.seek(initial_pos + s.total_in);
-    const auto pos = s.next_in - input_chunk.get<const Bytef>();
+    input_feeder.rewind(s.total_in);
     end_func(s);
     if (ret != Z_STREAM_END)
     {
@@ -88,22 +253,36 @@ static bstr process_stream(
             "%s (%s near %x)",
             error_message.c_str(),
             s.msg ? s.msg : "unknown error",
-            pos));
+            s.total_in));
     }
+    output.resize(s.total_out);
     return output;
 }
 
-bstr algo::pack::zlib_inflate(
-    io::BaseByteStream &input_stream, const ZlibKind kind)
+static bstr inflate_stream(
+    InputFeeder &input_feeder, const ZlibKind kind, const size_t output_size)
 {
+    // don't allocate garbage sizes that DEFLATE cannot possibly reach
+    const auto max_output_size = input_feeder.size() * 1032 + buffer_size;
+    const auto output_size_hint
+        = std::min<uoff_t>(output_size, max_output_size);
+    #if LIBDEFLATE_FOUND
+        bstr output;
+        if (inflate_with_libdeflate(
+            input_feeder, kind, output_size_hint, output))
+        {
+            return output;
+        }
+    #endif
     return process_stream(
-        input_stream,
+        input_feeder,
         kind,
+        output_size_hint,
         [](z_stream &s, const int window_bits)
         {
             return inflateInit2(&s, window_bits);
         },
-        [](z_stream &s)
+        [](z_stream &s, const bool)
         {
             return inflate(&s, Z_NO_FLUSH);
         },
@@ -114,10 +293,33 @@ bstr algo::pack::zlib_inflate(
         "Failed to inflate zlib stream");
 }
 
+bstr algo::pack::zlib_inflate(
+    io::BaseByteStream &input_stream, const ZlibKind kind)
+{
+    InputFeeder input_feeder(input_stream);
+    return inflate_stream(input_feeder, kind, 0);
+}
+
 bstr algo::pack::zlib_inflate(const bstr &input, const ZlibKind kind)
 {
-    io::MemoryByteStream input_stream(input);
-    return ::zlib_inflate(input_stream, kind);
+    InputFeeder input_feeder(input);
+    return inflate_stream(input_feeder, kind, 0);
+}
+
+bstr algo::pack::zlib_inflate(
+    io::BaseByteStream &input_stream,
+    const size_t output_size,
+    const ZlibKind kind)
+{
+    InputFeeder input_feeder(input_stream);
+    return inflate_stream(input_feeder, kind, output_size);
+}
+
+bstr algo::pack::zlib_inflate(
+    const bstr &input, const size_t output_size, const ZlibKind kind)
+{
+    InputFeeder input_feeder(input);
+    return inflate_stream(input_feeder, kind, output_size);
 }
 
 bstr algo::pack::zlib_deflate(
@@ -125,10 +327,16 @@ bstr algo::pack::zlib_deflate(
     const ZlibKind kind,
     const CompressionLevel compression_level)
 {
-    io::MemoryByteStream input_stream(input);
+    #if LIBDEFLATE_FOUND
+        bstr output;
+        if (deflate_with_libdeflate(input, kind, compression_level, output))
+            return output;
+    #endif
+    InputFeeder input_feeder(input);
     return process_stream(
-        input_stream,
+        input_feeder,
         kind,
+        0,
         [compression_level](z_stream &s, const int window_bits)
         {
             std::vector<int> levels = {9, 6, 1, 0};
@@ -140,9 +348,9 @@ bstr algo::pack::zlib_deflate(
                 9,
                 Z_DEFAULT_STRATEGY);
         },
-        [&input_stream](z_stream &s)
+        [](z_stream &s, const bool finish)
         {
-            return deflate(&s, input_stream.left() ? Z_NO_FLUSH : Z_FINISH);
+            return deflate(&s, finish ? Z_FINISH : Z_NO_FLUSH);
         },
         [](z_stream &s)
         {
@@ -150,3 +358,143 @@ bstr algo::pack::zlib_deflate(
         },
         "Failed to deflate stream");
 }
+
+struct ZlibInflateStream::Priv final
+{
+    Priv(
+        io::BaseByteStream &input_stream,
+        const uoff_t output_size,
+        const ZlibKind kind);
+    ~Priv();
+
+    void inflate_until(const uoff_t target_size);
+
+    std::unique_ptr<io::BaseByteStream> input_stream;
+    const uoff_t input_offset;
+    const uoff_t output_size;
+    const ZlibKind kind;
+    InputFeeder input_feeder;
+    z_stream s;
+    bool stream_ended;
+    bstr output;
+    uoff_t output_pos;
+};
+
+ZlibInflateStream::Priv::Priv(
+    io::BaseByteStream &input_stream,
+    const uoff_t output_size,
+    const ZlibKind kind) :
+        input_stream(input_stream.clone()),
+        input_offset(input_stream.pos()),
+        output_size(output_size),
+        kind(kind),
+        input_feeder(*this->input_stream),
+        stream_ended(false),
+        output_pos(0)
+{
+    std::memset(&s, 0, sizeof(s));
+    if (inflateInit2(&s, get_window_bits(kind)) != Z_OK)
+        throw std::logic_error("Failed to initialize zlib stream");
+}
+
+ZlibInflateStream::Priv::~Priv()
+{
+    inflateEnd(&s);
+}
+
+void ZlibInflateStream::Priv::inflate_until(const uoff_t target_size)
+{
+    while (s.total_out < target_size)
+    {
+        if (stream_ended)
+            throw err::BadDataSizeError();
+        if (output.size() < target_size)
+        {
+            output.resize(std::min<uoff_t>(
+                output_size,
+                std::max<uoff_t>(
+                    target_size, std::max<uoff_t>(
+                        output.size() * 2, buffer_size))));
+        }
+        input_feeder.feed(s);
+        s.next_out = output.get<Bytef>() + s.total_out;
+        s.avail_out = output.size() - s.total_out;
+        const auto ret = inflate(&s, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+            stream_ended = true;
+        else if (ret != Z_OK)
+        {
+            throw err::CorruptDataError(algo::format(
+                "Failed to inflate zlib stream (%s near %x)",
+                s.msg ? s.msg : "unknown error",
+                s.total_in));
+        }
+    }
+}
+
+ZlibInflateStream::ZlibInflateStream(
+    io::BaseByteStream &input_stream,
+    const uoff_t output_size,
+    const ZlibKind kind)
+        : p(new Priv(input_stream, output_size, kind))
+{
+}
+
+ZlibInflateStream::~ZlibInflateStream()
+{
+}
+
+void ZlibInflateStream::seek_impl(const uoff_t offset)
+{
+    if (offset > p->output_size)
+        throw err::EofError();
+    p->output_pos = offset;
+}
+
+void ZlibInflateStream::read_impl(void *destination, const size_t size)
+{
+    if (p->output_pos + size > p->output_size)
+        throw err::EofError();
+    p->inflate_until(p->output_pos + size);
+    std::memcpy(destination, p->output.get<u8>() + p->output_pos, size);
+    p->output_pos += size;
+}
+
+void ZlibInflateStream::write_impl(const void *source, const size_t size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
+uoff_t ZlibInflateStream::pos() const
+{
+    return p->output_pos;
+}
+
+uoff_t ZlibInflateStream::size() const
+{
+    return p->output_size;
+}
+
+void ZlibInflateStream::resize_impl(const uoff_t new_size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
+std::unique_ptr<io::BaseByteStream> ZlibInflateStream::clone() const
+{
+    auto input_stream = p->input_stream->clone();
+    input_stream->seek(p->input_offset);
+    std::unique_ptr<io::BaseByteStream> ret
+        = std::make_unique<ZlibInflateStream>(
+            *input_stream, p->output_size, p->kind);
+    ret->seek(pos());
+    return ret;
+}
+
+const u8 *ZlibInflateStream::contiguous_data() const
+{
+    // only once everything is inflated, as the buffer moves while growing
+    if (p->s.total_out < p->output_size || !p->output_size)
+        return nullptr;
+    return p->output.get<const u8>();
+}
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include "algo/pack/compression_level.h"
 #include "io/base_byte_stream.h"
 #include "types.h"
@@ -39,10 +40,49 @@ namespace pack {
     bstr zlib_inflate(
         const bstr &input, const ZlibKind kind = ZlibKind::PlainZlib);
 
+    // Variants for when the size of the inflated data is known up front,
+    // which let the data be inflated right into its final buffer. A wrong
+    // size only costs an extra reallocation.
+    bstr zlib_inflate(
+        io::BaseByteStream &input_stream,
+        const size_t output_size,
+        const ZlibKind kind = ZlibKind::PlainZlib);
+
+    bstr zlib_inflate(
+        const bstr &input,
+        const size_t output_size,
+        const ZlibKind kind = ZlibKind::PlainZlib);
+
     bstr zlib_deflate(
         const bstr &input,
         const ZlibKind kind = ZlibKind::PlainZlib,
         const CompressionLevel = CompressionLevel::Best);
 
+    // Inflates the input lazily, as far as the reads need. Holds its own
+    // clone of the input stream, starting at its current position.
+    class ZlibInflateStream final : public io::BaseByteStream
+    {
+    public:
+        ZlibInflateStream(
+            io::BaseByteStream &input_stream,
+            const uoff_t output_size,
+            const ZlibKind kind = ZlibKind::PlainZlib);
+        ~ZlibInflateStream();
+
+        uoff_t size() const override;
+        uoff_t pos() const override;
+        std::unique_ptr<BaseByteStream> clone() const override;
+        const u8 *contiguous_data() const override;
+
+    protected:
+        void read_impl(void *destination, const size_t size) override;
+        void write_impl(const void *source, const size_t size) override;
+        void seek_impl(const uoff_t offset) override;
+        void resize_impl(const uoff_t new_size) override;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
 
 } } }
@@ -0,0 +1,55 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <exception>
+#include <thread>
+#include <vector>
+#include "algo/range.h"
+
+namespace au {
+namespace algo {
+
+    // Calls func(i) for each i in [0, count) on its own thread and rethrows
+    // the first error once all of them are done.
+    template<typename T> void run_in_parallel(const size_t count, const T &func)
+    {
+        std::vector<std::exception_ptr> errors(count);
+        std::vector<std::thread> threads;
+        for (const auto i : algo::range(count))
+        {
+            threads.emplace_back([&func, &errors, i]()
+            {
+                try
+                {
+                    func(i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        for (const auto &error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+
+} }
@@ -143,6 +143,11 @@ namespace algo {
         return boost::lexical_cast<int>(input);
     }
 
+    template<> uoff_t from_string(const std::string &input)
+    {
+        return boost::lexical_cast<uoff_t>(input);
+    }
+
     template<> float from_string(const std::string &input)
     {
         return boost::lexical_cast<float>(input);
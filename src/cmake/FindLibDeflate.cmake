@@ -0,0 +1,27 @@
+# - Try to find libdeflate.
+# Once done, this will define
+#
+#  LIBDEFLATE_FOUND - system has libdeflate.
+#  LIBDEFLATE_INCLUDE_DIRS - the libdeflate include directories
+#  LIBDEFLATE_LIBRARIES - link these to use libdeflate.
+
+find_package(PkgConfig)
+pkg_check_modules(PC_LIBDEFLATE QUIET libdeflate)
+
+# Look for the header file.
+find_path(LIBDEFLATE_INCLUDE_DIRS
+    NAMES libdeflate.h
+    HINTS ${PC_LIBDEFLATE_INCLUDEDIR} ${PC_LIBDEFLATE_INCLUDE_DIRS}
+)
+mark_as_advanced(LIBDEFLATE_INCLUDE_DIRS)
+
+# Look for the library.
+find_library(
+    LIBDEFLATE_LIBRARIES
+    NAMES deflate
+    HINTS ${PC_LIBDEFLATE_LIBDIR} ${PC_LIBDEFLATE_LIBRARY_DIRS}
+)
+mark_as_advanced(LIBDEFLATE_LIBRARIES)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LibDeflate DEFAULT_MSG LIBDEFLATE_INCLUDE_DIRS LIBDEFLATE_LIBRARIES)
@@ -29,6 +29,12 @@ bool DskArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("DSK");
 }
 
+std::vector<dec::RecognitionSignature>
+    DskArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("DSK")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> DskArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -65,8 +71,7 @@ std::unique_ptr<io::File> DskArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> DskArchiveDecoder::get_linked_formats() const
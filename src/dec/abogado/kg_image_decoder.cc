@@ -147,6 +147,12 @@ bool KgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    KgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image KgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -35,6 +35,12 @@ bool WadArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WadArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> WadArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -82,8 +88,7 @@ std::unique_ptr<io::File> WadArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> WadArchiveDecoder::get_linked_formats() const
@@ -28,6 +28,12 @@ bool AdpackArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AdpackArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AdpackArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -59,8 +65,7 @@ std::unique_ptr<io::File> AdpackArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> AdpackArchiveDecoder::get_linked_formats() const
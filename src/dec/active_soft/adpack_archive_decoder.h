@@ -30,6 +30,8 @@ namespace active_soft {
 
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
 
         std::unique_ptr<ArchiveMeta> read_meta_impl(
             const Logger &logger,
@@ -30,6 +30,12 @@ bool Ed8ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Ed8ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Ed8ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
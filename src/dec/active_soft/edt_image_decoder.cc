@@ -37,6 +37,12 @@ bool EdtImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    EdtImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image EdtImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -84,8 +84,7 @@ std::unique_ptr<io::File> AfaArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto output_file = std::make_unique<io::File>(entry->path, data);
+    auto output_file = read_plain_file(input_file, *entry);
     output_file->guess_extension();
     return output_file;
 }
@@ -32,6 +32,12 @@ bool AffFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AffFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> AffFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
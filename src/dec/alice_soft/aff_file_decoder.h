@@ -27,6 +27,8 @@ namespace alice_soft {
     {
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
 
         std::unique_ptr<io::File> decode_impl(
             const Logger &logger, io::File &input_file) const override;
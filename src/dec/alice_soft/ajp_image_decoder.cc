@@ -38,6 +38,12 @@ bool AjpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AjpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image AjpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -34,6 +34,12 @@ bool AldArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("ald");
 }
 
+std::vector<dec::RecognitionSignature>
+    AldArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("ald")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AldArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -71,8 +77,7 @@ std::unique_ptr<io::File> AldArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto output_file = std::make_unique<io::File>(entry->path, data);
+    auto output_file = read_plain_file(input_file, *entry);
     output_file->guess_extension();
     return output_file;
 }
@@ -29,6 +29,12 @@ bool AlkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AlkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AlkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -56,8 +62,7 @@ std::unique_ptr<io::File> AlkArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto output_file = std::make_unique<io::File>(entry->path, data);
+    auto output_file = read_plain_file(input_file, *entry);
     output_file->guess_extension();
     return output_file;
 }
@@ -134,6 +134,12 @@ bool QntImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    QntImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image QntImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -152,11 +158,17 @@ res::Image QntImageDecoder::decode_impl(
     const auto alpha_size = input_file.stream.read_le<u32>();
     input_file.stream.skip(24);
 
+    // both planes are padded to even dimensions
+    const auto padded_width = (width + 1) & ~1;
+    const auto padded_height = (height + 1) & ~1;
     bstr color_data = pixel_size
-        ? algo::pack::zlib_inflate(input_file.stream.read(pixel_size))
+        ? algo::pack::zlib_inflate(
+            input_file.stream.read(pixel_size),
+            padded_width * padded_height * 3)
         : ""_b;
     bstr alpha_data = alpha_size
-        ? algo::pack::zlib_inflate(input_file.stream.read(alpha_size))
+        ? algo::pack::zlib_inflate(
+            input_file.stream.read(alpha_size), padded_width * height)
         : ""_b;
 
     res::Image image(width, height);
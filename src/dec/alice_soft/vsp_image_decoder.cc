@@ -27,6 +27,12 @@ bool VspImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("vsp");
 }
 
+std::vector<dec::RecognitionSignature>
+    VspImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("vsp")};
+}
+
 static bstr decompress_vsp(
     io::BaseByteStream &input_stream, const size_t width, const size_t height)
 {
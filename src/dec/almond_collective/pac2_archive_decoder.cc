@@ -38,6 +38,12 @@ bool Pac2ArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pac2ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pac2ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
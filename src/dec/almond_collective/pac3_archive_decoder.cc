@@ -392,6 +392,12 @@ bool Pac3ArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pac3ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pac3ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
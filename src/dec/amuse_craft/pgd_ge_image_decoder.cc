@@ -176,6 +176,12 @@ bool PgdGeImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PgdGeImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image PgdGeImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -30,6 +30,16 @@ bool AogAudioDecoder::is_recognized_impl(io::File &input_file) const
             && input_file.path.has_extension("aog"));
 }
 
+std::vector<dec::RecognitionSignature>
+    AogAudioDecoder::get_recognition_signatures_impl() const
+{
+    return
+    {
+        dec::RecognitionSignature::magic(aoi_magic),
+        dec::RecognitionSignature::extension("aog"),
+    };
+}
+
 std::unique_ptr<io::File> AogAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
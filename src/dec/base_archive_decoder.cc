@@ -21,6 +21,7 @@
 #include "algo/format.h"
 #include "dec/idecoder_visitor.h"
 #include "err.h"
+#include "io/slice_byte_stream.h"
 
 using namespace au;
 using namespace au::dec;
@@ -109,3 +110,21 @@ std::unique_ptr<io::File> BaseArchiveDecoder::read_file(
     // wrapper reserved for future usage
     return read_file_impl(logger, input_file, e, m);
 }
+
+std::unique_ptr<io::File> BaseArchiveDecoder::read_plain_file(
+    io::File &input_file,
+    const io::path &path,
+    const uoff_t offset,
+    const uoff_t size)
+{
+    return std::make_unique<io::File>(
+        path,
+        std::make_unique<io::SliceByteStream>(
+            input_file.stream, offset, size));
+}
+
+std::unique_ptr<io::File> BaseArchiveDecoder::read_plain_file(
+    io::File &input_file, const PlainArchiveEntry &entry)
+{
+    return read_plain_file(input_file, entry.path, entry.offset, entry.size);
+}
@@ -79,6 +79,17 @@ namespace dec {
             const ArchiveMeta &m,
             const ArchiveEntry &e) const = 0;
 
+        // Exposes a stored (uncompressed, unencrypted) region of the archive
+        // as a file that reads it lazily instead of copying it into memory.
+        static std::unique_ptr<io::File> read_plain_file(
+            io::File &input_file,
+            const io::path &path,
+            const uoff_t offset,
+            const uoff_t size);
+
+        static std::unique_ptr<io::File> read_plain_file(
+            io::File &input_file, const PlainArchiveEntry &entry);
+
     private:
         bool numeric_file_names;
     };
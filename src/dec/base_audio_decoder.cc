@@ -39,3 +39,25 @@ res::Audio BaseAudioDecoder::decode(const Logger &logger, io::File &file) const
     file.stream.seek(0);
     return decode_impl(logger, file);
 }
+
+bool BaseAudioDecoder::supports_streaming() const
+{
+    return false;
+}
+
+std::unique_ptr<res::StreamedAudio> BaseAudioDecoder::decode_streamed(
+    const Logger &logger, io::File &file) const
+{
+    if (!supports_streaming())
+        return nullptr;
+    if (!is_recognized(file))
+        throw err::RecognitionError();
+    file.stream.seek(0);
+    return decode_streamed_impl(logger, file);
+}
+
+std::unique_ptr<res::StreamedAudio> BaseAudioDecoder::decode_streamed_impl(
+    const Logger &logger, io::File &input_file) const
+{
+    return nullptr;
+}
@@ -19,6 +19,7 @@
 
 #include "base_decoder.h"
 #include "res/audio.h"
+#include "res/streamed_audio.h"
 
 namespace au {
 namespace dec {
@@ -34,9 +35,21 @@ namespace dec {
 
         res::Audio decode(const Logger &logger, io::File &input_file) const;
 
+        // Whether decode_streamed() can return anything but nullptr.
+        virtual bool supports_streaming() const;
+
+        // Reads only what is needed to describe the audio and leaves the
+        // samples to be decoded as they are consumed. Returns nullptr for
+        // decoders that can only decode whole tracks.
+        std::unique_ptr<res::StreamedAudio> decode_streamed(
+            const Logger &logger, io::File &input_file) const;
+
     protected:
         virtual res::Audio decode_impl(
             const Logger &logger, io::File &input_file) const = 0;
+
+        virtual std::unique_ptr<res::StreamedAudio> decode_streamed_impl(
+            const Logger &logger, io::File &input_file) const;
     };
 
 } }
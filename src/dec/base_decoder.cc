@@ -47,6 +47,7 @@ bool BaseDecoder::is_recognized(io::File &input_file) const
 {
     try
     {
+        const io::ReadSizeCheck read_size_check;
         input_file.stream.seek(0);
         return is_recognized_impl(input_file);
     }
@@ -55,3 +56,15 @@ bool BaseDecoder::is_recognized(io::File &input_file) const
         return false;
     }
 }
+
+std::vector<RecognitionSignature>
+    BaseDecoder::get_recognition_signatures() const
+{
+    return get_recognition_signatures_impl();
+}
+
+std::vector<RecognitionSignature>
+    BaseDecoder::get_recognition_signatures_impl() const
+{
+    return {};
+}
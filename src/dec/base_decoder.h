@@ -35,6 +35,9 @@ namespace dec {
 
         virtual bool is_recognized(io::File &input_file) const override;
 
+        std::vector<RecognitionSignature>
+            get_recognition_signatures() const override;
+
         virtual std::vector<std::string> get_linked_formats() const override;
 
     protected:
@@ -46,6 +49,10 @@ namespace dec {
 
         virtual bool is_recognized_impl(io::File &input_file) const = 0;
 
+        // Decoders without signatures are checked against every file.
+        virtual std::vector<RecognitionSignature>
+            get_recognition_signatures_impl() const;
+
     private:
         std::vector<ArgParserDecorator> arg_parser_decorators;
     };
@@ -51,6 +51,12 @@ bool CbgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CbgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image CbgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/bgi/dsc_file_decoder.h"
+#include "algo/pack/huffman.h"
 #include "algo/range.h"
 #include "dec/bgi/common.h"
 #include "enc/png/png_image_encoder.h"
@@ -26,19 +27,6 @@
 using namespace au;
 using namespace au::dec::bgi;
 
-namespace
-{
-    struct NodeInfo final
-    {
-        bool has_children;
-        bool look_behind;
-        u8 value;
-        u32 children[2];
-    };
-
-    using NodeList = std::vector<std::unique_ptr<NodeInfo>>;
-}
-
 static const bstr magic = "DSC FORMAT 1.00\x00"_b;
 
 static int is_image(const bstr &input)
@@ -54,72 +42,21 @@ static int is_image(const bstr &input)
     return width && height && (bpp == 8 || bpp == 24 || bpp == 32);
 }
 
-static NodeList get_nodes(io::BaseByteStream &input_stream, u32 key)
+// Symbols 0-255 are literal bytes, 256-511 are repetitions of 2-257 bytes
+// followed by a 12-bit look-behind offset. The code lengths describe a
+// canonical Huffman code.
+static std::vector<u8> read_code_lengths(
+    io::BaseByteStream &input_stream, u32 key)
 {
-    NodeList nodes;
-    for (const auto i : algo::range(1024))
-    {
-        auto node_info = std::make_unique<NodeInfo>();
-        node_info->has_children = false;
-        node_info->value = 0;
-        nodes.push_back(std::move(node_info));
-    }
-
-    std::vector<u32> arr0;
-    for (const auto n : algo::range(512))
-    {
-        u8 tmp = input_stream.read<u8>() - get_and_update_key(key);
-        if (tmp)
-            arr0.push_back((tmp << 16) + n);
-    }
-
-    std::sort(arr0.begin(), arr0.end());
-
-    size_t arr0_pos;
-    u32 n = 0, unk0 = 0x200, unk1 = 1, node_index = 1;
-    u32 arr1[1024] = {0};
-    u32 *node_ptr = arr1;
-    for (arr0_pos = 0; arr0_pos < arr0.size(); n++)
-    {
-        u32 *arr1_ptr = &arr1[unk0];
-        u32 *arr1_old_ptr = arr1_ptr;
-        u32 group_count = 0;
-
-        while (true)
-        {
-            const u32 c = arr0_pos < arr0.size() ? arr0[arr0_pos] : 0;
-            if (n != (c >> 16))
-                break;
-            nodes[*node_ptr]->has_children = false;
-            nodes[*node_ptr]->look_behind = (arr0[arr0_pos] & 0x100) != 0;
-            nodes[*node_ptr]->value = arr0[arr0_pos] & 0xFF;
-            arr0_pos++;
-            node_ptr++;
-            group_count++;
-        }
-
-        const u32 unk3 = 2 * (unk1 - group_count);
-        if (group_count < unk1)
-        {
-            unk1 = unk1 - group_count;
-            for (const auto i : algo::range(unk1))
-            {
-                nodes[*node_ptr]->has_children = true;
-                for (const auto j : algo::range(2))
-                    *arr1_ptr++ = nodes[*node_ptr]->children[j] = node_index++;
-                node_ptr++;
-            }
-        }
-        unk1 = unk3;
-        node_ptr = arr1_old_ptr;
-        unk0 ^= 0x200;
-    }
-    return nodes;
+    std::vector<u8> code_lengths(512);
+    for (const auto i : algo::range(code_lengths.size()))
+        code_lengths[i] = input_stream.read<u8>() - get_and_update_key(key);
+    return code_lengths;
 }
 
 static bstr decompress(
     io::BaseByteStream &input_stream,
-    const NodeList &nodes,
+    const algo::pack::HuffmanDecoder &huffman_decoder,
     size_t output_size)
 {
     bstr output(output_size);
@@ -128,17 +65,13 @@ static bstr decompress(
     const u8 *output_end = output_ptr + output.size();
     io::MsbBitStream bit_stream(input_stream.read_to_eof());
 
-    u32 bits = 0, bit_count = 0;
     while (output_ptr < output_end)
     {
-        u32 node_index = 0;
-        while (nodes[node_index]->has_children)
-            node_index = nodes[node_index]->children[bit_stream.read(1)];
-
-        if (nodes[node_index]->look_behind)
+        const auto symbol = huffman_decoder.decode(bit_stream);
+        if (symbol & 0x100)
         {
             auto offset = bit_stream.read(12);
-            size_t repetitions = nodes[node_index]->value + 2;
+            size_t repetitions = (symbol & 0xFF) + 2;
             u8 *look_behind = output_ptr - offset - 2;
             if (look_behind < output_start)
                 break;
@@ -149,7 +82,7 @@ static bstr decompress(
         }
         else
         {
-            *output_ptr++ = nodes[node_index]->value;
+            *output_ptr++ = symbol;
         }
     }
 
@@ -161,6 +94,12 @@ bool DscFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    DscFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> DscFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -169,9 +108,10 @@ std::unique_ptr<io::File> DscFileDecoder::decode_impl(
     const auto output_size = input_file.stream.read_le<u32>();
     input_file.stream.skip(8);
 
-    const auto nodes = get_nodes(input_file.stream, key);
+    const algo::pack::HuffmanDecoder huffman_decoder(
+        read_code_lengths(input_file.stream, key));
     const auto data = decompress(
-        input_file.stream, std::move(nodes), output_size);
+        input_file.stream, huffman_decoder, output_size);
 
     if (is_image(data))
     {
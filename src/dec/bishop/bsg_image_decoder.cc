@@ -30,6 +30,12 @@ bool BsgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    BsgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 static void unpack_none(
     io::BaseByteStream &input_stream,
     algo::ptr<u8> output_ptr,
@@ -51,6 +51,12 @@ bool BinArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read<u8>() == 'x'; // zlib header
 }
 
+std::vector<dec::RecognitionSignature>
+    BinArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("bin")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> BinArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -127,6 +127,12 @@ bool DatArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return tell_version(input_file.stream) != -1;
 }
 
+std::vector<dec::RecognitionSignature>
+    DatArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> DatArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
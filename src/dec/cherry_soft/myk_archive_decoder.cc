@@ -28,6 +28,12 @@ bool MykArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    MykArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> MykArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -57,8 +63,7 @@ std::unique_ptr<io::File> MykArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 static auto _ = dec::register_decoder<MykArchiveDecoder>("cherry-soft/myk");
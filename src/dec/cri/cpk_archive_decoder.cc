@@ -19,16 +19,14 @@
 #include <map>
 #include "algo/any.h"
 #include "algo/range.h"
-#include "algo/str.h"
+#include "dec/cri/crilayla.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
-#include "io/msb_bit_stream.h"
 
 using namespace au;
 using namespace au::dec::cri;
 
 static const bstr magic = "CPK\x20"_b;
-static const bstr layla_magic = "CRILAYLA"_b;
 
 static const u32 storage_mask    = 0xF0;
 static const u32 storage_none    = 0x00;
@@ -99,50 +97,6 @@ static bstr read_utf_packet(io::BaseByteStream &input_stream)
         : decrypt_utf_packet(utf_packet);
 }
 
-static bstr decompress_layla(const bstr &input)
-{
-    io::MemoryByteStream input_stream(input);
-    input_stream.seek(layla_magic.size());
-    const auto size_orig = input_stream.read_le<u32>();
-    const auto size_comp = input_stream.read_le<u32>();
-    const auto data_comp = algo::reverse(input_stream.read(size_comp));
-    const auto prefix = input_stream.read_to_eof();
-
-    io::MsbBitStream bit_stream(data_comp);
-    bstr output;
-    output.reserve(size_orig);
-    while (output.size() < size_orig)
-    {
-        if (bit_stream.read(1))
-        {
-            auto repetitions = 3;
-            auto look_behind = bit_stream.read(13) + 3;
-
-            std::vector<size_t> sizes = {5, 3, 2};
-            while (true)
-            {
-                size_t size = 8;
-                if (!sizes.empty())
-                {
-                    size = sizes.back();
-                    sizes.pop_back();
-                }
-                const auto marker = bit_stream.read(size);
-                repetitions += marker;
-                if (marker != (1u << size) - 1)
-                    break;
-            }
-
-            while (repetitions--)
-                output += output.at(output.size() - look_behind);
-        }
-        else
-            output += static_cast<u8>(bit_stream.read(8));
-    }
-
-    return prefix + algo::reverse(output);
-}
-
 static std::vector<Row> parse_utf_packet(const bstr &utf_packet)
 {
     io::MemoryByteStream utf_stream(utf_packet);
@@ -357,6 +311,12 @@ bool CpkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CpkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> CpkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -410,12 +370,15 @@ std::unique_ptr<io::File> CpkArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    auto data = input_file.stream
+    const auto head = input_file.stream
+        .seek(entry->offset)
+        .read(std::min<size_t>(entry->size, 16));
+    if (!is_crilayla(head))
+        return read_plain_file(input_file, *entry);
+    const auto data = input_file.stream
         .seek(entry->offset)
         .read(entry->size);
-    if (data.substr(0, layla_magic.size()) == layla_magic)
-        data = decompress_layla(data);
-    return std::make_unique<io::File>(entry->path, data);
+    return std::make_unique<io::File>(entry->path, decompress_crilayla(data));
 }
 
 std::vector<std::string> CpkArchiveDecoder::get_linked_formats() const
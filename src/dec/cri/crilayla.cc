@@ -0,0 +1,151 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/cri/crilayla.h"
+#include <algorithm>
+#include <cstring>
+#include "algo/endian.h"
+#include "err.h"
+
+using namespace au;
+using namespace au::dec;
+
+static const bstr magic = "CRILAYLA"_b;
+static const size_t header_size = 16;
+
+namespace
+{
+    // Reads MSB-first bits from a buffer, walking it from the last byte to
+    // the first.
+    class BackwardBitReader final
+    {
+    public:
+        BackwardBitReader(const u8 *input, const size_t input_size);
+        inline u32 read(const size_t bits);
+
+    private:
+        void refill(const size_t bits);
+
+        const u8 *const input_start;
+        const u8 *input_ptr;
+        u64 buffer;
+        size_t bits_available;
+    };
+}
+
+BackwardBitReader::BackwardBitReader(
+    const u8 *input, const size_t input_size) :
+        input_start(input),
+        input_ptr(input + input_size),
+        buffer(0),
+        bits_available(0)
+{
+}
+
+inline u32 BackwardBitReader::read(const size_t bits)
+{
+    if (bits_available < bits)
+        refill(bits);
+    bits_available -= bits;
+    return (buffer >> bits_available) & ((1ull << bits) - 1);
+}
+
+void BackwardBitReader::refill(const size_t bits)
+{
+    if (input_ptr - input_start >= 8)
+    {
+        // the byte right before input_ptr is the most significant one
+        const auto count = (63 - bits_available) >> 3;
+        u64 word;
+        std::memcpy(&word, input_ptr - 8, 8);
+        word = algo::from_little_endian<u64>(word);
+        buffer = (buffer << (count << 3)) | (word >> (64 - (count << 3)));
+        bits_available += count << 3;
+        input_ptr -= count;
+        return;
+    }
+    while (bits_available < bits && input_ptr > input_start)
+    {
+        buffer = (buffer << 8) | *--input_ptr;
+        bits_available += 8;
+    }
+    if (bits_available < bits)
+        throw err::EofError();
+}
+
+bool cri::is_crilayla(const bstr &input)
+{
+    return input.substr(0, magic.size()) == magic;
+}
+
+bstr cri::decompress_crilayla(const bstr &input)
+{
+    if (input.size() < header_size || !cri::is_crilayla(input))
+        throw err::RecognitionError("Not a CRILAYLA stream");
+    const auto size_orig = algo::from_little_endian(input.get<const u32>()[2]);
+    const auto size_comp = algo::from_little_endian(input.get<const u32>()[3]);
+    if (size_comp > input.size() - header_size)
+        throw err::BadDataSizeError();
+
+    const auto input_comp = input.get<const u8>() + header_size;
+    const auto prefix_size = input.size() - header_size - size_comp;
+    bstr output(prefix_size + size_orig);
+    std::memcpy(output.get<u8>(), input_comp + size_comp, prefix_size);
+
+    const auto output_start = output.get<u8>() + prefix_size;
+    const auto output_end = output.end<const u8>();
+    auto output_ptr = output.get<u8>() + output.size();
+    BackwardBitReader bit_reader(input_comp, size_comp);
+    while (output_ptr > output_start)
+    {
+        if (!bit_reader.read(1))
+        {
+            *--output_ptr = bit_reader.read(8);
+            continue;
+        }
+
+        const size_t distance = bit_reader.read(13) + 3;
+        if (distance > static_cast<size_t>(output_end - output_ptr))
+            throw err::BadDataOffsetError();
+
+        // the size is stored as a sum of 2-, 3-, 5- and then 8-bit parts,
+        // each saturated part meaning another one follows
+        static const size_t size_bits[] = {2, 3, 5, 8};
+        size_t size = 3;
+        for (size_t i = 0; ; i = std::min<size_t>(i + 1, 3))
+        {
+            const auto part = bit_reader.read(size_bits[i]);
+            size += part;
+            if (part != (1u << size_bits[i]) - 1)
+                break;
+        }
+        size = std::min<size_t>(size, output_ptr - output_start);
+
+        if (distance >= size)
+        {
+            output_ptr -= size;
+            std::memcpy(output_ptr, output_ptr + distance, size);
+            continue;
+        }
+        while (size--)
+        {
+            output_ptr--;
+            *output_ptr = output_ptr[distance];
+        }
+    }
+    return output;
+}
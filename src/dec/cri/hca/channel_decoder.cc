@@ -16,12 +16,164 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/cri/hca/channel_decoder.h"
+#include <cstring>
 #include "algo/range.h"
 #include "err.h"
 
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 using namespace au::dec::cri::hca;
 
+#if __SSE2__
+static inline __m128 reverse(const __m128 input)
+{
+    return _mm_shuffle_ps(input, input, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// Loads p[0], p[-1], p[-2], p[-3].
+static inline __m128 load_reversed(const f32 *p)
+{
+    return reverse(_mm_loadu_ps(p - 3));
+}
+
+static inline __m128 load_pair(const f32 *p)
+{
+    return _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+}
+
+// The last two butterfly stages work on groups of one or two pairs, which
+// leaves no room for four lanes per group; handle four outputs at a time
+// across groups instead. Negating and adding gives the same result as
+// subtracting.
+static void decode5_butterfly_narrow(f32 *&s, f32 *d, const size_t count)
+{
+    const auto sign = count == 1
+        ? _mm_set_ps(-1, 1, -1, 1)
+        : _mm_set_ps(-1, -1, 1, 1);
+    for (const auto i : algo::range(0, 128, 4))
+    {
+        const auto x = _mm_loadu_ps(s);
+        const auto a = count == 1
+            ? _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0))
+            : _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 0, 2, 0));
+        const auto b = count == 1
+            ? _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1))
+            : _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(&d[i], _mm_add_ps(a, _mm_mul_ps(b, sign)));
+        s += 4;
+    }
+}
+
+// Same as above for the first two rotation stages.
+static void decode5_rotate_narrow(
+    const f32 *s,
+    const f32 *list1,
+    const f32 *list2,
+    f32 *d,
+    const size_t count)
+{
+    for (const auto i : algo::range(0, 128, 4))
+    {
+        const auto x = _mm_loadu_ps(&s[i]);
+        const auto c = load_pair(&list1[i / 2]);
+        const auto e = load_pair(&list2[i / 2]);
+        __m128 a, b, cc, ee, sign;
+        if (count == 1)
+        {
+            a = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+            b = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+            cc = _mm_unpacklo_ps(c, e);
+            ee = _mm_unpacklo_ps(e, c);
+            sign = _mm_set_ps(1, -1, 1, -1);
+        }
+        else
+        {
+            const auto ce = _mm_movelh_ps(c, e);
+            a = _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 1, 0));
+            b = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 3, 2));
+            cc = _mm_shuffle_ps(ce, ce, _MM_SHUFFLE(2, 3, 1, 0));
+            ee = _mm_shuffle_ps(ce, ce, _MM_SHUFFLE(0, 1, 3, 2));
+            sign = _mm_set_ps(1, 1, -1, -1);
+        }
+        _mm_storeu_ps(&d[i], _mm_add_ps(
+            _mm_mul_ps(a, cc), _mm_mul_ps(_mm_mul_ps(b, ee), sign)));
+    }
+}
+#endif
+
+// Splits count interleaved pairs into sums and differences.
+static inline void decode5_butterfly(
+    f32 *&s, f32 *&d1, f32 *&d2, const size_t count)
+{
+    size_t k = 0;
+#if __SSE2__
+    for (; k + 4 <= count; k += 4)
+    {
+        const auto x0 = _mm_loadu_ps(s);
+        const auto x1 = _mm_loadu_ps(s + 4);
+        const auto a = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        const auto b = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(d1, _mm_add_ps(b, a));
+        _mm_storeu_ps(d2, _mm_sub_ps(a, b));
+        s += 8;
+        d1 += 4;
+        d2 += 4;
+    }
+#endif
+    for (; k < count; k++)
+    {
+        const auto a = *s++;
+        const auto b = *s++;
+        *d1++ = b + a;
+        *d2++ = a - b;
+    }
+}
+
+// Rotates count pairs by the given cosines and sines; the second half of
+// the output is written backwards.
+static inline void decode5_rotate(
+    const f32 *&s1,
+    const f32 *&s2,
+    const f32 *&list1,
+    const f32 *&list2,
+    f32 *&d1,
+    f32 *&d2,
+    const size_t count)
+{
+    size_t k = 0;
+#if __SSE2__
+    for (; k + 4 <= count; k += 4)
+    {
+        const auto a = _mm_loadu_ps(s1);
+        const auto b = _mm_loadu_ps(s2);
+        const auto c = _mm_loadu_ps(list1);
+        const auto d = _mm_loadu_ps(list2);
+        _mm_storeu_ps(d1, _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d)));
+        _mm_storeu_ps(
+            d2 - 3,
+            reverse(_mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c))));
+        s1 += 4;
+        s2 += 4;
+        list1 += 4;
+        list2 += 4;
+        d1 += 4;
+        d2 -= 4;
+    }
+#endif
+    for (; k < count; k++)
+    {
+        const auto a = *s1++;
+        const auto b = *s2++;
+        const auto c = *list1++;
+        const auto d = *list2++;
+        *d1++ = a * c - b * d;
+        *d2-- = a * d + b * c;
+    }
+}
+
 static void decode5_copy1(f32 *s, f32 *d)
 {
     for (const auto i : algo::range(7))
@@ -30,15 +182,14 @@ static void decode5_copy1(f32 *s, f32 *d)
         const auto count2 = 64 >> i;
         auto d1 = d;
         auto d2 = &d[count2];
+#if __SSE2__
+        if (count2 < 4)
+            decode5_butterfly_narrow(s, d, count2);
+        else
+#endif
         for (const auto j : algo::range(count1))
         {
-            for (const auto k : algo::range(count2))
-            {
-                const auto a = *s++;
-                const auto b = *s++;
-                *d1++ = b + a;
-                *d2++ = a - b;
-            }
+            decode5_butterfly(s, d1, d2, count2);
             d1 += count2;
             d2 += count2;
         }
@@ -316,21 +467,18 @@ static f32 *decode5_copy2(f32 *&s, f32 *d)
         const auto count2 = 1 << i;
         auto list1_f32 = reinterpret_cast<const f32*>(list1_u32[i]);
         auto list2_f32 = reinterpret_cast<const f32*>(list2_u32[i]);
-        auto s1 = s;
-        auto s2 = &s1[count2];
+        const f32 *s1 = s;
+        const f32 *s2 = &s1[count2];
         auto d1 = d;
         auto d2 = &d1[count2 * 2 - 1];
+#if __SSE2__
+        if (count2 < 4)
+            decode5_rotate_narrow(s, list1_f32, list2_f32, d, count2);
+        else
+#endif
         for (const auto j : algo::range(count1))
         {
-            for (const auto k : algo::range(count2))
-            {
-                const auto a = *s1++;
-                const auto b = *s2++;
-                const auto c = *list1_f32++;
-                const auto d = *list2_f32++;
-                *d1++ = a * c - b * d;
-                *d2-- = a * d + b * c;
-            }
+            decode5_rotate(s1, s2, list1_f32, list2_f32, d1, d2, count2);
             s1 += count2;
             s2 += count2;
             d1 += count2;
@@ -345,8 +493,8 @@ static f32 *decode5_copy2(f32 *&s, f32 *d)
 
 static void decode5_copy3(f32 *&s, f32 *d)
 {
-    for (const auto i : algo::range(128))
-        *d++ = *s++;
+    std::memcpy(d, s, 128 * sizeof(f32));
+    s += 128;
 }
 
 ChannelDecoder::ChannelDecoder(const int type, const int idx, const int count)
@@ -525,23 +673,24 @@ void ChannelDecoder::decode2(io::BaseBitStream &bit_stream)
         +0, +0, +1, -1, +2, -2, +3, -3, +4, -4, +5, -5, +6, -6, +7, -7,
     };
 
+    // Codes are peeked and then only the bits they actually use are
+    // consumed; stepping the bit stream back would make it seek.
     for (const auto i : algo::range(count))
     {
         int s = scale[i];
         int bit_count = list1[s];
-        int v = bit_stream.read(bit_count);
+        int v = bit_stream.peek(bit_count);
         f32 f;
         if (s < 8)
         {
             v += s << 4;
-            bit_stream.skip(list2[v] - bit_count);
+            bit_stream.read(list2[v]);
             f = list3[v];
         }
         else
         {
             v = (1 - ((v & 1) << 1)) * (v >> 1);
-            if (!v)
-                bit_stream.skip(-1);
+            bit_stream.read(v ? bit_count : bit_count - 1);
             f = v;
         }
         block[i] = base[i] * f;
@@ -714,6 +863,29 @@ void ChannelDecoder::decode5(const int index)
         }
     };
 
+#if __SSE2__
+    // Same as the scalar version below, with the backward walks done through
+    // reversed loads.
+    const auto list3 = reinterpret_cast<const f32*>(list3_u32[0]);
+    const auto d = wave[index];
+    for (const auto i : algo::range(0, 64, 4))
+    {
+        _mm_storeu_ps(&d[i], _mm_add_ps(
+            _mm_mul_ps(_mm_loadu_ps(&wav2[64 + i]), _mm_loadu_ps(&list3[i])),
+            _mm_loadu_ps(&wav3[i])));
+        _mm_storeu_ps(&d[64 + i], _mm_sub_ps(
+            _mm_mul_ps(
+                _mm_loadu_ps(&list3[64 + i]), load_reversed(&wav2[127 - i])),
+            _mm_loadu_ps(&wav3[64 + i])));
+    }
+    for (const auto i : algo::range(0, 64, 4))
+    {
+        _mm_storeu_ps(&wav3[i], _mm_mul_ps(
+            load_reversed(&wav2[63 - i]), load_reversed(&list3[127 - i])));
+        _mm_storeu_ps(&wav3[64 + i], _mm_mul_ps(
+            load_reversed(&list3[63 - i]), _mm_loadu_ps(&wav2[i])));
+    }
+#else
     auto s3 = reinterpret_cast<const f32*>(list3_u32[0]);
     auto d = wave[index];
     f32 *s1, *s2;
@@ -725,4 +897,5 @@ void ChannelDecoder::decode5(const int index)
     s2 = wav3;
     for (const auto i : algo::range(64)) *s2++ = *s1-- * *--s3;
     for (const auto i : algo::range(64)) *s2++ = *--s3 * *++s1;
+#endif
 }
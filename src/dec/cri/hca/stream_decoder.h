@@ -0,0 +1,55 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include "dec/cri/hca/meta.h"
+#include "io/base_byte_stream.h"
+
+namespace au {
+namespace dec {
+namespace cri {
+namespace hca {
+
+    // Decodes an HCA stream one block at a time. All decoding state lives in
+    // the instance, so separate streams can be decoded concurrently.
+    class StreamDecoder final
+    {
+    public:
+        static const size_t samples_per_block = 8 * 128;
+
+        // Reads and validates the header; the stream is then read block by
+        // block as needed.
+        StreamDecoder(io::BaseByteStream &input_stream);
+        ~StreamDecoder();
+
+        const Meta &get_meta() const;
+        size_t get_channel_count() const;
+        size_t get_sample_rate() const;
+        size_t get_block_count() const;
+
+        // Decodes the next block into samples_per_block interleaved 16-bit
+        // frames. Returns false once all blocks have been read.
+        bool read_block(s16 *output);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} } } }
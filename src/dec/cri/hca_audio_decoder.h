@@ -25,10 +25,17 @@ namespace cri {
 
     class HcaAudioDecoder final : public BaseAudioDecoder
     {
+    public:
+        bool supports_streaming() const override;
+
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
         res::Audio decode_impl(
             const Logger &logger, io::File &input_file) const override;
+        std::unique_ptr<res::StreamedAudio> decode_streamed_impl(
+            const Logger &logger, io::File &input_file) const override;
     };
 
 } } }
@@ -31,6 +31,12 @@ bool CwlImageDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.path.has_extension("cwl");
 }
 
+std::vector<dec::RecognitionSignature>
+    CwlImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("cwl")};
+}
+
 res::Image CwlImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool CwpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CwpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image CwpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool EogAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    EogAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> EogAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -33,6 +33,12 @@ bool PckArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return last_file_offset + last_file_size == input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    PckArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("pck")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> PckArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -62,8 +68,7 @@ std::unique_ptr<io::File> PckArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> PckArchiveDecoder::get_linked_formats() const
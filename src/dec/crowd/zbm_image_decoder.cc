@@ -31,6 +31,12 @@ bool ZbmImageDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.path.has_extension("zbm");
 }
 
+std::vector<dec::RecognitionSignature>
+    ZbmImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("zbm")};
+}
+
 res::Image ZbmImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -51,6 +51,12 @@ bool AppendixArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("appendix");
 }
 
+std::vector<dec::RecognitionSignature>
+    AppendixArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("appendix")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AppendixArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -47,6 +47,12 @@ bool GrImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("gr");
 }
 
+std::vector<dec::RecognitionSignature>
+    GrImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("gr")};
+}
+
 res::Image GrImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
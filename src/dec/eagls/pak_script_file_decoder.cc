@@ -50,6 +50,12 @@ bool PakScriptFileDecoder::is_recognized_impl(io::File &input_file) const
     return true;
 }
 
+std::vector<dec::RecognitionSignature>
+    PakScriptFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<io::File> PakScriptFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -39,6 +39,12 @@ bool AcpFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AcpFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> AcpFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
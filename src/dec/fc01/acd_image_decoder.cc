@@ -69,6 +69,12 @@ bool AcdImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AcdImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image AcdImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -104,6 +104,12 @@ bool McgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    McgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image McgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -60,6 +60,12 @@ bool MrgArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    MrgArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> MrgArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -30,6 +30,12 @@ bool Ex3ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Ex3ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Ex3ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,12 @@ bool BinArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("bin");
 }
 
+std::vector<dec::RecognitionSignature>
+    BinArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("bin")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> BinArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -57,8 +63,7 @@ std::unique_ptr<io::File> BinArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto output_file = std::make_unique<io::File>(entry->path, data);
+    auto output_file = read_plain_file(input_file, *entry);
     output_file->guess_extension();
     return output_file;
 }
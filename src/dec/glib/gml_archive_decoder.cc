@@ -43,6 +43,12 @@ bool GmlArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    GmlArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> GmlArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool PgxImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PgxImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image PgxImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -18,6 +18,7 @@
 #include "dec/gnu/gzip_archive_decoder.h"
 #include "algo/pack/zlib.h"
 #include "algo/range.h"
+#include "io/slice_byte_stream.h"
 
 using namespace au;
 using namespace au::dec::gnu;
@@ -89,7 +90,7 @@ std::unique_ptr<dec::ArchiveMeta> GzipArchiveDecoder::read_meta_impl(
             input_file.stream.skip(extra_field_size);
         }
 
-        auto entry = std::make_unique<PlainArchiveEntry>();
+        auto entry = std::make_unique<CompressedArchiveEntry>();
         entry->path = "";
 
         if (flags & Flags::FileName)
@@ -104,7 +105,8 @@ std::unique_ptr<dec::ArchiveMeta> GzipArchiveDecoder::read_meta_impl(
         entry->offset = input_file.stream.pos();
         const auto data = algo::pack::zlib_inflate(
             input_file.stream, algo::pack::ZlibKind::RawDeflate);
-        entry->size = input_file.stream.pos() - entry->offset;
+        entry->size_comp = input_file.stream.pos() - entry->offset;
+        entry->size_orig = data.size();
         input_file.stream.skip(8);
 
         meta->entries.push_back(std::move(entry));
@@ -119,12 +121,14 @@ std::unique_ptr<io::File> GzipArchiveDecoder::read_file_impl(
     const dec::ArchiveMeta &m,
     const dec::ArchiveEntry &e) const
 {
-    const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    input_file.stream.seek(entry->offset);
+    const auto entry = static_cast<const CompressedArchiveEntry*>(&e);
+    io::SliceByteStream entry_stream(
+        input_file.stream, entry->offset, entry->size_comp);
     return std::make_unique<io::File>(
         entry->path,
-        algo::pack::zlib_inflate(
-            input_file.stream.read(entry->size),
+        std::make_unique<algo::pack::ZlibInflateStream>(
+            entry_stream,
+            entry->size_orig,
             algo::pack::ZlibKind::RawDeflate));
 }
 
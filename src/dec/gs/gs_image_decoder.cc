@@ -29,6 +29,12 @@ bool GsImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    GsImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image GsImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool BmzImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    BmzImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image BmzImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -21,6 +21,7 @@
 #include <vector>
 #include "algo/naming_strategies.h"
 #include "arg_parser_decorator.h"
+#include "dec/recognition_signature.h"
 #include "io/file.h"
 
 namespace au {
@@ -40,6 +41,9 @@ namespace dec {
 
         virtual bool is_recognized(io::File &input_file) const = 0;
 
+        virtual std::vector<RecognitionSignature>
+            get_recognition_signatures() const = 0;
+
         virtual std::vector<std::string> get_linked_formats() const = 0;
 
         virtual algo::NamingStrategy naming_strategy() const = 0;
@@ -37,6 +37,12 @@ bool PackdatArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PackdatArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> PackdatArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -92,6 +92,12 @@ bool IsgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    IsgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image IsgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -118,6 +118,12 @@ bool PrsImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PrsImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image PrsImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -198,6 +198,12 @@ bool WadyAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WadyAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Audio WadyAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
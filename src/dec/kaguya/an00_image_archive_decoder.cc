@@ -44,6 +44,12 @@ bool An00ImageArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    An00ImageArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> An00ImageArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -28,6 +28,12 @@ bool Ap2ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Ap2ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Ap2ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
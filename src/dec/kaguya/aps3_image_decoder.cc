@@ -42,6 +42,12 @@ bool Aps3ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Aps3ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Aps3ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,8 @@ namespace kaguya {
     {
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
         int get_version() const override;
     };
 
@@ -61,6 +61,12 @@ bool CpsFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CpsFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> CpsFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -39,6 +39,12 @@ bool LnkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    LnkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> LnkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
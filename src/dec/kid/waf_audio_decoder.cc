@@ -27,6 +27,12 @@ bool WafAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WafAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Audio WafAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
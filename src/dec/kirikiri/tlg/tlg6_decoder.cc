@@ -16,10 +16,18 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/tlg/tlg6_decoder.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "algo/parallel.h"
 #include "algo/range.h"
 #include "dec/kirikiri/tlg/lzss_decompressor.h"
 #include "err.h"
 
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 using namespace au::dec::kirikiri::tlg;
 
@@ -89,6 +97,15 @@ static inline u32 to_bgra(res::Pixel p)
     return p.b | (p.g << 8) | (p.r << 16) | (p.a << 24);
 }
 
+static inline res::Pixel from_bgra(const u32 value)
+{
+    return {
+        static_cast<u8>(value),
+        static_cast<u8>(value >> 8),
+        static_cast<u8>(value >> 16),
+        static_cast<u8>(value >> 24)};
+}
+
 static void transformer0(res::Pixel &)
 {
 }
@@ -184,14 +201,37 @@ static void transformerF(res::Pixel &p)
     p.r += (p.b << 1);
 }
 
-static void (*transformers[16])(res::Pixel &p) =
+#if __SSE2__
+// SSE2 has unsigned byte min, max and rounding average, which take the
+// place of the packed 32-bit arithmetic below.
+static inline u32 med(u32 a, u32 b, u32 c, u32 v)
 {
-    &transformer0, &transformer1, &transformer2, &transformer3,
-    &transformer4, &transformer5, &transformer6, &transformer7,
-    &transformer8, &transformer9, &transformerA, &transformerB,
-    &transformerC, &transformerD, &transformerE, &transformerF,
-};
+    const auto xa = _mm_cvtsi32_si128(a);
+    const auto xb = _mm_cvtsi32_si128(b);
+    const auto xc = _mm_cvtsi32_si128(c);
+    const auto min = _mm_min_epu8(xa, xb);
+    const auto max = _mm_max_epu8(xa, xb);
+    const auto c_ge_max = _mm_cmpeq_epi8(_mm_max_epu8(xc, max), xc);
+    const auto c_le_min = _mm_cmpeq_epi8(_mm_min_epu8(xc, min), xc);
+    const auto gradient = _mm_add_epi8(_mm_sub_epi8(max, xc), min);
+    const auto prediction = _mm_or_si128(
+        _mm_and_si128(c_ge_max, min),
+        _mm_andnot_si128(
+            c_ge_max,
+            _mm_or_si128(
+                _mm_and_si128(c_le_min, max),
+                _mm_andnot_si128(c_le_min, gradient))));
+    return _mm_cvtsi128_si32(
+        _mm_add_epi8(prediction, _mm_cvtsi32_si128(v)));
+}
 
+static inline u32 avg(u32 a, u32 b, u32, u32 v)
+{
+    return _mm_cvtsi128_si32(_mm_add_epi8(
+        _mm_avg_epu8(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b)),
+        _mm_cvtsi32_si128(v)));
+}
+#else
 static inline u32 make_gt_mask(u32 a, u32 b)
 {
     u32 tmp2 = ~b;
@@ -223,14 +263,10 @@ static inline u32 avg(u32 a, u32 b, u32, u32 v)
         + (((a ^ b) & 0xFEFEFEFE) >> 1)
         + ((a ^ b) & 0x01010101), v);
 }
+#endif
 
-static void init_table()
+static void build_tables()
 {
-    static bool initialized = false;
-    if (initialized)
-        return;
-    initialized = true;
-
     short golomb_compression_table[golomb_n_count][9] =
     {
         {3, 7, 15, 27, 63, 108, 223, 448, 130},
@@ -269,6 +305,12 @@ static void init_table()
     }
 }
 
+static void init_table()
+{
+    static std::once_flag flag;
+    std::call_once(flag, build_tables);
+}
+
 static void decode_golomb_values(u8 *pixel_buf, int pixel_count, u8 *bit_pool)
 {
     int n = golomb_n_count - 1;
@@ -386,37 +428,89 @@ static void decode_golomb_values(u8 *pixel_buf, int pixel_count, u8 *bit_pool)
     }
 }
 
+// Decodes one block's worth of a line. Each block picks its own filter and
+// transformer, so they are resolved once per block rather than per pixel.
+template<
+    void (*transformer)(res::Pixel &),
+    u32 (*filter)(u32, u32, u32, u32)>
+static void decode_block(
+    const u32 *&in,
+    const int step,
+    const int w,
+    const res::Pixel *&prev_line,
+    res::Pixel *&current_line,
+    u32 &left,
+    u32 &top_left,
+    const u32 alpha_mask)
+{
+    for (const auto i : algo::range(w))
+    {
+        auto inn = from_bgra(*in);
+        transformer(inn);
+
+        const auto top = to_bgra(*prev_line++);
+        left = filter(left, top, top_left, to_bgra(inn)) | alpha_mask;
+        top_left = top;
+        *current_line++ = from_bgra(left);
+        in += step;
+    }
+}
+
+using BlockDecoder = void (*)(
+    const u32 *&, int, int, const res::Pixel *&, res::Pixel *&, u32 &, u32 &,
+    u32);
+
+// Indexed by the block's filter type: bit 0 selects avg over med, the rest
+// selects the transformer.
+static const BlockDecoder block_decoders[32] =
+{
+    &decode_block<transformer0, med>, &decode_block<transformer0, avg>,
+    &decode_block<transformer1, med>, &decode_block<transformer1, avg>,
+    &decode_block<transformer2, med>, &decode_block<transformer2, avg>,
+    &decode_block<transformer3, med>, &decode_block<transformer3, avg>,
+    &decode_block<transformer4, med>, &decode_block<transformer4, avg>,
+    &decode_block<transformer5, med>, &decode_block<transformer5, avg>,
+    &decode_block<transformer6, med>, &decode_block<transformer6, avg>,
+    &decode_block<transformer7, med>, &decode_block<transformer7, avg>,
+    &decode_block<transformer8, med>, &decode_block<transformer8, avg>,
+    &decode_block<transformer9, med>, &decode_block<transformer9, avg>,
+    &decode_block<transformerA, med>, &decode_block<transformerA, avg>,
+    &decode_block<transformerB, med>, &decode_block<transformerB, avg>,
+    &decode_block<transformerC, med>, &decode_block<transformerC, avg>,
+    &decode_block<transformerD, med>, &decode_block<transformerD, avg>,
+    &decode_block<transformerE, med>, &decode_block<transformerE, avg>,
+    &decode_block<transformerF, med>, &decode_block<transformerF, avg>,
+};
+
 static void decode_line(
-    res::Pixel *prev_line,
+    const res::Pixel *prev_line,
     res::Pixel *current_line,
     int start_block,
     int block_limit,
-    u8 *filter_types,
+    const u8 *filter_types,
     int skip_block_bytes,
-    u32 *in,
+    const u32 *in,
     int odd_skip,
     int dir,
     const Header &header)
 {
-    res::Pixel left, top_left;
-    int step;
+    const u32 alpha_mask = header.channel_count == 3 ? 0xFF000000 : 0;
+    u32 left, top_left;
 
     if (start_block)
     {
         prev_line += start_block * w_block_size;
         current_line += start_block * w_block_size;
-        left = current_line[-1];
-        top_left = prev_line[-1];
+        left = to_bgra(current_line[-1]);
+        top_left = to_bgra(prev_line[-1]);
     }
     else
     {
-        left.r = left.g = left.b = 0;
-        top_left.r = top_left.g = top_left.b = 0;
-        left.a = top_left.a = header.channel_count == 3 ? 0xFF : 0;
+        left = top_left = alpha_mask;
     }
 
     in += skip_block_bytes * start_block;
-    step = (dir & 1) ? 1 : -1;
+    const int step = (dir & 1) ? 1 : -1;
 
     for (const auto i : algo::range(start_block, block_limit))
     {
@@ -424,145 +518,215 @@ static void decode_line(
         if (w > w_block_size)
             w = w_block_size;
 
-        int ww = w;
         if (step == -1)
-            in += ww - 1;
+            in += w - 1;
+
+        if (i & 1)
+            in += odd_skip * w;
 
+        block_decoders[filter_types[i] & 0x1F](
+            in, step, w, prev_line, current_line, left, top_left, alpha_mask);
+
+        in += skip_block_bytes + (step == 1 ? - w : 1);
         if (i & 1)
-            in += odd_skip * ww;
+            in -= odd_skip * w;
+    }
+}
+
+// Turns a block row's decoded Golomb values into pixels. This needs the last
+// line of the previous block row, so it has to go in order.
+static void reconstruct_block_row(
+    res::Image &image,
+    const res::Pixel *prev_line,
+    const bstr &pixel_buf,
+    const u8 *ft,
+    const size_t y,
+    const Header &header)
+{
+    const u32 main_count = header.image_width / w_block_size;
+    u32 ylim = y + h_block_size;
+    if (ylim >= header.image_height)
+        ylim = header.image_height;
+
+    int skip_bytes = (ylim - y) * w_block_size;
+
+    for (const auto yy : algo::range(y, ylim))
+    {
+        auto *current_line = &image.at(0, yy);
 
-        auto filter = filter_types[i] & 1 ? &avg : &med;
-        auto transformer = transformers[filter_types[i] >> 1];
+        int dir = (yy & 1) ^ 1;
+        int odd_skip = ((ylim - yy -1) - (yy - y));
 
-        do
+        if (main_count)
         {
-            res::Pixel inn;
-            inn.a = *in >> 24;
-            inn.r = *in >> 16;
-            inn.g = *in >> 8;
-            inn.b = *in;
-            transformer(inn);
-
-            res::Pixel top = *prev_line;
-            auto result = filter(
-                to_bgra(left),
-                to_bgra(top),
-                to_bgra(top_left),
-                to_bgra(inn));
-            left.a = result >> 24;
-            left.r = result >> 16;
-            left.g = result >> 8;
-            left.b = result;
-            if (header.channel_count == 3)
-                left.a = 0xFF;
-
-            top_left = top;
-            *current_line++ = left;
-
-            prev_line++;
-            in += step;
+            int start = ((header.image_width < w_block_size)
+                ? header.image_width
+                : w_block_size) * (yy - y);
+
+            decode_line(
+                prev_line,
+                current_line,
+                0,
+                main_count,
+                ft,
+                skip_bytes,
+                pixel_buf.get<const u32>() + start,
+                odd_skip,
+                dir,
+                header);
         }
-        while (--w);
 
-        in += skip_block_bytes + (step == 1 ? - ww : 1);
-        if (i & 1)
-            in -= odd_skip * ww;
+        if (main_count != header.x_block_count)
+        {
+            int ww = header.image_width - main_count * w_block_size;
+            if (ww > w_block_size)
+                ww = w_block_size;
+
+            int start = ww * (yy - y);
+            decode_line(
+                prev_line,
+                current_line,
+                main_count,
+                header.x_block_count,
+                ft,
+                skip_bytes,
+                pixel_buf.get<const u32>() + start,
+                odd_skip,
+                dir,
+                header);
+        }
+
+        prev_line = current_line;
     }
 }
 
 static void read_image(
-    io::BaseByteStream &input_stream, res::Image &image, const Header &header)
+    io::BaseByteStream &input_stream,
+    res::Image &image,
+    const Header &header,
+    const size_t thread_count)
 {
     FilterTypes filter_types(input_stream);
     filter_types.decompress(header);
 
-    bstr pixel_buf(4 * header.image_width * h_block_size);
-    auto zero_line = std::make_unique<res::Pixel[]>(header.image_width);
-    res::Pixel *prev_line = zero_line.get();
-
-    u32 main_count = header.image_width / w_block_size;
-    for (const auto y : algo::range(0, header.image_height, h_block_size))
+    // Each block row stores its channels as length-prefixed Golomb-coded bit
+    // pools, so they can be read up front and decoded independently.
+    const auto row_count = header.y_block_count;
+    std::vector<bstr> bit_pools;
+    for (const auto row : algo::range(row_count))
+    for (const auto c : algo::range(header.channel_count))
     {
-        u32 ylim = y + h_block_size;
-        if (ylim >= header.image_height)
-            ylim = header.image_height;
+        u32 bit_size = input_stream.read_le<u32>();
 
-        int pixel_count = (ylim - y) * header.image_width;
-        for (const auto c : algo::range(header.channel_count))
-        {
-            u32 bit_size = input_stream.read_le<u32>();
-
-            int method = (bit_size >> 30) & 3;
-            bit_size &= 0x3FFFFFFF;
+        int method = (bit_size >> 30) & 3;
+        bit_size &= 0x3FFFFFFF;
+        if (method != 0)
+            throw err::NotSupportedError("Unsupported encoding method");
 
-            int byte_size = (bit_size + 7) / 8;
-            bstr bit_pool = input_stream.read(byte_size);
+        int byte_size = (bit_size + 7) / 8;
+        bit_pools.push_back(input_stream.read(byte_size));
 
-            // Although decode_golomb_values accesses only valid bits, it uses
-            // reinterpret_cast<u32*>() that might access bits out of bounds.
-            // This is to make sure those calls don't cause access violation.
-            bit_pool.resize(byte_size + 4);
-
-            if (method != 0)
-                throw err::NotSupportedError("Unsupported encoding method");
+        // Although decode_golomb_values accesses only valid bits, it uses
+        // reinterpret_cast<u32*>() that might access bits out of bounds.
+        // This is to make sure those calls don't cause access violation.
+        bit_pools.back().resize(byte_size + 4);
+    }
 
+    std::vector<bstr> pixel_bufs(row_count);
+    const auto decode_row = [&](const size_t row)
+    {
+        const auto y = row * h_block_size;
+        const auto height = std::min<size_t>(
+            h_block_size, header.image_height - y);
+        pixel_bufs[row] = bstr(4 * header.image_width * h_block_size);
+        for (const auto c : algo::range(header.channel_count))
+        {
+            auto &bit_pool = bit_pools[row * header.channel_count + c];
             decode_golomb_values(
-                pixel_buf.get<u8>() + c, pixel_count, bit_pool.get<u8>());
+                pixel_bufs[row].get<u8>() + c,
+                height * header.image_width,
+                bit_pool.get<u8>());
+            bit_pool = bstr();
         }
+    };
 
-        u8 *ft = filter_types.data.get<u8>()
-            + (y / h_block_size) * header.x_block_count;
-        int skip_bytes = (ylim - y) * w_block_size;
+    const auto zero_line = std::make_unique<res::Pixel[]>(header.image_width);
+    const auto reconstruct_row = [&](const size_t row)
+    {
+        const auto y = row * h_block_size;
+        reconstruct_block_row(
+            image,
+            y ? &image.at(0, y - 1) : zero_line.get(),
+            pixel_bufs[row],
+            filter_types.data.get<const u8>() + row * header.x_block_count,
+            y,
+            header);
+        pixel_bufs[row] = bstr();
+    };
 
-        for (const auto yy : algo::range(y, ylim))
+    if (thread_count <= 1 || row_count < 2)
+    {
+        for (const auto row : algo::range(row_count))
         {
-            auto *current_line = &image.at(0, yy);
+            decode_row(row);
+            reconstruct_row(row);
+        }
+        return;
+    }
 
-            int dir = (yy & 1) ^ 1;
-            int odd_skip = ((ylim - yy -1) - (yy - y));
+    // One thread reconstructs each block row as soon as it is ready, while
+    // the rest take block rows in order and decode their Golomb values.
+    std::mutex mutex;
+    std::condition_variable row_ready;
+    std::vector<bool> ready(row_count, false);
+    std::atomic<size_t> next_row(0);
+    bool failed = false;
 
-            if (main_count)
+    algo::run_in_parallel(thread_count, [&](const size_t i)
+    {
+        if (i == 0)
+        {
+            for (const auto row : algo::range(row_count))
             {
-                int start = ((header.image_width < w_block_size)
-                    ? header.image_width
-                    : w_block_size) * (yy - y);
-
-                decode_line(
-                    prev_line,
-                    current_line,
-                    0,
-                    main_count,
-                    ft,
-                    skip_bytes,
-                    pixel_buf.get<u32>() + start,
-                    odd_skip,
-                    dir,
-                    header);
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    row_ready.wait(
+                        lock, [&]() { return ready[row] || failed; });
+                    if (failed)
+                        return;
+                }
+                reconstruct_row(row);
             }
+            return;
+        }
 
-            if (main_count != header.x_block_count)
+        try
+        {
+            for (auto row = next_row++; row < row_count; row = next_row++)
+            {
+                decode_row(row);
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready[row] = true;
+                }
+                row_ready.notify_all();
+            }
+        }
+        catch (...)
+        {
             {
-                int ww = header.image_width - main_count * w_block_size;
-                if (ww > w_block_size)
-                    ww = w_block_size;
-
-                int start = ww * (yy - y);
-                decode_line(
-                    prev_line,
-                    current_line,
-                    main_count,
-                    header.x_block_count,
-                    ft,
-                    skip_bytes,
-                    pixel_buf.get<u32>() + start,
-                    odd_skip,
-                    dir,
-                    header);
+                std::unique_lock<std::mutex> lock(mutex);
+                failed = true;
             }
-
-            prev_line = current_line;
+            row_ready.notify_all();
+            throw;
         }
-    }
+    });
+}
+
+Tlg6Decoder::Tlg6Decoder(const size_t thread_count)
+    : thread_count(thread_count)
+{
 }
 
 res::Image Tlg6Decoder::decode(io::File &file)
@@ -584,6 +748,6 @@ res::Image Tlg6Decoder::decode(io::File &file)
         throw err::UnsupportedChannelCountError(header.channel_count);
 
     res::Image image(header.image_width, header.image_height);
-    read_image(file.stream, image, header);
+    read_image(file.stream, image, header, thread_count);
     return image;
 }
@@ -28,7 +28,14 @@ namespace tlg {
     class Tlg6Decoder final
     {
     public:
+        // Uses up to thread_count threads in total: one reconstructs block
+        // rows while the others entropy-decode them ahead of it.
+        Tlg6Decoder(const size_t thread_count = 1);
+
         res::Image decode(io::File &file);
+
+    private:
+        const size_t thread_count;
     };
 
 } } } }
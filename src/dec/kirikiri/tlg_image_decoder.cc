@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/tlg_image_decoder.h"
+#include "algo/str.h"
 #include "dec/kirikiri/tlg/tlg5_decoder.h"
 #include "dec/kirikiri/tlg/tlg6_decoder.h"
 #include "err.h"
@@ -29,7 +30,8 @@ static const bstr magic_tlg_5 = "TLG5.0\x00raw\x1A"_b;
 static const bstr magic_tlg_6 = "TLG6.0\x00raw\x1A"_b;
 
 static int guess_version(io::BaseByteStream &input_stream);
-static res::Image decode_proxy(int version, io::File &input_file);
+static res::Image decode_proxy(
+    int version, io::File &input_file, const size_t thread_count);
 
 static std::string extract_string(std::string &container)
 {
@@ -46,7 +48,8 @@ static std::string extract_string(std::string &container)
     return str;
 }
 
-static res::Image decode_tlg_0(io::File &input_file)
+static res::Image decode_tlg_0(
+    io::File &input_file, const size_t thread_count)
 {
     const auto raw_data_size = input_file.stream.read_le<u32>();
     const auto raw_data_offset = input_file.stream.pos();
@@ -77,7 +80,7 @@ static res::Image decode_tlg_0(io::File &input_file)
     int version = guess_version(input_file.stream);
     if (version == -1)
         throw err::UnsupportedVersionError();
-    return decode_proxy(version, input_file);
+    return decode_proxy(version, input_file, thread_count);
 }
 
 static res::Image decode_tlg_5(io::File &input_file)
@@ -85,9 +88,10 @@ static res::Image decode_tlg_5(io::File &input_file)
     return Tlg5Decoder().decode(input_file);
 }
 
-static res::Image decode_tlg_6(io::File &input_file)
+static res::Image decode_tlg_6(
+    io::File &input_file, const size_t thread_count)
 {
-    return Tlg6Decoder().decode(input_file);
+    return Tlg6Decoder(thread_count).decode(input_file);
 }
 
 static int guess_version(io::BaseByteStream &input_stream)
@@ -107,22 +111,44 @@ static int guess_version(io::BaseByteStream &input_stream)
     return -1;
 }
 
-static res::Image decode_proxy(int version, io::File &input_file)
+static res::Image decode_proxy(
+    int version, io::File &input_file, const size_t thread_count)
 {
     switch (version)
     {
         case 0:
-            return decode_tlg_0(input_file);
+            return decode_tlg_0(input_file, thread_count);
 
         case 5:
             return decode_tlg_5(input_file);
 
         case 6:
-            return decode_tlg_6(input_file);
+            return decode_tlg_6(input_file, thread_count);
     }
     throw std::logic_error("Unknown TLG version");
 }
 
+TlgImageDecoder::TlgImageDecoder() : thread_count(1)
+{
+    add_arg_parser_decorator(
+        [](ArgParser &arg_parser)
+        {
+            arg_parser.register_switch({"--tlg-threads"})
+                ->set_value_name("NUM")
+                ->set_description(
+                    "Decodes TLG6 images on up to NUM threads each "
+                    "(defaults to 1).");
+        },
+        [&](const ArgParser &arg_parser)
+        {
+            if (arg_parser.has_switch("tlg-threads"))
+            {
+                thread_count = std::max<int>(1, algo::from_string<int>(
+                    arg_parser.get_switch("tlg-threads")));
+            }
+        });
+}
+
 bool TlgImageDecoder::is_recognized_impl(io::File &input_file) const
 {
     return guess_version(input_file.stream) >= 0;
@@ -132,7 +158,7 @@ res::Image TlgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
     int version = guess_version(input_file.stream);
-    return decode_proxy(version, input_file);
+    return decode_proxy(version, input_file, thread_count);
 }
 
 static auto _ = dec::register_decoder<TlgImageDecoder>("kirikiri/tlg");
@@ -25,10 +25,16 @@ namespace kirikiri {
 
     class TlgImageDecoder final : public BaseImageDecoder
     {
+    public:
+        TlgImageDecoder();
+
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
         res::Image decode_impl(
             const Logger &logger, io::File &input_file) const override;
+
+    private:
+        size_t thread_count;
     };
 
 } } }
@@ -21,6 +21,7 @@
 #include "algo/range.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
+#include "io/slice_byte_stream.h"
 
 using namespace au;
 using namespace au::dec::kirikiri;
@@ -234,7 +235,7 @@ std::unique_ptr<dec::ArchiveMeta> Xp3ArchiveDecoder::read_meta_impl(
 
     auto table_data = input_file.stream.read(table_size_comp);
     if (table_is_compressed)
-        table_data = algo::pack::zlib_inflate(table_data);
+        table_data = algo::pack::zlib_inflate(table_data, table_size_orig);
     io::MemoryByteStream table_stream(table_data);
 
     auto meta = std::make_unique<CustomArchiveMeta>();
@@ -270,15 +271,29 @@ std::unique_ptr<io::File> Xp3ArchiveDecoder::read_file_impl(
     const auto meta = static_cast<const CustomArchiveMeta*>(&m);
     const auto entry = static_cast<const CustomArchiveEntry*>(&e);
 
+    size_t size_orig = 0;
+    for (const auto &segm_chunk : entry->segm_chunks)
+        size_orig += segm_chunk->size_orig;
+
     bstr data;
+    data.reserve(size_orig);
     for (const auto &segm_chunk : entry->segm_chunks)
     {
         const auto data_is_compressed = segm_chunk->flags & 7;
-        input_file.stream.seek(segm_chunk->offset);
-        data += data_is_compressed
-            ? algo::pack::zlib_inflate(
-                input_file.stream.read(segm_chunk->size_comp))
-            : input_file.stream.read(segm_chunk->size_orig);
+        if (!data_is_compressed)
+        {
+            input_file.stream.seek(segm_chunk->offset);
+            data += input_file.stream.read(segm_chunk->size_orig);
+            continue;
+        }
+        io::SliceByteStream segm_stream(
+            input_file.stream, segm_chunk->offset, segm_chunk->size_comp);
+        auto segm_data = algo::pack::zlib_inflate(
+            segm_stream, segm_chunk->size_orig);
+        if (entry->segm_chunks.size() == 1)
+            data = std::move(segm_data);
+        else
+            data += segm_data;
     }
 
     if (meta->decrypt_func)
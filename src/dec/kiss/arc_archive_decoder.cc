@@ -37,6 +37,12 @@ bool ArcArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return last_entry->size + last_entry->offset == input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    ArcArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("arc")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> ArcArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -69,8 +75,7 @@ std::unique_ptr<io::File> ArcArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> ArcArchiveDecoder::get_linked_formats() const
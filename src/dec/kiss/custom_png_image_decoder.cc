@@ -30,6 +30,12 @@ bool CustomPngImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CustomPngImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image CustomPngImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,12 @@ bool BbmImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("bbm");
 }
 
+std::vector<dec::RecognitionSignature>
+    BbmImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("bbm")};
+}
+
 res::Image BbmImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool BjrImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("bjr");
 }
 
+std::vector<dec::RecognitionSignature>
+    BjrImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("bjr")};
+}
+
 res::Image BjrImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
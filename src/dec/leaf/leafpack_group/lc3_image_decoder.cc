@@ -28,6 +28,12 @@ bool Lc3ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Lc3ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Lc3ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,12 @@ bool LfbImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("lfb");
 }
 
+std::vector<dec::RecognitionSignature>
+    LfbImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("lfb")};
+}
+
 res::Image LfbImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
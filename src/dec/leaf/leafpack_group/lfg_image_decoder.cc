@@ -82,6 +82,12 @@ bool LfgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    LfgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image LfgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -25,6 +25,12 @@ bool P16AudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("P16");
 }
 
+std::vector<dec::RecognitionSignature>
+    P16AudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("P16")};
+}
+
 res::Audio P16AudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
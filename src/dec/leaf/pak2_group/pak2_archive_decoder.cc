@@ -40,6 +40,12 @@ bool Pak2ArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return true;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pak2ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("pak")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pak2ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -74,8 +80,7 @@ std::unique_ptr<io::File> Pak2ArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> Pak2ArchiveDecoder::get_linked_formats() const
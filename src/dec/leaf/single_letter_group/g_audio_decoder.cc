@@ -60,6 +60,12 @@ bool GAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(4).read(10) == "\x00\x02\0\0\0\0\0\0\0\0"_b;
 }
 
+std::vector<dec::RecognitionSignature>
+    GAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("g")};
+}
+
 std::unique_ptr<io::File> GAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
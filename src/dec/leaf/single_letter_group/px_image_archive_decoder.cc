@@ -470,6 +470,12 @@ bool PxImageArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("px");
 }
 
+std::vector<dec::RecognitionSignature>
+    PxImageArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("px")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> PxImageArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -31,6 +31,12 @@ bool WAudioDecoder::is_recognized_impl(io::File &input_file) const
     return data_size + 18 == input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    WAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("w")};
+}
+
 res::Audio WAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
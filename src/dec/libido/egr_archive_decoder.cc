@@ -38,6 +38,12 @@ bool EgrArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("egr");
 }
 
+std::vector<dec::RecognitionSignature>
+    EgrArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("egr")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> EgrArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -28,6 +28,12 @@ bool MncImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    MncImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image MncImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -117,6 +117,12 @@ bool AbmImageDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    AbmImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("abm")};
+}
+
 res::Image AbmImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
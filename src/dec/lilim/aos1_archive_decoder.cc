@@ -29,6 +29,12 @@ bool Aos1ArchiveDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.stream.read_le<u32>() > 0;
 }
 
+std::vector<dec::RecognitionSignature>
+    Aos1ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("aos")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Aos1ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -64,8 +70,7 @@ std::unique_ptr<io::File> Aos1ArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> Aos1ArchiveDecoder::get_linked_formats() const
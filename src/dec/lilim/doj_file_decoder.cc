@@ -31,6 +31,12 @@ bool DojFileDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.stream.read(magic1.size()) == magic1;
 }
 
+std::vector<dec::RecognitionSignature>
+    DojFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("doj")};
+}
+
 std::unique_ptr<io::File> DojFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
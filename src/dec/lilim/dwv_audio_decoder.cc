@@ -29,6 +29,12 @@ bool DwvAudioDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    DwvAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dwv")};
+}
+
 res::Audio DwvAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -16,40 +16,22 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/lilim/scr_file_decoder.h"
+#include <algorithm>
+#include "algo/pack/huffman.h"
 #include "io/msb_bit_stream.h"
 
 using namespace au;
 using namespace au::dec::lilim;
 
-static int init_huffman(
-    io::BaseBitStream &bit_stream, u16 nodes[2][512], int &size)
-{
-    if (!bit_stream.read(1))
-        return bit_stream.read(8);
-    const auto pos = size;
-    if (pos > 511)
-        return -1;
-    size++;
-    nodes[0][pos] = init_huffman(bit_stream, nodes, size);
-    nodes[1][pos] = init_huffman(bit_stream, nodes, size);
-    return pos;
-}
-
 static bstr decode_huffman(const bstr &input, const size_t target_size)
 {
-    bstr output;
-    output.reserve(input.size() * 2);
+    // every code takes at least one bit, don't trust the header blindly
+    bstr output(std::min<size_t>(target_size, input.size() * 8));
     io::MsbBitStream bit_stream(input);
-    u16 nodes[2][512];
-    auto size = 256;
-    auto root = init_huffman(bit_stream, nodes, size);
-    while (output.size() < target_size && bit_stream.left())
-    {
-        auto byte = root;
-        while (byte >= 256 && byte <= 511)
-            byte = nodes[bit_stream.read(1)][byte];
-        output += static_cast<const u8>(byte);
-    }
+    const algo::pack::HuffmanTree huffman_tree(bit_stream);
+    const algo::pack::HuffmanDecoder huffman_decoder(huffman_tree);
+    output.resize(huffman_decoder.decode(
+        bit_stream, output.get<u8>(), output.size()));
     return output;
 }
 
@@ -58,6 +40,12 @@ bool ScrFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("scr");
 }
 
+std::vector<dec::RecognitionSignature>
+    ScrFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("scr")};
+}
+
 std::unique_ptr<io::File> ScrFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -280,6 +280,12 @@ bool ElgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    ElgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image ElgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
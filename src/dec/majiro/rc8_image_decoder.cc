@@ -81,6 +81,12 @@ bool Rc8ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Rc8ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Rc8ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
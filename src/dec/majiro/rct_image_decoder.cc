@@ -146,6 +146,12 @@ bool RctImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    RctImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image RctImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
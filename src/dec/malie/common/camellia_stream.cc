@@ -16,13 +16,49 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/malie/common/camellia_stream.h"
+#include <algorithm>
 #include <cstring>
-#include "algo/range.h"
-#include "io/memory_byte_stream.h"
+#include "algo/endian.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::dec::malie::common;
 
+static const size_t block_size = 0x10;
+static const size_t cache_size = 0x1000;
+
+static uoff_t align_down(const uoff_t offset)
+{
+    return offset & ~static_cast<uoff_t>(block_size - 1);
+}
+
+static uoff_t align_up(const uoff_t offset)
+{
+    return align_down(offset + block_size - 1);
+}
+
+// Decrypts whole blocks; input and output may point to the same buffer.
+static void decrypt_blocks(
+    const algo::crypt::Camellia &camellia,
+    const uoff_t offset,
+    const u8 *input,
+    u8 *output,
+    const size_t size)
+{
+    u32 input_block[4];
+    u32 output_block[4];
+    for (size_t i = 0; i < size; i += block_size)
+    {
+        std::memcpy(input_block, input + i, block_size);
+        for (auto &word : input_block)
+            word = algo::from_little_endian(word);
+        camellia.decrypt_block_128(offset + i, input_block, output_block);
+        for (auto &word : output_block)
+            word = algo::to_big_endian(word);
+        std::memcpy(output + i, output_block, block_size);
+    }
+}
+
 CamelliaStream::CamelliaStream(
     io::BaseByteStream &parent_stream, const std::vector<u32> &key)
         : CamelliaStream(parent_stream, key, 0, parent_stream.size())
@@ -37,7 +73,8 @@ CamelliaStream::CamelliaStream(
         key(key),
         parent_stream(parent_stream.clone()),
         parent_stream_offset(offset),
-        parent_stream_size(size)
+        parent_stream_size(size),
+        cache_offset(0)
 {
     if (key.size())
         camellia = std::make_unique<algo::crypt::Camellia>(key);
@@ -61,34 +98,62 @@ void CamelliaStream::read_impl(void *destination, const size_t size)
         return;
     }
 
-    const auto old_pos = parent_stream->pos();
-    const auto offset_pad = parent_stream->pos() & 0xF;
-    const auto offset_start = parent_stream->pos() & ~0xF;
-    const auto aligned_size = (offset_pad + size + 0xF) & ~0xF;
-    const auto block_count = (aligned_size + 0xF) / 0x10;
-    if (block_count == 0)
-        return;
-
-    parent_stream->seek(parent_stream_offset
-        + ((parent_stream->pos() - parent_stream_offset) - offset_pad));
+    const auto start = parent_stream->pos();
+    const auto end = start + size;
+    const auto aligned_start = align_down(start);
+    const auto aligned_size = align_up(end) - aligned_start;
 
-    io::MemoryByteStream output_stream;
-    output_stream.resize(block_count * 16);
-    output_stream.seek(0);
-    for (const auto i : algo::range(block_count))
+    if (aligned_size > cache_size)
+    {
+        auto chunk = parent_stream->seek(aligned_start).read(aligned_size);
+        if (aligned_start == start && aligned_size == size)
+        {
+            decrypt_blocks(
+                *camellia,
+                start,
+                chunk.get<const u8>(),
+                static_cast<u8*>(destination),
+                size);
+        }
+        else
+        {
+            decrypt_blocks(
+                *camellia,
+                aligned_start,
+                chunk.get<const u8>(),
+                chunk.get<u8>(),
+                chunk.size());
+            std::memcpy(
+                destination,
+                chunk.get<const u8>() + (start - aligned_start),
+                size);
+        }
+    }
+    else
     {
-        u32 input_block[4];
-        u32 output_block[4];
-        for (const auto j : algo::range(4))
-            input_block[j] = parent_stream->read_le<u32>();
-        camellia->decrypt_block_128(
-            offset_start + i * 0x10, input_block, output_block);
-        for (const auto j : algo::range(4))
-            output_stream.write_be<u32>(output_block[j]);
+        if (start < cache_offset || end > cache_offset + cache.size())
+        {
+            // read ahead as far as whole blocks allow, but never less than
+            // requested so that truncated input still fails with EofError
+            const auto parent_size = parent_stream->size();
+            const auto available = parent_size > aligned_start
+                ? align_down(parent_size - aligned_start)
+                : 0;
+            const auto fill_size = std::max<uoff_t>(
+                aligned_size, std::min<uoff_t>(cache_size, available));
+            cache = parent_stream->seek(aligned_start).read(fill_size);
+            cache_offset = aligned_start;
+            decrypt_blocks(
+                *camellia,
+                cache_offset,
+                cache.get<const u8>(),
+                cache.get<u8>(),
+                cache.size());
+        }
+        std::memcpy(
+            destination, cache.get<const u8>() + (start - cache_offset), size);
     }
-    const auto chunk = output_stream.seek(offset_pad).read(size);
-    std::memcpy(destination, chunk.get<u8>(), size);
-    parent_stream->seek(old_pos + size);
+    parent_stream->seek(end);
 }
 
 void CamelliaStream::write_impl(const void *source, const size_t size)
@@ -108,6 +173,7 @@ uoff_t CamelliaStream::size() const
 
 void CamelliaStream::resize_impl(const uoff_t new_size)
 {
+    cache = ""_b;
     parent_stream->resize(new_size);
 }
 
@@ -26,7 +26,9 @@ namespace malie {
 namespace common {
 
     // Rather than decrypting to bstr, the decryption is implemented as stream,
-    // so that huge files occupy as little memory as possible
+    // so that huge files occupy as little memory as possible. Small reads are
+    // served from a cache of decrypted blocks, big ones are decrypted in bulk
+    // straight into the caller's buffer.
     class CamelliaStream final : public io::BaseByteStream
     {
     public:
@@ -55,6 +57,8 @@ namespace common {
         std::unique_ptr<io::BaseByteStream> parent_stream;
         const uoff_t parent_stream_offset;
         const uoff_t parent_stream_size;
+        bstr cache;
+        uoff_t cache_offset;
     };
 
 } } } }
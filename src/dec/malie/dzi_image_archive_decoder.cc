@@ -87,6 +87,12 @@ bool DziImageArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    DziImageArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 algo::NamingStrategy DziImageArchiveDecoder::naming_strategy() const
 {
     return algo::NamingStrategy::Sibling;
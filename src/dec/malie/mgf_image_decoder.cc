@@ -28,6 +28,12 @@ bool MgfImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    MgfImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image MgfImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
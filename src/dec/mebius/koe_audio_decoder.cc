@@ -32,6 +32,17 @@ bool KoeAudioDecoder::is_recognized_impl(io::File &input_file) const
         || input_file.path.has_extension("koe"));
 }
 
+std::vector<dec::RecognitionSignature>
+    KoeAudioDecoder::get_recognition_signatures_impl() const
+{
+    return
+    {
+        dec::RecognitionSignature::extension("bgm"),
+        dec::RecognitionSignature::extension("mse"),
+        dec::RecognitionSignature::extension("koe"),
+    };
+}
+
 res::Audio KoeAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
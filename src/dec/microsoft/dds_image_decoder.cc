@@ -153,6 +153,12 @@ bool DdsImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    DdsImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image DdsImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -16,9 +16,17 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/microsoft/dxt/dxt_decoders.h"
+#include <cstring>
+#include "algo/endian.h"
 #include "algo/range.h"
+#include "err.h"
 
 using namespace au;
+using namespace au::dec::microsoft;
+
+static const size_t dxt1_block_size = 8;
+static const size_t dxt3_block_size = 16;
+static const size_t dxt5_block_size = 16;
 
 static std::unique_ptr<res::Image> create_image(
     const size_t width, const size_t height)
@@ -26,14 +34,18 @@ static std::unique_ptr<res::Image> create_image(
     return std::make_unique<res::Image>((width + 3) & ~3, (height + 3) & ~3);
 }
 
-static void decode_dxt1_block(
-    io::BaseByteStream &input_stream, res::Pixel output_colors[4][4])
+static size_t get_input_size(
+    const size_t width, const size_t height, const size_t block_size)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * block_size;
+}
+
+static void decode_color_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
 {
     res::Pixel colors[4];
-    const auto tmp = input_stream.read(4);
-    const auto *tmp_ptr = tmp.get<const u8>();
-    colors[0] = res::read_pixel<res::PixelFormat::BGR565>(tmp_ptr);
-    colors[1] = res::read_pixel<res::PixelFormat::BGR565>(tmp_ptr);
+    colors[0] = res::read_pixel<res::PixelFormat::BGR565>(input);
+    colors[1] = res::read_pixel<res::PixelFormat::BGR565>(input);
     const auto transparent
         = colors[0].b <= colors[1].b
         && colors[0].g <= colors[1].g
@@ -54,115 +66,155 @@ static void decode_dxt1_block(
         }
     }
 
-    auto lookup = input_stream.read_le<u32>();
+    u32 lookup;
+    std::memcpy(&lookup, input, 4);
+    lookup = algo::from_little_endian(lookup);
+    for (const auto y : algo::range(4))
+    {
+        output[0] = colors[lookup & 3];
+        output[1] = colors[(lookup >> 2) & 3];
+        output[2] = colors[(lookup >> 4) & 3];
+        output[3] = colors[(lookup >> 6) & 3];
+        output += stride;
+        lookup >>= 8;
+    }
+}
+
+static void decode_dxt3_alpha_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
+{
     for (const auto y : algo::range(4))
-    for (const auto x : algo::range(4))
     {
-        const auto index = lookup & 3;
-        output_colors[y][x] = colors[index];
-        lookup >>= 2;
+        output[0].a = input[0] & 0xF0;
+        output[1].a = input[0] << 4;
+        output[2].a = input[1] & 0xF0;
+        output[3].a = input[1] << 4;
+        output += stride;
+        input += 2;
     }
 }
 
-static void decode_dxt5_block(
-    io::BaseByteStream &input_stream, u8 output_alpha[4][4])
+static void decode_dxt5_alpha_block(
+    const u8 *input, res::Pixel *output, const size_t stride)
 {
     u8 alpha[8];
-    alpha[0] = input_stream.read<u8>();
-    alpha[1] = input_stream.read<u8>();
+    alpha[0] = input[0];
+    alpha[1] = input[1];
 
     if (alpha[0] > alpha[1])
     {
         for (const auto i : algo::range(2, 8))
-            alpha[i] = ((8. - i) * alpha[0] + ((i - 1.) * alpha[1])) / 7.;
+            alpha[i] = ((8 - i) * alpha[0] + (i - 1) * alpha[1]) / 7;
     }
     else
     {
         for (const auto i : algo::range(2, 6))
-            alpha[i] = ((6. - i) * alpha[0] + ((i - 1.) * alpha[1])) / 5.;
+            alpha[i] = ((6 - i) * alpha[0] + (i - 1) * alpha[1]) / 5;
         alpha[6] = 0;
         alpha[7] = 255;
     }
 
-    for (const auto i : algo::range(2))
+    // 16 3-bit indices packed into 6 bytes
+    u64 lookup = 0;
+    std::memcpy(&lookup, input + 2, 6);
+    lookup = algo::from_little_endian(lookup);
+    for (const auto y : algo::range(4))
     {
-        u32 lookup = input_stream.read<u8>();
-        lookup |= input_stream.read<u8>() << 8;
-        lookup |= input_stream.read<u8>() << 16;
-        for (const auto j : algo::range(8))
-        {
-            const auto index = lookup & 7;
-            const auto pos = i * 8 + j;
-            const auto x = pos % 4;
-            const auto y = pos / 4;
-            lookup >>= 3;
-            output_alpha[y][x] = alpha[index];
-        }
+        output[0].a = alpha[lookup & 7];
+        output[1].a = alpha[(lookup >> 3) & 7];
+        output[2].a = alpha[(lookup >> 6) & 7];
+        output[3].a = alpha[(lookup >> 9) & 7];
+        output += stride;
+        lookup >>= 12;
     }
 }
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt1(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
+template<typename T> static std::unique_ptr<res::Image> decode_blocks(
+    const bstr &input,
+    const size_t width,
+    const size_t height,
+    const size_t block_size,
+    const T &decode_block)
 {
+    if (input.size() < get_input_size(width, height, block_size))
+        throw err::BadDataSizeError();
+
     auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
+    const auto stride = image->width();
+    auto input_ptr = input.get<const u8>();
+    for (const auto block_y : algo::range(0, image->height(), 4))
     {
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(4))
-            image->at(block_x + x, block_y + y) = colors[y][x];
+        auto output_ptr = &image->at(0, block_y);
+        for (const auto block_x : algo::range(0, stride, 4))
+        {
+            decode_block(input_ptr, output_ptr, stride);
+            input_ptr += block_size;
+            output_ptr += 4;
+        }
     }
     return image;
 }
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt3(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
+std::unique_ptr<res::Image> dxt::decode_dxt1(
+    const bstr &input, const size_t width, const size_t height)
 {
-    auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
-    {
-        u8 alpha[4][4];
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(0, 4, 2))
+    return decode_blocks(
+        input, width, height, dxt1_block_size, decode_color_block);
+}
+
+std::unique_ptr<res::Image> dxt::decode_dxt3(
+    const bstr &input, const size_t width, const size_t height)
+{
+    return decode_blocks(
+        input,
+        width,
+        height,
+        dxt3_block_size,
+        [](const u8 *input, res::Pixel *output, const size_t stride)
         {
-            const auto b = input_stream.read<u8>();
-            alpha[y][x + 0] = b & 0xF0;
-            alpha[y][x + 1] = (b & 0x0F) << 4;
-        }
+            decode_color_block(input + 8, output, stride);
+            decode_dxt3_alpha_block(input, output, stride);
+        });
+}
 
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(4))
+std::unique_ptr<res::Image> dxt::decode_dxt5(
+    const bstr &input, const size_t width, const size_t height)
+{
+    return decode_blocks(
+        input,
+        width,
+        height,
+        dxt5_block_size,
+        [](const u8 *input, res::Pixel *output, const size_t stride)
         {
-            colors[y][x].a = alpha[y][x];
-            image->at(block_x + x, block_y + y) = colors[y][x];
-        }
-    }
-    return image;
+            decode_color_block(input + 8, output, stride);
+            decode_dxt5_alpha_block(input, output, stride);
+        });
 }
 
-std::unique_ptr<res::Image> dec::microsoft::dxt::decode_dxt5(
-    io::BaseByteStream &input_stream, size_t width, size_t height)
+std::unique_ptr<res::Image> dxt::decode_dxt1(
+    io::BaseByteStream &input_stream, const size_t width, const size_t height)
 {
-    auto image = create_image(width, height);
-    for (const auto block_y : algo::range(0, height, 4))
-    for (const auto block_x : algo::range(0, width, 4))
-    {
-        u8 alpha[4][4];
-        decode_dxt5_block(input_stream, alpha);
+    return decode_dxt1(
+        input_stream.read(get_input_size(width, height, dxt1_block_size)),
+        width,
+        height);
+}
 
-        res::Pixel colors[4][4];
-        decode_dxt1_block(input_stream, colors);
-        for (const auto y : algo::range(4))
-        for (const auto x : algo::range(4))
-        {
-            colors[y][x].a = alpha[y][x];
-            image->at(block_x + x, block_y + y) = colors[y][x];
-        }
-    }
-    return image;
+std::unique_ptr<res::Image> dxt::decode_dxt3(
+    io::BaseByteStream &input_stream, const size_t width, const size_t height)
+{
+    return decode_dxt3(
+        input_stream.read(get_input_size(width, height, dxt3_block_size)),
+        width,
+        height);
+}
+
+std::unique_ptr<res::Image> dxt::decode_dxt5(
+    io::BaseByteStream &input_stream, const size_t width, const size_t height)
+{
+    return decode_dxt5(
+        input_stream.read(get_input_size(width, height, dxt5_block_size)),
+        width,
+        height);
 }
@@ -25,6 +25,18 @@ namespace dec {
 namespace microsoft {
 namespace dxt {
 
+    // The input holds rows of 4x4 blocks, 8 bytes each for DXT1 and 16 bytes
+    // each for DXT3 and DXT5. The images are padded to multiples of 4.
+
+    std::unique_ptr<res::Image> decode_dxt1(
+        const bstr &input, const size_t width, const size_t height);
+
+    std::unique_ptr<res::Image> decode_dxt3(
+        const bstr &input, const size_t width, const size_t height);
+
+    std::unique_ptr<res::Image> decode_dxt5(
+        const bstr &input, const size_t width, const size_t height);
+
     std::unique_ptr<res::Image> decode_dxt1(
         io::BaseByteStream &input_stream,
         const size_t width,
@@ -28,6 +28,12 @@ bool MaskedBmpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("alp");
 }
 
+std::vector<dec::RecognitionSignature>
+    MaskedBmpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("alp")};
+}
+
 res::Image MaskedBmpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
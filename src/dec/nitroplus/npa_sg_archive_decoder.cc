@@ -40,6 +40,12 @@ bool NpaSgArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return table_size < input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    NpaSgArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("npa")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> NpaSgArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
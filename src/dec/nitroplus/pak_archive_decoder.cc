@@ -81,10 +81,13 @@ std::unique_ptr<io::File> PakArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const CustomArchiveEntry*>(&e);
-    input_file.stream.seek(entry->offset);
-    const auto data = entry->compressed
-        ? algo::pack::zlib_inflate(input_file.stream.read(entry->size_comp))
-        : input_file.stream.read(entry->size_orig);
+    if (!entry->compressed)
+    {
+        return read_plain_file(
+            input_file, entry->path, entry->offset, entry->size_orig);
+    }
+    const auto data = algo::pack::zlib_inflate(
+        input_file.stream.seek(entry->offset).read(entry->size_comp));
     return std::make_unique<io::File>(entry->path, data);
 }
 
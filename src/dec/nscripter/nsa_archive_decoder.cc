@@ -18,6 +18,7 @@
 #include "dec/nscripter/nsa_archive_decoder.h"
 #include "algo/pack/lzss.h"
 #include "algo/range.h"
+#include "algo/str.h"
 #include "dec/nscripter/nsa_encrypted_stream.h"
 #include "dec/nscripter/spb_image_decoder.h"
 #include "enc/png/png_image_encoder.h"
@@ -35,13 +36,18 @@ namespace
         Lzss    = 2,
     };
 
+    struct CustomArchiveMeta final : dec::ArchiveMeta
+    {
+        std::shared_ptr<NsaKeystreamCache> keystream_cache;
+    };
+
     struct CustomArchiveEntry final : dec::CompressedArchiveEntry
     {
         CompressionType compression_type;
     };
 }
 
-NsaArchiveDecoder::NsaArchiveDecoder()
+NsaArchiveDecoder::NsaArchiveDecoder() : thread_count(1)
 {
     add_arg_parser_decorator(
         [](ArgParser &arg_parser)
@@ -49,11 +55,23 @@ NsaArchiveDecoder::NsaArchiveDecoder()
             arg_parser.register_switch({"--nsa-key"})
                 ->set_value_name("KEY")
                 ->set_description("Decryption key");
+
+            arg_parser.register_switch({"--nsa-threads"})
+                ->set_value_name("NUM")
+                ->set_description(
+                    "Decrypts large entries on up to NUM threads each "
+                    "(defaults to 1).");
         },
         [&](const ArgParser &arg_parser)
         {
             if (arg_parser.has_switch("nsa-key"))
                 key = arg_parser.get_switch("nsa-key");
+
+            if (arg_parser.has_switch("nsa-threads"))
+            {
+                thread_count = std::max<int>(1, algo::from_string<int>(
+                    arg_parser.get_switch("nsa-threads")));
+            }
         });
 }
 
@@ -63,13 +81,24 @@ bool NsaArchiveDecoder::is_recognized_impl(io::File &input_file) const
         || input_file.path.has_extension("dat");
 }
 
+std::vector<dec::RecognitionSignature>
+    NsaArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return
+    {
+        dec::RecognitionSignature::extension("nsa"),
+        dec::RecognitionSignature::extension("dat"),
+    };
+}
+
 std::unique_ptr<dec::ArchiveMeta> NsaArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
-    NsaEncryptedStream input_stream(input_file.stream, key);
+    auto meta = std::make_unique<CustomArchiveMeta>();
+    meta->keystream_cache = std::make_shared<NsaKeystreamCache>(key);
+    NsaEncryptedStream input_stream(input_file.stream, meta->keystream_cache);
     input_stream.seek(0);
 
-    auto meta = std::make_unique<ArchiveMeta>();
     const auto file_count = input_stream.read_be<u16>();
     const auto offset_to_data = input_stream.read_be<u32>();
     for (const auto i : algo::range(file_count))
@@ -91,9 +120,13 @@ std::unique_ptr<io::File> NsaArchiveDecoder::read_file_impl(
     const dec::ArchiveMeta &m,
     const dec::ArchiveEntry &e) const
 {
-    NsaEncryptedStream input_stream(input_file.stream, key);
-
+    const auto meta = static_cast<const CustomArchiveMeta*>(&m);
     const auto entry = static_cast<const CustomArchiveEntry*>(&e);
+    NsaEncryptedStream input_stream(
+        input_file.stream,
+        meta->keystream_cache,
+        thread_count);
+
     const auto data = input_stream
         .seek(entry->offset)
         .read(entry->size_comp);
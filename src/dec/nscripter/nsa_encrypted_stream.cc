@@ -18,10 +18,14 @@
 #include "dec/nscripter/nsa_encrypted_stream.h"
 #include <array>
 #include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include "algo/binary.h"
 #include "algo/crypt/hmac.h"
 #include "algo/crypt/md5.h"
 #include "algo/crypt/sha1.h"
+#include "algo/parallel.h"
 #include "algo/range.h"
 #include "err.h"
 
@@ -29,8 +33,29 @@ using namespace au;
 using namespace au::dec::nscripter;
 
 static const auto block_size = 1024;
+static const size_t min_blocks_per_thread = 16;
 
-static void transform_block(const bstr &key, size_t block_num, bstr &block)
+namespace
+{
+    struct CacheItem final
+    {
+        std::shared_ptr<const bstr> keystream;
+        std::list<size_t>::iterator lru_pos;
+    };
+}
+
+struct NsaKeystreamCache::Priv final
+{
+    Priv(const bstr &key, const size_t capacity);
+
+    const bstr key;
+    const size_t capacity;
+    std::mutex mutex;
+    std::list<size_t> lru;
+    std::unordered_map<size_t, CacheItem> items;
+};
+
+static bstr get_keystream(const bstr &key, size_t block_num)
 {
     bstr bn(8);
 
@@ -68,18 +93,102 @@ static void transform_block(const bstr &key, size_t block_num, bstr &block)
         std::swap(box[i0], box[i1]);
     }
 
-    for (const auto i : algo::range(block.size()))
+    // shorter blocks at the end of the stream use a prefix of this
+    bstr keystream(block_size);
+    for (const auto i : algo::range(block_size))
     {
         i0++;
         i1 += box[i0];
         std::swap(box[i0], box[i1]);
-        block[i] ^= box[(box[i0] + box[i1]) & 0xFF];
+        keystream[i] = box[(box[i0] + box[i1]) & 0xFF];
+    }
+    return keystream;
+}
+
+// Decrypts data that starts at the given stream offset.
+static void transform(
+    NsaKeystreamCache &keystream_cache,
+    const uoff_t offset,
+    u8 *data,
+    const size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        const auto block_num = (offset + done) / block_size;
+        const auto block_pos = (offset + done) % block_size;
+        const auto chunk_size = std::min<size_t>(
+            size - done, block_size - block_pos);
+        const auto keystream = keystream_cache.get(block_num);
+        const auto keystream_ptr = keystream->get<const u8>() + block_pos;
+        for (const auto i : algo::range(chunk_size))
+            data[done + i] ^= keystream_ptr[i];
+        done += chunk_size;
     }
 }
 
+NsaKeystreamCache::Priv::Priv(const bstr &key, const size_t capacity)
+    : key(key), capacity(capacity)
+{
+}
+
+NsaKeystreamCache::NsaKeystreamCache(const bstr &key, const size_t capacity)
+    : p(new Priv(key, capacity))
+{
+}
+
+NsaKeystreamCache::~NsaKeystreamCache()
+{
+}
+
+const bstr &NsaKeystreamCache::key() const
+{
+    return p->key;
+}
+
+std::shared_ptr<const bstr> NsaKeystreamCache::get(const size_t block_num)
+{
+    {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        const auto it = p->items.find(block_num);
+        if (it != p->items.end())
+        {
+            p->lru.splice(p->lru.begin(), p->lru, it->second.lru_pos);
+            return it->second.keystream;
+        }
+    }
+
+    // derive outside of the lock so that other threads can go on
+    const auto keystream = std::make_shared<const bstr>(
+        get_keystream(p->key, block_num));
+
+    std::lock_guard<std::mutex> lock(p->mutex);
+    if (p->items.find(block_num) != p->items.end())
+        return keystream;
+    p->lru.push_front(block_num);
+    p->items[block_num] = {keystream, p->lru.begin()};
+    while (p->items.size() > p->capacity)
+    {
+        p->items.erase(p->lru.back());
+        p->lru.pop_back();
+    }
+    return keystream;
+}
+
 NsaEncryptedStream::NsaEncryptedStream(
     io::BaseByteStream &parent_stream, const bstr &key)
-    : parent_stream(parent_stream.clone()), key(key)
+    : NsaEncryptedStream(
+        parent_stream, std::make_shared<NsaKeystreamCache>(key))
+{
+}
+
+NsaEncryptedStream::NsaEncryptedStream(
+    io::BaseByteStream &parent_stream,
+    const std::shared_ptr<NsaKeystreamCache> keystream_cache,
+    const size_t thread_count) :
+        parent_stream(parent_stream.clone()),
+        keystream_cache(keystream_cache),
+        thread_count(thread_count)
 {
 }
 
@@ -94,31 +203,40 @@ void NsaEncryptedStream::seek_impl(const uoff_t offset)
 
 void NsaEncryptedStream::read_impl(void *destination, const size_t size)
 {
-    if (key.empty())
+    const auto offset = parent_stream->pos();
+    const auto chunk = parent_stream->read(size);
+    const auto output = static_cast<u8*>(destination);
+    std::memcpy(output, chunk.get<const u8>(), size);
+    if (keystream_cache->key().empty())
+        return;
+
+    // split on block boundaries so that each keystream is derived once
+    const auto first_block = offset / block_size;
+    const auto last_block = (offset + size + block_size - 1) / block_size;
+    const auto job_count = std::min<size_t>(
+        thread_count, (last_block - first_block) / min_blocks_per_thread);
+    if (job_count <= 1)
     {
-        const auto chunk = parent_stream->read(size);
-        std::memcpy(destination, chunk.get<u8>(), size);
+        transform(*keystream_cache, offset, output, size);
         return;
     }
 
-    const auto orig_pos = parent_stream->pos();
-    const auto padded_pos = orig_pos & ~(block_size - 1);
-    const auto offset_pad = orig_pos % block_size;
-    parent_stream->seek(padded_pos);
-
-    bstr full_buffer;
-    while (full_buffer.size() < size + offset_pad)
+    algo::run_in_parallel(job_count, [&](const size_t i)
     {
-        const auto block_num = parent_stream->pos() / block_size;
-        auto block = parent_stream->read(
-            std::min<uoff_t>(parent_stream->left(), block_size));
-        transform_block(key, block_num, block);
-        full_buffer += block;
-    }
-    if (full_buffer.size() < size)
-        throw err::BadDataSizeError();
-    std::memcpy(destination, full_buffer.get<const u8>() + offset_pad, size);
-    parent_stream->seek(orig_pos + size);
+        const auto job_start = std::max<uoff_t>(
+            offset,
+            (first_block + (last_block - first_block) * i / job_count)
+                * block_size);
+        const auto job_end = std::min<uoff_t>(
+            offset + size,
+            (first_block + (last_block - first_block) * (i + 1) / job_count)
+                * block_size);
+        transform(
+            *keystream_cache,
+            job_start,
+            output + (job_start - offset),
+            job_end - job_start);
+    });
 }
 
 void NsaEncryptedStream::write_impl(const void *source, const size_t size)
@@ -143,7 +261,8 @@ void NsaEncryptedStream::resize_impl(const uoff_t new_size)
 
 std::unique_ptr<io::BaseByteStream> NsaEncryptedStream::clone() const
 {
-    auto ret = std::make_unique<NsaEncryptedStream>(*parent_stream, key);
+    auto ret = std::make_unique<NsaEncryptedStream>(
+        *parent_stream, keystream_cache, thread_count);
     ret->seek(pos());
     return std::move(ret);
 }
@@ -17,16 +17,43 @@
 
 #pragma once
 
+#include <memory>
 #include "io/base_byte_stream.h"
 
 namespace au {
 namespace dec {
 namespace nscripter {
 
+    // Every 1 KiB block is encrypted with its own keystream that takes
+    // a full key schedule to derive. The keystreams depend only on the key
+    // and on the block number, so they're kept around for the blocks that
+    // were used most recently. Safe to share between threads.
+    class NsaKeystreamCache final
+    {
+    public:
+        NsaKeystreamCache(const bstr &key, const size_t capacity = 256);
+        ~NsaKeystreamCache();
+
+        const bstr &key() const;
+        std::shared_ptr<const bstr> get(const size_t block_num);
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
     class NsaEncryptedStream final : public io::BaseByteStream
     {
     public:
         NsaEncryptedStream(io::BaseByteStream &parent_stream, const bstr &key);
+
+        // Reads that span many blocks are decrypted on up to thread_count
+        // threads.
+        NsaEncryptedStream(
+            io::BaseByteStream &parent_stream,
+            const std::shared_ptr<NsaKeystreamCache> keystream_cache,
+            const size_t thread_count = 1);
+
         ~NsaEncryptedStream();
 
         uoff_t size() const override;
@@ -41,7 +68,8 @@ namespace nscripter {
 
     private:
         std::unique_ptr<io::BaseByteStream> parent_stream;
-        const bstr key;
+        const std::shared_ptr<NsaKeystreamCache> keystream_cache;
+        const size_t thread_count;
     };
 
 } } }
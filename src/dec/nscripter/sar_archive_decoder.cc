@@ -26,6 +26,12 @@ bool SarArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("sar");
 }
 
+std::vector<dec::RecognitionSignature>
+    SarArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("sar")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> SarArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -50,8 +56,7 @@ std::unique_ptr<io::File> SarArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 static auto _ = dec::register_decoder<SarArchiveDecoder>("nscripter/sar");
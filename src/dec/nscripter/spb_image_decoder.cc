@@ -95,6 +95,12 @@ bool SpbImageDecoder::is_recognized_impl(io::File &input_file) const
     return true;
 }
 
+std::vector<dec::RecognitionSignature>
+    SpbImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("bmp")};
+}
+
 res::Image SpbImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -239,6 +239,12 @@ bool MgdImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    MgdImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image MgdImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
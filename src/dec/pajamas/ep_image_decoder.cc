@@ -29,6 +29,12 @@ bool EpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    EpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image EpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -39,6 +39,12 @@ bool GamedatArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    GamedatArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> GamedatArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
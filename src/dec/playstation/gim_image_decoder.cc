@@ -167,6 +167,12 @@ bool GimImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    GimImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image GimImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
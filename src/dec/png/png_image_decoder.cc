@@ -119,6 +119,12 @@ bool PngImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PngImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image PngImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
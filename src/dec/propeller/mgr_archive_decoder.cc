@@ -74,6 +74,12 @@ bool MgrArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("mgr");
 }
 
+std::vector<dec::RecognitionSignature>
+    MgrArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("mgr")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> MgrArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
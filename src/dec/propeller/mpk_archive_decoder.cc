@@ -27,6 +27,12 @@ bool MpkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("mpk");
 }
 
+std::vector<dec::RecognitionSignature>
+    MpkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("mpk")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> MpkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -66,8 +72,7 @@ std::unique_ptr<io::File> MpkArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 std::vector<std::string> MpkArchiveDecoder::get_linked_formats() const
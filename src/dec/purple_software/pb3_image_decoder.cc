@@ -417,6 +417,12 @@ bool Pb3ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pb3ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image Pb3ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
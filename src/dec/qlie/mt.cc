@@ -21,7 +21,7 @@
 using namespace au;
 using namespace au::dec::qlie;
 
-static const int n = 64;
+static const int n = CustomMersenneTwister::state_size;
 static const int m = 39;
 static const u32 matrix_a = 0x9908B0DFul;
 static const u32 upper_mask = 0x80000000ul;
@@ -27,6 +27,9 @@ namespace qlie {
     class CustomMersenneTwister final
     {
     public:
+        // number of u32 words in the state, which xor_state() can affect
+        static const size_t state_size = 64;
+
         CustomMersenneTwister(const u32 seed);
         ~CustomMersenneTwister();
 
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/qlie/pack_archive_decoder.h"
+#include <cstring>
 #include "algo/binary.h"
 #include "algo/locale.h"
 #include "algo/ptr.h"
@@ -28,6 +29,10 @@
 #include "io/file_system.h"
 #include "io/memory_byte_stream.h"
 
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace au;
 using namespace au::dec::qlie;
 
@@ -40,6 +45,7 @@ namespace
     {
         bstr key1;
         bstr key2;
+        bstr key_state;
     };
 
     struct CustomArchiveEntry final : dec::CompressedArchiveEntry
@@ -76,20 +82,116 @@ static void decrypt_file_name(bstr &file_name, const u32 key)
         file_name.get<u8>()[i - 1] ^= ((i ^ x) & 0xFF) + i;
 }
 
+static inline u64 load_word(const u8 *input)
+{
+    u64 word;
+    std::memcpy(&word, input, sizeof(word));
+    return word;
+}
+
+static inline void store_word(u8 *output, const u64 word)
+{
+    std::memcpy(output, &word, sizeof(word));
+}
+
+// Both ciphers chain each 64-bit word into the key of the next one, so the
+// kernels below walk the data strictly in order. Trailing bytes that do not
+// fill a whole word are not encrypted and are left untouched.
+
 static void decrypt_file_data_basic(bstr &data, const u32 seed)
 {
-    u64 *current = data.get<u64>();
-    const u64 *end = current + data.size() / 8;
-    u64 key = 0xA73C5F9DA73C5F9D;
+    u8 *current = data.get<u8>();
+    const u8 *end = current + (data.size() & ~static_cast<size_t>(7));
     u64 mutator = (seed + data.size()) ^ 0xFEC9753E;
     mutator = (mutator << 32) | mutator;
 
+#if __SSE2__
+    const auto step = _mm_set1_epi32(static_cast<int>(0xCE24F523));
+    auto key = _mm_set1_epi32(static_cast<int>(0xA73C5F9D));
+    auto mutator_vec = _mm_loadl_epi64(reinterpret_cast<__m128i*>(&mutator));
+    while (current < end)
+    {
+        auto word = reinterpret_cast<__m128i*>(current);
+        key = _mm_xor_si128(_mm_add_epi32(key, step), mutator_vec);
+        mutator_vec = _mm_xor_si128(_mm_loadl_epi64(word), key);
+        _mm_storel_epi64(word, mutator_vec);
+        current += 8;
+    }
+#else
+    u64 key = 0xA73C5F9DA73C5F9D;
     while (current < end)
     {
         key = algo::padd(key, 0xCE24F523CE24F523);
         key ^= mutator;
-        mutator = *current++ ^= key;
+        mutator = load_word(current) ^ key;
+        store_word(current, mutator);
+        current += 8;
     }
+#endif
+}
+
+// Runs the keyed cipher over whole words. The table is passed already rotated
+// by the starting index, which lets every block of 16 words use fixed table
+// slots instead of wrapping the index after each word.
+static void decrypt_words_with_table(
+    u8 *data, const size_t word_count, const u64 (&table)[16], u64 mutator)
+{
+    const auto block_count = word_count / 16;
+    const auto words_left = word_count % 16;
+
+#if __SSE2__
+    __m128i table_vec[16];
+    for (const auto i : algo::range(16))
+    {
+        table_vec[i] = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(&table[i]));
+    }
+    auto mutator_vec = _mm_loadl_epi64(reinterpret_cast<__m128i*>(&mutator));
+
+    const auto decrypt_word = [&](u8 *input, const __m128i key)
+    {
+        const auto word = reinterpret_cast<__m128i*>(input);
+        mutator_vec = _mm_xor_si128(mutator_vec, key);
+        mutator_vec = _mm_add_epi32(mutator_vec, key);
+        const auto plain = _mm_xor_si128(_mm_loadl_epi64(word), mutator_vec);
+        _mm_storel_epi64(word, plain);
+        mutator_vec = _mm_add_epi8(mutator_vec, plain);
+        mutator_vec = _mm_xor_si128(mutator_vec, plain);
+        mutator_vec = _mm_slli_epi32(mutator_vec, 1);
+        mutator_vec = _mm_add_epi16(mutator_vec, plain);
+    };
+
+    for (const auto i : algo::range(block_count))
+    {
+        for (const auto j : algo::range(16))
+            decrypt_word(data + j * 8, table_vec[j]);
+        data += 16 * 8;
+    }
+    for (const auto j : algo::range(words_left))
+        decrypt_word(data + j * 8, table_vec[j]);
+#else
+    const auto decrypt_word = [&](u8 *input, const u64 key)
+    {
+        mutator ^= key;
+        mutator = algo::padd(mutator, key);
+        const auto plain = load_word(input) ^ mutator;
+        store_word(input, plain);
+        mutator = algo::padb(mutator, plain);
+        mutator ^= plain;
+        mutator <<= 1;
+        mutator &= 0xFFFFFFFEFFFFFFFE;
+        mutator = algo::padw(mutator, plain);
+    };
+
+    for (const auto i : algo::range(block_count))
+    {
+        for (const auto j : algo::range(16))
+            decrypt_word(data + j * 8, table[j]);
+        data += 16 * 8;
+    }
+    for (const auto j : algo::range(words_left))
+        decrypt_word(data + j * 8, table[j]);
+#endif
 }
 
 static void decrypt_file_data_with_external_keys(
@@ -117,11 +219,10 @@ static void decrypt_file_data_with_external_keys(
         mt_seed ^= 0x453A;
 
     CustomMersenneTwister mt(mt_seed);
-    mt.xor_state(meta.key1);
-    mt.xor_state(meta.key2);
+    mt.xor_state(meta.key_state);
 
-    std::vector<u64> table(16);
-    for (const auto i : algo::range(table.size()))
+    u64 table[16];
+    for (const auto i : algo::range(16))
     {
         table[i]
             = mt.get_next_integer()
@@ -130,29 +231,17 @@ static void decrypt_file_data_with_external_keys(
     for (const auto i : algo::range(9))
         mt.get_next_integer();
 
-    u64 mutator
+    const u64 mutator
         = mt.get_next_integer()
         | (static_cast<u64>(mt.get_next_integer()) << 32);
 
-    auto table_index = mt.get_next_integer() % table.size();
-    auto data_ptr = algo::make_ptr(data.get<u64>(), data.size() / 8);
-    while (data_ptr.left())
-    {
-        mutator ^= table[table_index];
-        mutator = algo::padd(mutator, table[table_index]);
+    const auto table_index = mt.get_next_integer() % 16;
+    u64 rotated_table[16];
+    for (const auto i : algo::range(16))
+        rotated_table[i] = table[(table_index + i) % 16];
 
-        *data_ptr ^= mutator;
-
-        mutator = algo::padb(mutator, *data_ptr);
-        mutator ^= *data_ptr;
-        mutator <<= 1;
-        mutator &= 0xFFFFFFFEFFFFFFFE;
-        mutator = algo::padw(mutator, *data_ptr);
-
-        table_index++;
-        table_index %= table.size();
-        data_ptr++;
-    }
+    decrypt_words_with_table(
+        data.get<u8>(), data.size() / 8, rotated_table, mutator);
 }
 
 static void decrypt_file_data(
@@ -167,6 +256,21 @@ static void decrypt_file_data(
         decrypt_file_data_with_external_keys(data, seed, file_name, meta);
 }
 
+// Every entry XORs both external keys into its Mersenne Twister state, so
+// combine them once per archive and apply the result with a single pass.
+static void update_key_state(CustomArchiveMeta &meta)
+{
+    const size_t state_size = CustomMersenneTwister::state_size;
+    meta.key_state = bstr(state_size * 4);
+    auto state_ptr = meta.key_state.get<u32>();
+    for (const auto &key : {meta.key1, meta.key2})
+    {
+        const auto key_size = std::min(state_size, key.size() / 4);
+        for (const auto i : algo::range(key_size))
+            state_ptr[i] ^= key.get<const u32>()[i];
+    }
+}
+
 static bstr decompress(const bstr &input, const size_t output_size)
 {
     bstr output(output_size);
@@ -363,6 +467,7 @@ std::unique_ptr<dec::ArchiveMeta> PackArchiveDecoder::read_meta_impl(
             logger.info("fkey not found\n");
         if (meta->key2.empty())
             logger.info(".exe key not found\n");
+        update_key_state(*meta);
     }
 
     input_file.stream.seek(get_magic_start(input_file.stream) + magic.size());
@@ -416,6 +521,7 @@ std::unique_ptr<dec::ArchiveMeta> PackArchiveDecoder::read_meta_impl(
             {
                 auto file = read_file(logger, input_file, *meta, *entry);
                 meta->key1 = file->stream.seek(0).read_to_eof();
+                update_key_state(*meta);
             }
             catch (const std::exception &e)
             {
@@ -178,6 +178,12 @@ bool G00ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("g00");
 }
 
+std::vector<dec::RecognitionSignature>
+    G00ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("g00")};
+}
+
 res::Image G00ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -111,6 +111,12 @@ bool KoepacAudioArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    KoepacAudioArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> KoepacAudioArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
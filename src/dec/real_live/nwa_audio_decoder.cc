@@ -204,6 +204,12 @@ bool NwaAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("nwa");
 }
 
+std::vector<dec::RecognitionSignature>
+    NwaAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("nwa")};
+}
+
 res::Audio NwaAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,12 @@ bool NwkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("nwk");
 }
 
+std::vector<dec::RecognitionSignature>
+    NwkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("nwk")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> NwkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -51,9 +57,11 @@ std::unique_ptr<io::File> NwkArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(
-        io::path(entry->path).change_extension("nwa"), data);
+    return read_plain_file(
+        input_file,
+        io::path(entry->path).change_extension("nwa"),
+        entry->offset,
+        entry->size);
 }
 
 std::vector<std::string> NwkArchiveDecoder::get_linked_formats() const
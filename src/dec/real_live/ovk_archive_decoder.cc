@@ -27,6 +27,12 @@ bool OvkArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("ovk");
 }
 
+std::vector<dec::RecognitionSignature>
+    OvkArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("ovk")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> OvkArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -52,8 +58,7 @@ std::unique_ptr<io::File> OvkArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto output_file = std::make_unique<io::File>(entry->path, data);
+    auto output_file = read_plain_file(input_file, *entry);
     output_file->guess_extension();
     return output_file;
 }
@@ -32,6 +32,12 @@ bool Pdt10ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pdt10ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 static bstr decompress_rgb(
     io::BaseByteStream &input_stream, const size_t width, const size_t height)
 {
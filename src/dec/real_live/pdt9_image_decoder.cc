@@ -30,6 +30,12 @@ bool Pdt9ImageDecoder::is_recognized_impl(io::File &input_file) const
         && input_file.stream.seek(0).read(1) == "9"_b;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pdt9ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("pdt")};
+}
+
 res::Image Pdt9ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -0,0 +1,45 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/recognition_signature.h"
+#include "algo/str.h"
+
+using namespace au;
+using namespace au::dec;
+
+RecognitionSignature RecognitionSignature::magic(
+    const bstr &magic, const size_t offset)
+{
+    RecognitionSignature signature;
+    signature.magic_bytes = magic;
+    signature.magic_offset = offset;
+    return signature;
+}
+
+RecognitionSignature RecognitionSignature::extension(
+    const std::string &extension)
+{
+    RecognitionSignature signature;
+    signature.magic_offset = 0;
+    signature.file_extension = algo::lower(extension);
+    while (!signature.file_extension.empty()
+        && signature.file_extension[0] == '.')
+    {
+        signature.file_extension.erase(0, 1);
+    }
+    return signature;
+}
@@ -0,0 +1,42 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include "types.h"
+
+namespace au {
+namespace dec {
+
+    // Necessary condition for a decoder to recognize a file. The registry
+    // uses these to skip decoders that can't possibly recognize a file
+    // without running their is_recognized(). A decoder that declares several
+    // signatures is considered if any of them matches.
+    struct RecognitionSignature final
+    {
+        static RecognitionSignature magic(
+            const bstr &magic, const size_t offset = 0);
+
+        static RecognitionSignature extension(const std::string &extension);
+
+        bstr magic_bytes;
+        size_t magic_offset;
+        std::string file_extension;
+    };
+
+} }
@@ -17,17 +17,128 @@
 
 #include "dec/registry.h"
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <map>
+#include <mutex>
+#include <stack>
+#include "algo/str.h"
 #include "dec/idecoder.h"
 #include "err.h"
 
+using namespace au;
 using namespace au::dec;
 
+namespace
+{
+    struct RecognitionIndex final
+    {
+        using MagicBucket = std::vector<std::pair<std::string, bstr>>;
+
+        RecognitionIndex(const Registry &registry);
+
+        std::set<std::string> find_matches(io::File &input_file) const;
+
+        size_t header_size;
+        std::set<std::string> unindexed_names;
+        std::map<size_t, std::array<MagicBucket, 256>> magic_buckets;
+        std::map<std::string, std::vector<std::string>> extension_names;
+    };
+}
+
 struct Registry::Priv final
 {
+    const RecognitionIndex &get_recognition_index(const Registry &registry);
+
     std::map<std::string, DecoderCreator> decoder_map;
+    std::unique_ptr<RecognitionIndex> recognition_index;
+    std::mutex recognition_index_mutex;
+
+    std::map<std::string, std::shared_ptr<const IDecoder>> prototypes;
+    std::map<std::string, std::set<std::string>> linked_format_closures;
+    std::mutex cache_mutex;
 };
 
+RecognitionIndex::RecognitionIndex(const Registry &registry) : header_size(0)
+{
+    for (const auto &name : registry.get_decoder_names())
+    {
+        const auto signatures = registry.get_decoder_prototype(name)
+            ->get_recognition_signatures();
+        if (signatures.empty())
+            unindexed_names.insert(name);
+
+        for (const auto &signature : signatures)
+        {
+            if (!signature.file_extension.empty())
+            {
+                extension_names[signature.file_extension].push_back(name);
+            }
+            else if (signature.magic_bytes.empty())
+            {
+                unindexed_names.insert(name);
+            }
+            else
+            {
+                const auto offset = signature.magic_offset;
+                const auto &magic = signature.magic_bytes;
+                magic_buckets[offset][magic[0]].push_back({name, magic});
+                header_size = std::max(header_size, offset + magic.size());
+            }
+        }
+    }
+}
+
+std::set<std::string> RecognitionIndex::find_matches(
+    io::File &input_file) const
+{
+    std::set<std::string> matches;
+
+    const auto old_pos = input_file.stream.pos();
+    const auto header = input_file.stream.seek(0).read(
+        std::min<uoff_t>(header_size, input_file.stream.size()));
+    input_file.stream.seek(old_pos);
+
+    for (const auto &kv : magic_buckets)
+    {
+        const auto offset = kv.first;
+        if (offset >= header.size())
+            break;
+        for (const auto &item : kv.second[header[offset]])
+        {
+            const auto &magic = item.second;
+            if (offset + magic.size() > header.size())
+                continue;
+            if (!std::memcmp(
+                    header.get<const u8>() + offset,
+                    magic.get<const u8>(),
+                    magic.size()))
+            {
+                matches.insert(item.first);
+            }
+        }
+    }
+
+    auto extension = algo::lower(input_file.path.extension());
+    if (!extension.empty())
+    {
+        const auto it = extension_names.find(extension.substr(1));
+        if (it != extension_names.end())
+            matches.insert(it->second.begin(), it->second.end());
+    }
+
+    return matches;
+}
+
+const RecognitionIndex &Registry::Priv::get_recognition_index(
+    const Registry &registry)
+{
+    std::unique_lock<std::mutex> lock(recognition_index_mutex);
+    if (!recognition_index)
+        recognition_index = std::make_unique<RecognitionIndex>(registry);
+    return *recognition_index;
+}
+
 Registry::Registry() : p(new Priv)
 {
 }
@@ -53,9 +164,70 @@ bool Registry::has_decoder(const std::string &name) const
 std::shared_ptr<IDecoder>
     Registry::create_decoder(const std::string &name) const
 {
-    if (!has_decoder(name))
+    const auto it = p->decoder_map.find(name);
+    if (it == p->decoder_map.end())
         throw err::UsageError("Unknown decoder: " + name);
-    return p->decoder_map[name]();
+    return it->second();
+}
+
+std::shared_ptr<const IDecoder> Registry::get_decoder_prototype(
+    const std::string &name) const
+{
+    std::unique_lock<std::mutex> lock(p->cache_mutex);
+    const auto it = p->prototypes.find(name);
+    if (it != p->prototypes.end())
+        return it->second;
+    const auto prototype = create_decoder(name);
+    p->prototypes[name] = prototype;
+    return prototype;
+}
+
+std::set<std::string> Registry::get_linked_format_closure(
+    const std::string &name) const
+{
+    {
+        std::unique_lock<std::mutex> lock(p->cache_mutex);
+        const auto it = p->linked_format_closures.find(name);
+        if (it != p->linked_format_closures.end())
+            return it->second;
+    }
+
+    std::set<std::string> known_formats;
+    std::stack<std::shared_ptr<const IDecoder>> decoders_to_inspect;
+    decoders_to_inspect.push(get_decoder_prototype(name));
+    while (!decoders_to_inspect.empty())
+    {
+        const auto decoder_to_inspect = decoders_to_inspect.top();
+        decoders_to_inspect.pop();
+        for (const auto &format : decoder_to_inspect->get_linked_formats())
+        {
+            if (known_formats.find(format) != known_formats.end())
+                continue;
+            known_formats.insert(format);
+            decoders_to_inspect.push(get_decoder_prototype(format));
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(p->cache_mutex);
+    p->linked_format_closures[name] = known_formats;
+    return known_formats;
+}
+
+std::set<std::string> Registry::get_recognition_candidates(
+    io::File &input_file, const std::set<std::string> &decoder_names) const
+{
+    const auto &index = p->get_recognition_index(*this);
+    const auto matches = index.find_matches(input_file);
+    std::set<std::string> candidates;
+    for (const auto &name : decoder_names)
+    {
+        if (index.unindexed_names.find(name) != index.unindexed_names.end()
+            || matches.find(name) != matches.end())
+        {
+            candidates.insert(name);
+        }
+    }
+    return candidates;
 }
 
 void Registry::add_decoder(const std::string &name, DecoderCreator creator)
@@ -66,6 +238,12 @@ void Registry::add_decoder(const std::string &name, DecoderCreator creator)
             "Decoder with name " + name + " was already registered.");
     }
     p->decoder_map[name] = creator;
+    {
+        std::unique_lock<std::mutex> lock(p->recognition_index_mutex);
+        p->recognition_index.reset();
+    }
+    std::unique_lock<std::mutex> lock(p->cache_mutex);
+    p->linked_format_closures.clear();
 }
 
 Registry &Registry::instance()
@@ -19,7 +19,9 @@
 
 #include <functional>
 #include <memory>
+#include <set>
 #include <vector>
+#include "io/file.h"
 
 namespace au {
 namespace dec {
@@ -42,6 +44,23 @@ namespace dec {
         void add_decoder(const std::string &name, DecoderCreator creator);
         std::shared_ptr<IDecoder> create_decoder(const std::string &name) const;
 
+        // Shared instance created once per name. Safe to use from many
+        // threads for queries that don't depend on decoder options, such as
+        // recognition or linked formats; use create_decoder() to decode.
+        std::shared_ptr<const IDecoder> get_decoder_prototype(
+            const std::string &name) const;
+
+        // Formats reachable through get_linked_formats() from the given
+        // decoder, cached per name.
+        std::set<std::string> get_linked_format_closure(
+            const std::string &name) const;
+
+        // Narrows down decoder_names to the decoders whose recognition
+        // signatures match the file, plus those that don't declare any.
+        std::set<std::string> get_recognition_candidates(
+            io::File &input_file,
+            const std::set<std::string> &decoder_names) const;
+
     private:
         Registry();
 
@@ -29,6 +29,12 @@ bool CmpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    CmpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image CmpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -28,6 +28,12 @@ bool PmpImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("pmp");
 }
 
+std::vector<dec::RecognitionSignature>
+    PmpImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("pmp")};
+}
+
 res::Image PmpImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -27,6 +27,12 @@ bool PmwAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("pmw");
 }
 
+std::vector<dec::RecognitionSignature>
+    PmwAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("pmw")};
+}
+
 std::unique_ptr<io::File> PmwAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
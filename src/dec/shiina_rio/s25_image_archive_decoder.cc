@@ -207,6 +207,12 @@ bool S25ImageArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    S25ImageArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> S25ImageArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/shiina_rio/warc/decompress.h"
+#include "algo/pack/huffman.h"
 #include "algo/pack/zlib.h"
 #include "algo/range.h"
 #include "err.h"
@@ -26,86 +27,39 @@ using namespace au;
 using namespace au::dec::shiina_rio;
 using namespace au::dec::shiina_rio::warc;
 
-namespace
+// YH1 bits are read most significant bit first out of little-endian 32-bit
+// words. Swap the bytes of every word so that an ordinary MSB bit stream
+// sees the same sequence. The original reader shifts a trailing partial word
+// into what is left of the previous one, which is replicated as well.
+static bstr reorder_words(const bstr &input)
 {
-    class CustomBitStream final : public io::BaseBitStream
+    bstr output(input.size());
+    const auto word_count = input.size() / 4;
+    for (const auto i : algo::range(word_count))
+    for (const auto j : algo::range(4))
+        output[i * 4 + j] = input[i * 4 + 3 - j];
+    const auto tail_size = input.size() % 4;
+    if (tail_size)
     {
-    public:
-        CustomBitStream(const bstr &input);
-        u32 read(const size_t bits) override;
-    private:
-        void fetch();
-    };
-}
-
-CustomBitStream::CustomBitStream(const bstr &input) : io::BaseBitStream(input)
-{
-}
-
-void CustomBitStream::fetch()
-{
-    if (input_stream->left() >= 4)
-    {
-        buffer = input_stream->read_le<u32>();
-        return;
-    }
-    while (input_stream->left())
-    {
-        buffer <<= 8;
-        buffer |= input_stream->read<u8>();
-    }
-}
-
-u32 CustomBitStream::read(size_t requested_bits)
-{
-    u32 value = 0;
-    if (bits_available < requested_bits)
-    {
-        do
+        bstr tail(4 - tail_size);
+        if (word_count)
         {
-            requested_bits -= bits_available;
-            const u32 mask = (1ull << bits_available) - 1;
-            value |= (buffer & mask) << requested_bits;
-            fetch();
-            bits_available = 32;
+            tail = output.substr(
+                (word_count - 1) * 4 + tail_size, 4 - tail_size);
         }
-        while (requested_bits > 32);
+        tail += input.substr(word_count * 4);
+        output = output.substr(0, word_count * 4) + tail;
     }
-    bits_available -= requested_bits;
-    const u32 mask = (1ull << requested_bits) - 1;
-    return value | ((buffer >> bits_available) & mask);
-}
-
-static int init_huffman(
-    io::BaseBitStream &bit_stream, u16 nodes[2][512], int &size)
-{
-    if (!bit_stream.read(1))
-        return bit_stream.read(8);
-    const auto pos = size;
-    if (pos > 511)
-        return -1;
-    size++;
-    nodes[0][pos] = init_huffman(bit_stream, nodes, size);
-    nodes[1][pos] = init_huffman(bit_stream, nodes, size);
-    return pos;
+    return output;
 }
 
 static bstr decode_huffman(const bstr &input, const size_t size_orig)
 {
     bstr output(size_orig);
-    auto output_ptr = output.get<u8>();
-    const auto output_end = output.end<const u8>();
-    CustomBitStream bit_stream(input);
-    u16 nodes[2][512];
-    auto size = 256;
-    const auto root = init_huffman(bit_stream, nodes, size);
-    while (output_ptr < output_end)
-    {
-        auto byte = root;
-        while (byte >= 256 && byte <= 511)
-            byte = nodes[bit_stream.read(1)][byte];
-        *output_ptr++ = byte;
-    }
+    io::MsbBitStream bit_stream(reorder_words(input));
+    const algo::pack::HuffmanTree huffman_tree(bit_stream);
+    const algo::pack::HuffmanDecoder huffman_decoder(huffman_tree);
+    huffman_decoder.decode(bit_stream, output.get<u8>(), output.size());
     return output;
 }
 
@@ -59,6 +59,12 @@ bool WarcArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WarcArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> WarcArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
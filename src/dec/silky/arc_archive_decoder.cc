@@ -38,6 +38,12 @@ bool ArcArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return last_entry.offset + last_entry.size_comp == input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    ArcArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("arc")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> ArcArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -69,9 +75,14 @@ std::unique_ptr<io::File> ArcArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const CompressedArchiveEntry*>(&e);
-    auto data = input_file.stream.seek(entry->offset).read(entry->size_comp);
-    if (entry->size_comp != entry->size_orig)
-        data = algo::pack::lzss_decompress(data, entry->size_orig);
+    if (entry->size_comp == entry->size_orig)
+    {
+        return read_plain_file(
+            input_file, entry->path, entry->offset, entry->size_comp);
+    }
+    const auto data = algo::pack::lzss_decompress(
+        input_file.stream.seek(entry->offset).read(entry->size_comp),
+        entry->size_orig);
     return std::make_unique<io::File>(entry->path, data);
 }
 
@@ -28,6 +28,12 @@ bool PgaImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PgaImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image PgaImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
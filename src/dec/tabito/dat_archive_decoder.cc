@@ -38,6 +38,12 @@ bool DatArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return false;
 }
 
+std::vector<dec::RecognitionSignature>
+    DatArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> DatArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -66,8 +72,7 @@ std::unique_ptr<io::File> DatArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    auto ret = std::make_unique<io::File>(entry->path, data);
+    auto ret = read_plain_file(input_file, *entry);
     ret->guess_extension();
     return ret;
 }
@@ -201,6 +201,12 @@ bool AnmArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("anm");
 }
 
+std::vector<dec::RecognitionSignature>
+    AnmArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("anm")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AnmArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
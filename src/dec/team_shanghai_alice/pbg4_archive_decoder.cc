@@ -40,6 +40,12 @@ bool Pbg4ArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pbg4ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pbg4ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
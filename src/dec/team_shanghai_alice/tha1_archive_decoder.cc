@@ -131,6 +131,12 @@ bool Tha1ArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return header_stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    Tha1ArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Tha1ArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -30,6 +30,12 @@ bool YbImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    YbImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image YbImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
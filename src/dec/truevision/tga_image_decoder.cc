@@ -132,6 +132,12 @@ bool TgaImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("tga");
 }
 
+std::vector<dec::RecognitionSignature>
+    TgaImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("tga")};
+}
+
 res::Image TgaImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
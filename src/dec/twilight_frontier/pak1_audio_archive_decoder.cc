@@ -52,6 +52,12 @@ bool Pak1AudioArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.left() == 0;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pak1AudioArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pak1AudioArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
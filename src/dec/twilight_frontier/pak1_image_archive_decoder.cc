@@ -55,6 +55,12 @@ bool Pak1ImageArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.left() == 0;
 }
 
+std::vector<dec::RecognitionSignature>
+    Pak1ImageArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> Pak1ImageArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -25,6 +25,12 @@ bool Pak2AudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("cv3");
 }
 
+std::vector<dec::RecognitionSignature>
+    Pak2AudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("cv3")};
+}
+
 res::Audio Pak2AudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
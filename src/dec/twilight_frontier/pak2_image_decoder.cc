@@ -31,6 +31,12 @@ bool Pak2ImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("cv2");
 }
 
+std::vector<dec::RecognitionSignature>
+    Pak2ImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("cv2")};
+}
+
 res::Image Pak2ImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
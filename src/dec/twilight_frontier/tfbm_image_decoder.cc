@@ -34,6 +34,12 @@ bool TfbmImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    TfbmImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image TfbmImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -40,6 +40,12 @@ bool TfcsFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    TfcsFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> TfcsFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
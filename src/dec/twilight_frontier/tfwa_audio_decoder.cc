@@ -27,6 +27,12 @@ bool TfwaAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    TfwaAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Audio TfwaAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -55,6 +55,12 @@ bool AssetsArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("assets");
 }
 
+std::vector<dec::RecognitionSignature>
+    AssetsArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("assets")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> AssetsArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -94,8 +100,7 @@ std::unique_ptr<io::File> AssetsArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 static auto _ = dec::register_decoder<AssetsArchiveDecoder>("unity/assets");
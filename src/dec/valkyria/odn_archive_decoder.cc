@@ -62,6 +62,12 @@ bool OdnArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.path.has_extension("odn");
 }
 
+std::vector<dec::RecognitionSignature>
+    OdnArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("odn")};
+}
+
 static OdnVariant guess_odn_variant(io::BaseByteStream &input_stream)
 {
     if (input_stream.seek(8).read(8) == "00000000"_b)
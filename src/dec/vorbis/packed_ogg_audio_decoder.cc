@@ -83,6 +83,12 @@ bool PackedOggAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(4) == ogg_magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    PackedOggAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("wav")};
+}
+
 static void rewrite_ogg_stream(
     const Logger &logger,
     io::BaseByteStream &input_stream,
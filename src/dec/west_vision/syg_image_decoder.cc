@@ -27,6 +27,12 @@ bool SygImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    SygImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image SygImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
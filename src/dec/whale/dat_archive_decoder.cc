@@ -251,6 +251,12 @@ bool DatArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return file_count * (8 + 1 + 4 + 4 + 4) < input_file.stream.size();
 }
 
+std::vector<dec::RecognitionSignature>
+    DatArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::extension("dat")};
+}
+
 std::unique_ptr<dec::ArchiveMeta> DatArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
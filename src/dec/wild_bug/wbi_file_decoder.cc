@@ -29,6 +29,12 @@ bool WbiFileDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WbiFileDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<io::File> WbiFileDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -86,6 +86,12 @@ bool WbmImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WbmImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image WbmImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
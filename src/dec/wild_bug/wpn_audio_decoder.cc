@@ -40,6 +40,12 @@ bool WpnAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WpnAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Audio WpnAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -29,6 +29,12 @@ bool WwaAudioDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    WwaAudioDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Audio WwaAudioDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -106,6 +106,12 @@ bool YkgImageDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    YkgImageDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 res::Image YkgImageDecoder::decode_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -59,11 +59,10 @@ std::unique_ptr<io::File> DatArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const CompressedArchiveEntry*>(&e);
-    input_file.stream.seek(entry->offset);
     if (entry->size_orig != entry->size_comp)
         throw err::NotSupportedError("Compressed archives are not supported");
-    const auto data = input_file.stream.read(entry->size_comp);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(
+        input_file, entry->path, entry->offset, entry->size_comp);
 }
 
 std::vector<std::string> DatArchiveDecoder::get_linked_formats() const
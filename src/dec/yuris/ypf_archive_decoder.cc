@@ -145,6 +145,12 @@ bool YpfArchiveDecoder::is_recognized_impl(io::File &input_file) const
     return input_file.stream.seek(0).read(magic.size()) == magic;
 }
 
+std::vector<dec::RecognitionSignature>
+    YpfArchiveDecoder::get_recognition_signatures_impl() const
+{
+    return {dec::RecognitionSignature::magic(magic)};
+}
+
 std::unique_ptr<dec::ArchiveMeta> YpfArchiveDecoder::read_meta_impl(
     const Logger &logger, io::File &input_file) const
 {
@@ -196,9 +202,13 @@ std::unique_ptr<io::File> YpfArchiveDecoder::read_file_impl(
     const dec::ArchiveEntry &e) const
 {
     const auto entry = static_cast<const CustomArchiveEntry*>(&e);
-    auto data = input_file.stream.seek(entry->offset).read(entry->size_comp);
-    if (entry->compressed)
-        data = algo::pack::zlib_inflate(data);
+    if (!entry->compressed)
+    {
+        return read_plain_file(
+            input_file, entry->path, entry->offset, entry->size_comp);
+    }
+    const auto data = algo::pack::zlib_inflate(
+        input_file.stream.seek(entry->offset).read(entry->size_comp));
     return std::make_unique<io::File>(entry->path, data);
 }
 
@@ -27,6 +27,8 @@ namespace yuris {
     {
     protected:
         bool is_recognized_impl(io::File &input_file) const override;
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
         std::vector<std::string> get_linked_formats() const override;
 
         std::unique_ptr<ArchiveMeta> read_meta_impl(
@@ -15,74 +15,264 @@
 // You should have received a copy of the GNU General Public License
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
+
 #include "enc/microsoft/wav_audio_encoder.h"
+#include <cstring>
 #include "algo/range.h"
+#include "io/memory_byte_stream.h"
 
 using namespace au;
 using namespace au::enc::microsoft;
 
-void WavAudioEncoder::encode_impl(
-    const Logger &logger,
-    const res::Audio &input_audio,
-    io::File &output_file) const
+namespace
 {
-    const auto block_align
-        = input_audio.channel_count * input_audio.bits_per_sample / 8;
-    const auto byte_rate = input_audio.sample_rate * block_align;
-
-    output_file.stream.write("RIFF"_b);
-    output_file.stream.write("\x00\x00\x00\x00"_b);
-    output_file.stream.write("WAVE"_b);
-
-    output_file.stream.write("fmt "_b);
-    output_file.stream.write_le<u32>(
-        18 + input_audio.extra_codec_headers.size());
-    output_file.stream.write_le<u16>(input_audio.codec);
-    output_file.stream.write_le<u16>(input_audio.channel_count);
-    output_file.stream.write_le<u32>(input_audio.sample_rate);
-    output_file.stream.write_le<u32>(byte_rate);
-    output_file.stream.write_le<u16>(block_align);
-    output_file.stream.write_le<u16>(input_audio.bits_per_sample);
-    output_file.stream.write_le<u16>(input_audio.extra_codec_headers.size());
-    output_file.stream.write(input_audio.extra_codec_headers);
-
-    output_file.stream.write("data"_b);
-    output_file.stream.write_le<u32>(input_audio.samples.size());
-    output_file.stream.write(input_audio.samples);
+    // Serves a .wav file whose samples are decoded only when the reads get
+    // to them, keeping a single block in memory. Sequential reads decode
+    // each block once; seeking backwards into the samples starts decoding
+    // over from the beginning of the track.
+    class StreamedWavByteStream final : public io::BaseByteStream
+    {
+    public:
+        StreamedWavByteStream(
+            const bstr &header,
+            const bstr &trailer,
+            const uoff_t samples_size,
+            const res::StreamedAudio::SampleReaderFactory &open_samples);
+
+        uoff_t size() const override;
+        uoff_t pos() const override;
+        std::unique_ptr<BaseByteStream> clone() const override;
+        const u8 *contiguous_data() const override;
+
+    protected:
+        void read_impl(void *destination, const size_t size) override;
+        void write_impl(const void *source, const size_t size) override;
+        void seek_impl(const uoff_t offset) override;
+        void resize_impl(const uoff_t new_size) override;
+
+    private:
+        void decode_until(const uoff_t samples_offset);
+
+        const bstr header;
+        const bstr trailer;
+        const uoff_t samples_size;
+        const res::StreamedAudio::SampleReaderFactory open_samples;
+        std::unique_ptr<res::BaseAudioSampleReader> sample_reader;
+        bstr block;
+        uoff_t block_offset;
+        uoff_t stream_pos;
+    };
+}
+
+StreamedWavByteStream::StreamedWavByteStream(
+    const bstr &header,
+    const bstr &trailer,
+    const uoff_t samples_size,
+    const res::StreamedAudio::SampleReaderFactory &open_samples) :
+        header(header),
+        trailer(trailer),
+        samples_size(samples_size),
+        open_samples(open_samples),
+        block_offset(0),
+        stream_pos(0)
+{
+}
+
+void StreamedWavByteStream::decode_until(const uoff_t samples_offset)
+{
+    if (!sample_reader || samples_offset < block_offset)
+    {
+        sample_reader = open_samples();
+        block.resize(0);
+        block_offset = 0;
+    }
+    while (samples_offset >= block_offset + block.size())
+    {
+        block_offset += block.size();
+        if (!sample_reader->read_block(block))
+            throw err::BadDataSizeError();
+    }
+}
 
-    if (!input_audio.loops.empty())
+void StreamedWavByteStream::read_impl(void *destination, const size_t size)
+{
+    if (stream_pos + size > this->size())
+        throw err::EofError();
+    auto output_ptr = reinterpret_cast<u8*>(destination);
+    auto size_left = size;
+    while (size_left)
+    {
+        const u8 *source;
+        uoff_t available;
+        if (stream_pos < header.size())
+        {
+            source = header.get<u8>() + stream_pos;
+            available = header.size() - stream_pos;
+        }
+        else if (stream_pos < header.size() + samples_size)
+        {
+            const auto samples_offset = stream_pos - header.size();
+            decode_until(samples_offset);
+            const auto block_pos = samples_offset - block_offset;
+            source = block.get<u8>() + block_pos;
+            available = std::min<uoff_t>(
+                block.size() - block_pos, samples_size - samples_offset);
+        }
+        else
+        {
+            const auto trailer_pos = stream_pos - header.size() - samples_size;
+            source = trailer.get<u8>() + trailer_pos;
+            available = trailer.size() - trailer_pos;
+        }
+        const auto chunk_size = std::min<uoff_t>(available, size_left);
+        std::memcpy(output_ptr, source, chunk_size);
+        output_ptr += chunk_size;
+        size_left -= chunk_size;
+        stream_pos += chunk_size;
+    }
+}
+
+void StreamedWavByteStream::write_impl(const void *source, const size_t size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
+void StreamedWavByteStream::seek_impl(const uoff_t offset)
+{
+    if (offset > size())
+        throw err::EofError();
+    stream_pos = offset;
+}
+
+void StreamedWavByteStream::resize_impl(const uoff_t new_size)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
+uoff_t StreamedWavByteStream::size() const
+{
+    return header.size() + samples_size + trailer.size();
+}
+
+uoff_t StreamedWavByteStream::pos() const
+{
+    return stream_pos;
+}
+
+std::unique_ptr<io::BaseByteStream> StreamedWavByteStream::clone() const
+{
+    std::unique_ptr<io::BaseByteStream> ret
+        = std::make_unique<StreamedWavByteStream>(
+            header, trailer, samples_size, open_samples);
+    ret->seek(pos());
+    return ret;
+}
+
+const u8 *StreamedWavByteStream::contiguous_data() const
+{
+    return nullptr;
+}
+
+static bstr get_trailer(const res::Audio &audio)
+{
+    io::MemoryByteStream output_stream;
+    if (!audio.loops.empty())
     {
         const auto extra_data = ""_b;
-        output_file.stream.write("smpl"_b);
-        output_file.stream.write_le<u32>(36
-            + (24 * input_audio.loops.size()) + extra_data.size());
-        output_file.stream.write_le<u32>(0); // manufacturer
-        output_file.stream.write_le<u32>(0); // product
-        output_file.stream.write_le<u32>(0); // sample period
-        output_file.stream.write_le<u32>(0); // midi unity note
-        output_file.stream.write_le<u32>(0); // midi pitch fraction
-        output_file.stream.write_le<u32>(0); // smpte format
-        output_file.stream.write_le<u32>(0); // smpte offset
-        output_file.stream.write_le<u32>(input_audio.loops.size());
-        output_file.stream.write_le<u32>(extra_data.size());
-        for (const auto i : algo::range(input_audio.loops.size()))
+        output_stream.write("smpl"_b);
+        output_stream.write_le<u32>(36
+            + (24 * audio.loops.size()) + extra_data.size());
+        output_stream.write_le<u32>(0); // manufacturer
+        output_stream.write_le<u32>(0); // product
+        output_stream.write_le<u32>(0); // sample period
+        output_stream.write_le<u32>(0); // midi unity note
+        output_stream.write_le<u32>(0); // midi pitch fraction
+        output_stream.write_le<u32>(0); // smpte format
+        output_stream.write_le<u32>(0); // smpte offset
+        output_stream.write_le<u32>(audio.loops.size());
+        output_stream.write_le<u32>(extra_data.size());
+        for (const auto i : algo::range(audio.loops.size()))
         {
-            const auto loop = input_audio.loops[i];
-            output_file.stream.write_le<u32>(i);
-            output_file.stream.write_le<u32>(0); // type
-            output_file.stream.write_le<u32>(loop.start);
-            output_file.stream.write_le<u32>(loop.end);
-            output_file.stream.write_le<u32>(0); // fraction
-            output_file.stream.write_le<u32>(loop.play_count);
+            const auto loop = audio.loops[i];
+            output_stream.write_le<u32>(i);
+            output_stream.write_le<u32>(0); // type
+            output_stream.write_le<u32>(loop.start);
+            output_stream.write_le<u32>(loop.end);
+            output_stream.write_le<u32>(0); // fraction
+            output_stream.write_le<u32>(loop.play_count);
         }
-        output_file.stream.write(extra_data);
+        output_stream.write(extra_data);
     }
+    return output_stream.seek(0).read_to_eof();
+}
 
-    output_file.stream.seek(4);
-    output_file.stream.write_le<u32>(output_file.stream.size() - 8);
+// Everything up to and including the size of the data chunk.
+static bstr get_header(
+    const res::Audio &audio,
+    const uoff_t samples_size,
+    const uoff_t trailer_size)
+{
+    const auto block_align = audio.channel_count * audio.bits_per_sample / 8;
+    const auto byte_rate = audio.sample_rate * block_align;
 
-    if (!input_audio.loops.empty())
-        output_file.path.change_extension("wavloop");
-    else
-        output_file.path.change_extension("wav");
+    io::MemoryByteStream output_stream;
+    output_stream.write("RIFF"_b);
+    output_stream.write("\x00\x00\x00\x00"_b);
+    output_stream.write("WAVE"_b);
+
+    output_stream.write("fmt "_b);
+    output_stream.write_le<u32>(18 + audio.extra_codec_headers.size());
+    output_stream.write_le<u16>(audio.codec);
+    output_stream.write_le<u16>(audio.channel_count);
+    output_stream.write_le<u32>(audio.sample_rate);
+    output_stream.write_le<u32>(byte_rate);
+    output_stream.write_le<u16>(block_align);
+    output_stream.write_le<u16>(audio.bits_per_sample);
+    output_stream.write_le<u16>(audio.extra_codec_headers.size());
+    output_stream.write(audio.extra_codec_headers);
+
+    output_stream.write("data"_b);
+    output_stream.write_le<u32>(samples_size);
+
+    output_stream.seek(4);
+    output_stream.write_le<u32>(
+        output_stream.size() + samples_size + trailer_size - 8);
+    return output_stream.seek(0).read_to_eof();
+}
+
+static io::path get_output_path(const res::Audio &audio, const io::path &name)
+{
+    auto path = name;
+    path.change_extension(audio.loops.empty() ? "wav" : "wavloop");
+    return path;
+}
+
+std::unique_ptr<io::File> WavAudioEncoder::encode_streamed(
+    const Logger &logger,
+    const res::StreamedAudio &input_audio,
+    const io::path &name) const
+{
+    const auto trailer = get_trailer(input_audio.audio);
+    const auto header = get_header(
+        input_audio.audio, input_audio.samples_size, trailer.size());
+    return std::make_unique<io::File>(
+        get_output_path(input_audio.audio, name),
+        std::make_unique<StreamedWavByteStream>(
+            header,
+            trailer,
+            input_audio.samples_size,
+            input_audio.open_samples));
+}
+
+void WavAudioEncoder::encode_impl(
+    const Logger &logger,
+    const res::Audio &input_audio,
+    io::File &output_file) const
+{
+    const auto trailer = get_trailer(input_audio);
+    output_file.stream.write(get_header(
+        input_audio, input_audio.samples.size(), trailer.size()));
+    output_file.stream.write(input_audio.samples);
+    output_file.stream.write(trailer);
+    output_file.path = get_output_path(input_audio, output_file.path);
 }
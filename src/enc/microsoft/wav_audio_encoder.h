@@ -18,6 +18,7 @@
 #pragma once
 
 #include "enc/base_audio_encoder.h"
+#include "res/streamed_audio.h"
 
 namespace au {
 namespace enc {
@@ -25,6 +26,14 @@ namespace microsoft {
 
     class WavAudioEncoder final : public BaseAudioEncoder
     {
+    public:
+        // Returns a file that decodes the samples as it is read, so that
+        // saving it never holds more than one block of them in memory.
+        std::unique_ptr<io::File> encode_streamed(
+            const Logger &logger,
+            const res::StreamedAudio &input_audio,
+            const io::path &name) const;
+
     protected:
         void encode_impl(
             const Logger &logger,
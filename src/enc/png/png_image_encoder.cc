@@ -17,6 +17,11 @@
 
 #include "enc/png/png_image_encoder.h"
 #include <png.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "algo/parallel.h"
 #include "algo/range.h"
 #include "err.h"
 #include "io/memory_byte_stream.h"
@@ -24,22 +29,63 @@
 using namespace au;
 using namespace au::enc::png;
 
+static const int stride_bpp = 4;
+static const size_t window_size = 32 * 1024;
+static const size_t min_band_rows = 16;
+
+const size_t PngImageEncoder::parallel_min_pixels = 1024 * 1024;
+
+namespace
+{
+    struct PresetSettings final
+    {
+        int compression_level;
+        bool adaptive_filtering;
+    };
+
+    struct OutputBuffer final
+    {
+        bstr data;
+        size_t size;
+    };
+}
+
+static PresetSettings get_preset_settings(const PngCompressionPreset preset)
+{
+    switch (preset)
+    {
+        case PngCompressionPreset::Store:
+            return {0, false};
+        case PngCompressionPreset::Fast:
+            return {1, false};
+        case PngCompressionPreset::Balanced:
+            return {6, true};
+        case PngCompressionPreset::Small:
+            return {9, true};
+    }
+    throw std::logic_error("Bad compression preset");
+}
+
 static void write_handler(
     png_structp png_ptr, png_bytep input, png_size_t size)
 {
-    auto output_stream
-        = reinterpret_cast<io::BaseByteStream*>(png_get_io_ptr(png_ptr));
-    output_stream->write(bstr(input, size));
+    // libpng calls this for every few bytes of headers and for every IDAT
+    // chunk; append to a growing buffer rather than allocating each time
+    auto buffer = reinterpret_cast<OutputBuffer*>(png_get_io_ptr(png_ptr));
+    if (buffer->size + size > buffer->data.size())
+        buffer->data.resize(std::max(buffer->size + size, buffer->size * 2));
+    std::memcpy(buffer->data.get<u8>() + buffer->size, input, size);
+    buffer->size += size;
 }
 
 static void flush_handler(png_structp)
 {
 }
 
-void PngImageEncoder::encode_impl(
-    const Logger &logger,
+static void encode_with_libpng(
     const res::Image &input_image,
-    io::File &output_file) const
+    const PresetSettings &settings,
+    io::BaseByteStream &output_stream)
 {
     png_structp png_ptr = png_create_write_struct(
         PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
@@ -52,9 +98,6 @@ void PngImageEncoder::encode_impl(
 
     const auto width = input_image.width();
     const auto height = input_image.height();
-    if (!width || !height)
-        throw err::BadDataSizeError();
-    const auto bpp = 4;
     const auto color_type = PNG_COLOR_TYPE_RGBA;
     int transformations = PNG_TRANSFORM_BGR;
 
@@ -64,13 +107,16 @@ void PngImageEncoder::encode_impl(
         PNG_COMPRESSION_TYPE_BASE,
         PNG_FILTER_TYPE_BASE);
 
-    // 0 = no compression, 9 = max compression
-    // 1 produces good file size and is still fast.
-    png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
-    png_set_compression_level(png_ptr, 1);
+    png_set_filter(
+        png_ptr,
+        0,
+        settings.adaptive_filtering ? PNG_ALL_FILTERS : PNG_FILTER_NONE);
+    png_set_compression_level(png_ptr, settings.compression_level);
 
-    png_set_write_fn(
-        png_ptr, &output_file.stream, &write_handler, &flush_handler);
+    OutputBuffer buffer;
+    buffer.data.resize(width * height + 1024);
+    buffer.size = 0;
+    png_set_write_fn(png_ptr, &buffer, &write_handler, &flush_handler);
     png_write_info(png_ptr, info_ptr);
 
     auto rows = std::make_unique<const u8*[]>(height);
@@ -80,5 +126,295 @@ void PngImageEncoder::encode_impl(
     png_write_png(png_ptr, info_ptr, transformations, nullptr);
     png_destroy_write_struct(&png_ptr, &info_ptr);
 
+    buffer.data.resize(buffer.size);
+    output_stream.write(buffer.data);
+}
+
+static inline int paeth_predictor(const int a, const int b, const int c)
+{
+    const auto p = a + b - c;
+    const auto pa = std::abs(p - a);
+    const auto pb = std::abs(p - b);
+    const auto pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+template<typename T> static size_t apply_filter(
+    const u8 *row,
+    const u8 *prior_row,
+    const size_t stride,
+    const T &predict,
+    u8 *output)
+{
+    // same heuristic as libpng: minimal sum of absolute signed differences
+    size_t cost = 0;
+    for (const auto x : algo::range(stride_bpp))
+    {
+        output[x] = row[x] - predict(0, prior_row[x], 0);
+        cost += std::abs(static_cast<s8>(output[x]));
+    }
+    for (const auto x : algo::range(stride_bpp, stride))
+    {
+        output[x] = row[x] - predict(
+            row[x - stride_bpp], prior_row[x], prior_row[x - stride_bpp]);
+        cost += std::abs(static_cast<s8>(output[x]));
+    }
+    return cost;
+}
+
+static void filter_row(
+    const u8 *row,
+    const u8 *prior_row,
+    const size_t stride,
+    const bool adaptive_filtering,
+    bstr &scratch,
+    u8 *output)
+{
+    output[0] = 0;
+    std::memcpy(output + 1, row, stride);
+    if (!adaptive_filtering)
+        return;
+
+    auto candidate = scratch.get<u8>();
+    size_t best_cost = 0;
+    for (const auto x : algo::range(stride))
+        best_cost += std::abs(static_cast<s8>(row[x]));
+
+    const auto try_filter = [&](const u8 filter, const size_t cost)
+    {
+        if (cost >= best_cost)
+            return;
+        best_cost = cost;
+        output[0] = filter;
+        std::memcpy(output + 1, candidate, stride);
+    };
+
+    try_filter(1, apply_filter(
+        row, prior_row, stride,
+        [](const int a, const int, const int) { return a; },
+        candidate));
+    try_filter(2, apply_filter(
+        row, prior_row, stride,
+        [](const int, const int b, const int) { return b; },
+        candidate));
+    try_filter(3, apply_filter(
+        row, prior_row, stride,
+        [](const int a, const int b, const int) { return (a + b) >> 1; },
+        candidate));
+    try_filter(4, apply_filter(
+        row, prior_row, stride, paeth_predictor, candidate));
+}
+
+static void convert_row(const res::Image &image, const size_t y, u8 *output)
+{
+    const auto *input = &image.at(0, y);
+    for (const auto x : algo::range(image.width()))
+    {
+        output[0] = input[x].r;
+        output[1] = input[x].g;
+        output[2] = input[x].b;
+        output[3] = input[x].a;
+        output += stride_bpp;
+    }
+}
+
+static bstr filter_band(
+    const res::Image &image,
+    const size_t start_y,
+    const size_t end_y,
+    const bool adaptive_filtering)
+{
+    const auto stride = image.width() * stride_bpp;
+    bstr output((end_y - start_y) * (stride + 1));
+    bstr row(stride), prior_row(stride), scratch(stride);
+    if (start_y > 0)
+        convert_row(image, start_y - 1, prior_row.get<u8>());
+    for (const auto y : algo::range(start_y, end_y))
+    {
+        convert_row(image, y, row.get<u8>());
+        filter_row(
+            row.get<u8>(),
+            prior_row.get<u8>(),
+            stride,
+            adaptive_filtering,
+            scratch,
+            output.get<u8>() + (y - start_y) * (stride + 1));
+        std::swap(row, prior_row);
+    }
+    return output;
+}
+
+static bstr deflate_band(
+    const bstr &input,
+    const bstr *previous_input,
+    const int compression_level,
+    const bool is_last)
+{
+    // raw deflate so that the bands can be concatenated into one zlib
+    // stream; seeding each band with the tail of the previous one keeps
+    // back-references across the band boundaries
+    z_stream s;
+    std::memset(&s, 0, sizeof(s));
+    if (deflateInit2(
+            &s,
+            compression_level,
+            Z_DEFLATED,
+            -15,
+            8,
+            Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::logic_error("Failed to initialize zlib stream");
+    }
+
+    if (previous_input && previous_input->size())
+    {
+        const auto size = std::min<size_t>(
+            window_size, previous_input->size());
+        deflateSetDictionary(
+            &s,
+            previous_input->get<const u8>() + previous_input->size() - size,
+            size);
+    }
+
+    // the sync flush marker and the final empty block take a few bytes more
+    // than deflateBound reckons with
+    bstr output(deflateBound(&s, input.size()) + 16);
+    s.next_in = const_cast<u8*>(input.get<const u8>());
+    s.avail_in = input.size();
+    s.next_out = output.get<u8>();
+    s.avail_out = output.size();
+    const auto result = deflate(&s, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+    const auto output_size = s.total_out;
+    deflateEnd(&s);
+    if (result != (is_last ? Z_STREAM_END : Z_OK) || s.avail_in)
+        throw err::CorruptDataError("Failed to deflate stream");
+    output.resize(output_size);
+    return output;
+}
+
+static void write_chunk(
+    io::BaseByteStream &output_stream,
+    const bstr &type,
+    const bstr &data)
+{
+    auto crc = crc32(0, type.get<const u8>(), type.size());
+    // zlib resets the checksum when given a null buffer
+    if (data.size())
+        crc = crc32(crc, data.get<const u8>(), data.size());
+    output_stream.write_be<u32>(data.size());
+    output_stream.write(type);
+    output_stream.write(data);
+    output_stream.write_be<u32>(crc);
+}
+
+static bstr get_zlib_header(const int compression_level)
+{
+    const u8 cmf = 0x78;
+    const u8 level = compression_level < 2 ? 0
+        : compression_level < 6 ? 1
+        : compression_level == 6 ? 2 : 3;
+    u8 flg = level << 6;
+    flg += (31 - (((cmf << 8) | flg) % 31)) % 31;
+    bstr header(2);
+    header[0] = cmf;
+    header[1] = flg;
+    return header;
+}
+
+static void encode_in_parallel(
+    const res::Image &input_image,
+    const PresetSettings &settings,
+    const size_t band_count,
+    io::BaseByteStream &output_stream)
+{
+    const auto width = input_image.width();
+    const auto height = input_image.height();
+    std::vector<size_t> band_starts;
+    for (const auto i : algo::range(band_count + 1))
+        band_starts.push_back(height * i / band_count);
+
+    std::vector<bstr> filtered_bands(band_count);
+    algo::run_in_parallel(band_count, [&](const size_t i)
+    {
+        filtered_bands[i] = filter_band(
+            input_image,
+            band_starts[i],
+            band_starts[i + 1],
+            settings.adaptive_filtering);
+    });
+
+    std::vector<bstr> deflated_bands(band_count);
+    algo::run_in_parallel(band_count, [&](const size_t i)
+    {
+        deflated_bands[i] = deflate_band(
+            filtered_bands[i],
+            i ? &filtered_bands[i - 1] : nullptr,
+            settings.compression_level,
+            i == band_count - 1);
+    });
+
+    auto checksum = adler32(0, nullptr, 0);
+    for (const auto &band : filtered_bands)
+    {
+        checksum = adler32_combine(
+            checksum,
+            adler32(adler32(0, nullptr, 0), band.get<const u8>(), band.size()),
+            band.size());
+    }
+
+    output_stream.write("\x89PNG\x0D\x0A\x1A\x0A"_b);
+
+    io::MemoryByteStream header_stream;
+    header_stream.write_be<u32>(width);
+    header_stream.write_be<u32>(height);
+    header_stream.write<u8>(8); // bit depth
+    header_stream.write<u8>(6); // RGBA
+    header_stream.write<u8>(0); // compression method
+    header_stream.write<u8>(0); // filter method
+    header_stream.write<u8>(0); // interlace method
+    write_chunk(output_stream, "IHDR"_b, header_stream.seek(0).read_to_eof());
+
+    // one IDAT chunk per band; the zlib header goes into the first one and
+    // the checksum into the last one
+    deflated_bands.front() = get_zlib_header(settings.compression_level)
+        + deflated_bands.front();
+    for (const auto i : algo::range(4))
+        deflated_bands.back() += bstr(1, checksum >> (24 - i * 8));
+    for (const auto &band : deflated_bands)
+        write_chunk(output_stream, "IDAT"_b, band);
+
+    write_chunk(output_stream, "IEND"_b, ""_b);
+}
+
+PngImageEncoder::PngImageEncoder(
+    const PngCompressionPreset preset, const size_t thread_count) :
+        preset(preset),
+        thread_count(thread_count)
+{
+}
+
+void PngImageEncoder::encode_impl(
+    const Logger &logger,
+    const res::Image &input_image,
+    io::File &output_file) const
+{
+    const auto width = input_image.width();
+    const auto height = input_image.height();
+    if (!width || !height)
+        throw err::BadDataSizeError();
+
+    const auto settings = get_preset_settings(preset);
+    const auto band_count = std::min<size_t>(
+        thread_count, height / min_band_rows);
+    if (band_count > 1 && width * height >= parallel_min_pixels)
+    {
+        encode_in_parallel(
+            input_image, settings, band_count, output_file.stream);
+    }
+    else
+        encode_with_libpng(input_image, settings, output_file.stream);
+
     output_file.path.change_extension("png");
 }
@@ -23,13 +23,35 @@ namespace au {
 namespace enc {
 namespace png {
 
+    enum class PngCompressionPreset : u8
+    {
+        Store    = 0, // no compression
+        Fast     = 1, // no filtering, fastest deflate level
+        Balanced = 2, // adaptive filtering, default deflate level
+        Small    = 3, // adaptive filtering, best deflate level
+    };
+
     class PngImageEncoder final : public BaseImageEncoder
     {
+    public:
+        // Images of at least parallel_min_pixels pixels are split into row
+        // bands that are filtered and deflated on up to thread_count
+        // threads; smaller images are always encoded with libpng.
+        static const size_t parallel_min_pixels;
+
+        PngImageEncoder(
+            const PngCompressionPreset preset = PngCompressionPreset::Fast,
+            const size_t thread_count = 1);
+
     protected:
         void encode_impl(
             const Logger &logger,
             const res::Image &input_image,
             io::File &output_file) const override;
+
+    private:
+        PngCompressionPreset preset;
+        size_t thread_count;
     };
 
 } } }
@@ -17,14 +17,17 @@
 
 #include "flow/cli_facade.h"
 #include <algorithm>
+#include <cctype>
 #include <map>
 #include "algo/range.h"
 #include "algo/str.h"
 #include "arg_parser.h"
 #include "dec/idecoder.h"
 #include "dec/registry.h"
+#include "err.h"
 #include "flow/file_saver_hdd.h"
 #include "flow/parallel_unpacker.h"
+#include "io/file_byte_stream.h"
 #include "io/file_system.h"
 #include "version.h"
 #include "virtual_file_system.h"
@@ -47,9 +50,27 @@ namespace
         bool should_list_decoders;
         int verbosity = 3;
         unsigned int thread_count;
+        size_t max_inflight_tasks;
+        uoff_t max_memory;
+        bool should_show_stats;
+        io::path stats_path;
+        enc::png::PngCompressionPreset png_preset;
+        size_t png_thread_count;
     };
 }
 
+static uoff_t parse_memory_size(const std::string &input)
+{
+    static const std::string units = "KMG";
+    const auto unit = input.empty()
+        ? std::string::npos
+        : units.find(std::toupper(input.back()));
+    if (unit == std::string::npos)
+        return algo::from_string<uoff_t>(input);
+    return algo::from_string<uoff_t>(input.substr(0, input.size() - 1))
+        << (10 * (unit + 1));
+}
+
 struct CliFacade::Priv final
 {
 public:
@@ -179,6 +200,20 @@ void CliFacade::Priv::register_cli_options()
         ->set_value_name("NUM")
         ->set_description("Sets worker thread count.");
 
+    arg_parser.register_switch({"--max-inflight"})
+        ->set_value_name("NUM")
+        ->set_description(
+            "Limits how many files can be queued for decoding at once. "
+            "Archive entries are queued gradually to stay within the limit. "
+            "By default, there is no limit.");
+
+    arg_parser.register_switch({"--max-memory"})
+        ->set_value_name("SIZE")
+        ->set_description(
+            "Stops queueing archive entries while nested files waiting to be "
+            "decoded take more than SIZE bytes (K, M and G suffixes can be "
+            "used). By default, there is no limit.");
+
     {
         auto sw = arg_parser.register_switch({"-v", "--verbosity"})
             ->set_description(
@@ -205,6 +240,31 @@ void CliFacade::Priv::register_cli_options()
     arg_parser.register_flag({"--no-vfs"})
         ->set_description("Disables virtual file system lookups.");
 
+    arg_parser.register_switch({"--png-preset"})
+        ->set_value_name("PRESET")
+        ->set_description(
+            "Trades PNG encoding speed for output size (defaults to fast).")
+        ->add_possible_value("store")
+        ->add_possible_value("fast")
+        ->add_possible_value("balanced")
+        ->add_possible_value("small");
+
+    arg_parser.register_switch({"--png-threads"})
+        ->set_value_name("NUM")
+        ->set_description(
+            "Encodes very large images on up to NUM threads each "
+            "(defaults to 1).");
+
+    arg_parser.register_flag({"--stats"})
+        ->set_description(
+            "Shows time spent in each unpacking stage per decoder.");
+
+    arg_parser.register_switch({"--stats-json"})
+        ->set_value_name("PATH")
+        ->set_description(
+            "Saves time spent in each unpacking stage per decoder "
+            "to a JSON file.");
+
     arg_parser.register_flag({"--version"})
         ->set_description("Shows arc_unpacker version.");
 }
@@ -244,6 +304,40 @@ void CliFacade::Priv::parse_cli_options()
     else
         options.thread_count = 0;
 
+    options.max_inflight_tasks = 0;
+    if (arg_parser.has_switch("--max-inflight"))
+    {
+        const auto max_inflight_tasks
+            = algo::from_string<int>(arg_parser.get_switch("--max-inflight"));
+        if (max_inflight_tasks < 1)
+            throw err::UsageError("--max-inflight must be at least 1");
+        options.max_inflight_tasks = max_inflight_tasks;
+    }
+
+    options.max_memory = arg_parser.has_switch("--max-memory")
+        ? parse_memory_size(arg_parser.get_switch("--max-memory"))
+        : 0;
+
+    options.should_show_stats = arg_parser.has_flag("--stats");
+    if (arg_parser.has_switch("--stats-json"))
+        options.stats_path = arg_parser.get_switch("--stats-json");
+
+    options.png_preset = enc::png::PngCompressionPreset::Fast;
+    if (arg_parser.has_switch("--png-preset"))
+    {
+        const auto preset = arg_parser.get_switch("--png-preset");
+        if (preset == "store")
+            options.png_preset = enc::png::PngCompressionPreset::Store;
+        else if (preset == "balanced")
+            options.png_preset = enc::png::PngCompressionPreset::Balanced;
+        else if (preset == "small")
+            options.png_preset = enc::png::PngCompressionPreset::Small;
+    }
+
+    options.png_thread_count = arg_parser.has_switch("--png-threads")
+        ? algo::from_string<int>(arg_parser.get_switch("--png-threads"))
+        : 1;
+
     if (arg_parser.has_flag("--no-vfs"))
         VirtualFileSystem::disable();
 
@@ -313,7 +407,12 @@ int CliFacade::Priv::run() const
         registry,
         options.enable_nested_decoding,
         arguments,
-        available_decoders);
+        available_decoders,
+        options.max_inflight_tasks,
+        options.max_memory,
+        options.should_show_stats || !options.stats_path.str().empty(),
+        enc::png::PngImageEncoder(
+            options.png_preset, options.png_thread_count));
 
     ParallelUnpacker unpacker(context);
     for (const auto &input_path : options.input_paths)
@@ -328,7 +427,17 @@ int CliFacade::Priv::run() const
                     io::absolute(input_path), io::FileMode::Read);
             });
     }
-    return unpacker.run(options.thread_count) ? 0 : 1;
+    const auto result = unpacker.run(options.thread_count);
+
+    if (options.should_show_stats)
+        unpacker.get_stats().print_summary(logger);
+    if (!options.stats_path.str().empty())
+    {
+        io::FileByteStream(options.stats_path, io::FileMode::Write)
+            .write(unpacker.get_stats().to_json());
+    }
+
+    return result ? 0 : 1;
 }
 
 CliFacade::CliFacade(Logger &logger, const std::vector<std::string> &arguments)
@@ -0,0 +1,85 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/configured_decoder_cache.h"
+#include <map>
+#include <mutex>
+#include "arg_parser.h"
+
+using namespace au;
+using namespace au::flow;
+
+struct ConfiguredDecoderCache::Priv final
+{
+    Priv(
+        const dec::Registry &registry,
+        const std::vector<std::string> &arguments);
+
+    std::shared_ptr<const dec::IDecoder> create_decoder(
+        const std::string &name) const;
+
+    const dec::Registry &registry;
+    const std::vector<std::string> arguments;
+    std::map<std::string, std::shared_ptr<const dec::IDecoder>> decoders;
+    std::mutex mutex;
+};
+
+ConfiguredDecoderCache::Priv::Priv(
+    const dec::Registry &registry,
+    const std::vector<std::string> &arguments) :
+        registry(registry),
+        arguments(arguments)
+{
+}
+
+std::shared_ptr<const dec::IDecoder>
+    ConfiguredDecoderCache::Priv::create_decoder(const std::string &name) const
+{
+    const auto decoder = registry.create_decoder(name);
+    ArgParser decoder_arg_parser;
+    const auto decorators = decoder->get_arg_parser_decorators();
+    for (const auto &decorator : decorators)
+        decorator.register_cli_options(decoder_arg_parser);
+    decoder_arg_parser.parse(arguments);
+    for (const auto &decorator : decorators)
+        decorator.parse_cli_options(decoder_arg_parser);
+    return decoder;
+}
+
+ConfiguredDecoderCache::ConfiguredDecoderCache(
+    const dec::Registry &registry, const std::vector<std::string> &arguments)
+        : p(new Priv(registry, arguments))
+{
+}
+
+ConfiguredDecoderCache::~ConfiguredDecoderCache()
+{
+}
+
+std::shared_ptr<const dec::IDecoder> ConfiguredDecoderCache::get_decoder(
+    const std::string &name) const
+{
+    std::unique_lock<std::mutex> lock(p->mutex);
+    const auto it = p->decoders.find(name);
+    if (it != p->decoders.end())
+        return it->second;
+    // options that fail to parse aren't cached, so that every task using
+    // the decoder reports the error
+    const auto decoder = p->create_decoder(name);
+    p->decoders[name] = decoder;
+    return decoder;
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "dec/idecoder.h"
+#include "dec/registry.h"
+
+namespace au {
+namespace flow {
+
+    // Decoders with CLI options of the current run applied. Each decoder is
+    // created and configured once, then shared read-only between tasks.
+    class ConfiguredDecoderCache final
+    {
+    public:
+        ConfiguredDecoderCache(
+            const dec::Registry &registry,
+            const std::vector<std::string> &arguments);
+        ~ConfiguredDecoderCache();
+
+        std::shared_ptr<const dec::IDecoder> get_decoder(
+            const std::string &name) const;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} }
@@ -71,12 +71,30 @@ FileSaverHdd::~FileSaverHdd()
 
 io::path FileSaverHdd::save(std::shared_ptr<io::File> file) const
 {
+    io::path full_path;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        full_path = p->make_path_unique(p->output_dir / file->path);
+        io::create_directories(full_path.parent());
+    }
+
+    // Copying happens outside of the lock: stored entries read straight
+    // from the archive mapping, everything else in bounded chunks. Lazy
+    // streams decode while being copied, so a failure must not leave a
+    // truncated file behind.
+    try
+    {
+        io::FileByteStream output_stream(full_path, io::FileMode::Write);
+        output_stream.write(file->stream.seek(0));
+    }
+    catch (...)
+    {
+        if (io::exists(full_path))
+            io::remove(full_path);
+        throw;
+    }
+
     std::unique_lock<std::mutex> lock(mutex);
-    const auto full_path = p->make_path_unique(p->output_dir / file->path);
-    io::create_directories(full_path.parent());
-    io::FileByteStream output_stream(full_path, io::FileMode::Write);
-    file->stream.seek(0);
-    output_stream.write(file->stream);
     ++p->saved_file_count;
     return full_path;
 }
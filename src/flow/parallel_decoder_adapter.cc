@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/parallel_decoder_adapter.h"
+#include <chrono>
 #include "algo/naming_strategies.h"
 #include "enc/microsoft/wav_audio_encoder.h"
 #include "enc/png/png_image_encoder.h"
@@ -26,8 +27,11 @@ using namespace au::flow;
 
 ParallelDecoderAdapter::ParallelDecoderAdapter(
     const std::shared_ptr<const BaseParallelUnpackingTask> parent_task,
-    const std::shared_ptr<io::File> input_file)
-    : parent_task(parent_task), input_file(input_file)
+    const std::shared_ptr<io::File> input_file,
+    const std::string &decoder_name) :
+        parent_task(parent_task),
+        input_file(input_file),
+        decoder_name(decoder_name)
 {
 }
 
@@ -37,9 +41,12 @@ ParallelDecoderAdapter::~ParallelDecoderAdapter()
 
 void ParallelDecoderAdapter::visit(const dec::BaseArchiveDecoder &decoder)
 {
+    const auto &stats = parent_task->task_context.stats;
     auto input_file = this->input_file;
-    auto meta = std::shared_ptr<dec::ArchiveMeta>(
-        decoder.read_meta(parent_task->logger, *input_file));
+    auto meta = std::shared_ptr<dec::ArchiveMeta>(stats.measure(
+        decoder_name,
+        UnpackingStage::ReadMeta,
+        [&]() { return decoder.read_meta(parent_task->logger, *input_file); }));
     parent_task->logger.info(
         "archive contains %d files.\n", meta->entries.size());
 
@@ -48,56 +55,136 @@ void ParallelDecoderAdapter::visit(const dec::BaseArchiveDecoder &decoder)
         decoder,
         meta,
         input_file,
-        parent_task->base_name);
+        parent_task->base_name,
+        stats);
 
-    for (const auto &entry : meta->entries)
-    {
-        parent_task->save_file(
-            input_file,
-            [meta, &entry, &decoder, vfs_bridge]
-            (io::File &input_file_copy, const Logger &logger)
-            {
-                return decoder.read_file(
-                    logger, input_file_copy, *meta, *entry);
-            },
-            decoder,
-            entry->path.str());
-    }
+    if (meta->entries.empty())
+        return;
+
+    // Entries are queued as the throttle allows rather than all at once,
+    // so the producer keeps everything it needs alive by itself.
+    const auto parent_task = this->parent_task;
+    const auto decoder_ptr = decoder.shared_from_this();
+    const auto decoder_name = this->decoder_name;
+    size_t entry_index = 0;
+    parent_task->task_context.task_throttle.add_producer(
+        [parent_task, input_file, meta, vfs_bridge, decoder_ptr, decoder_name,
+            entry_index, &decoder, &stats]() mutable
+        {
+            const auto &entry = meta->entries[entry_index++];
+            parent_task->save_file(
+                input_file,
+                [meta, &entry, &decoder, vfs_bridge, decoder_name, &stats]
+                (io::File &input_file_copy, const Logger &logger)
+                {
+                    return stats.measure(
+                        decoder_name,
+                        UnpackingStage::ReadFile,
+                        [&]()
+                        {
+                            return decoder.read_file(
+                                logger, input_file_copy, *meta, *entry);
+                        });
+                },
+                decoder,
+                decoder_name,
+                entry->path.str());
+            return entry_index < meta->entries.size();
+        });
 }
 
 void ParallelDecoderAdapter::visit(const dec::BaseFileDecoder &decoder)
 {
+    const auto &stats = parent_task->task_context.stats;
+    const auto decoder_name = this->decoder_name;
     parent_task->save_file(
         input_file,
-        [&decoder](io::File &input_file_copy, const Logger &logger)
+        [&decoder, &stats, decoder_name]
+        (io::File &input_file_copy, const Logger &logger)
         {
-            return decoder.decode(logger, input_file_copy);
+            return stats.measure(
+                decoder_name,
+                UnpackingStage::Decode,
+                [&]() { return decoder.decode(logger, input_file_copy); });
         },
-        decoder);
+        decoder,
+        decoder_name);
 }
 
 void ParallelDecoderAdapter::visit(const dec::BaseImageDecoder &decoder)
 {
+    const auto &stats = parent_task->task_context.stats;
+    const auto &encoder
+        = parent_task->task_context.unpacker_context.image_encoder;
+    const auto decoder_name = this->decoder_name;
     parent_task->save_file(
         input_file,
-        [&decoder](io::File &input_file_copy, const Logger &logger)
+        [&decoder, &stats, &encoder, decoder_name]
+        (io::File &input_file_copy, const Logger &logger)
         {
-            auto output_file = decoder.decode(logger, input_file_copy);
-            const auto encoder = enc::png::PngImageEncoder();
-            return encoder.encode(logger, output_file, input_file_copy.path);
+            auto output_file = stats.measure(
+                decoder_name,
+                UnpackingStage::Decode,
+                [&]() { return decoder.decode(logger, input_file_copy); });
+            return stats.measure(
+                decoder_name,
+                UnpackingStage::Encode,
+                [&]()
+                {
+                    return encoder.encode(
+                        logger, output_file, input_file_copy.path);
+                });
         },
-        decoder);
+        decoder,
+        decoder_name);
 }
 
 void ParallelDecoderAdapter::visit(const dec::BaseAudioDecoder &decoder)
 {
+    const auto &stats = parent_task->task_context.stats;
+    const auto decoder_name = this->decoder_name;
     parent_task->save_file(
         input_file,
-        [&decoder](io::File &input_file_copy, const Logger &logger)
+        [&decoder, &stats, decoder_name]
+        (io::File &input_file_copy, const Logger &logger)
+            -> std::unique_ptr<io::File>
         {
-            auto output_file = decoder.decode(logger, input_file_copy);
             const auto encoder = enc::microsoft::WavAudioEncoder();
-            return encoder.encode(logger, output_file, input_file_copy.path);
+
+            // Tracks that can be decoded lazily are only decoded while the
+            // file saver writes them out, so that memory use does not grow
+            // with their length.
+            if (decoder.supports_streaming())
+            {
+                const auto decode_start = std::chrono::steady_clock::now();
+                const auto streamed_audio
+                    = decoder.decode_streamed(logger, input_file_copy);
+                if (streamed_audio)
+                {
+                    stats.add_time(
+                        decoder_name,
+                        UnpackingStage::Decode,
+                        std::chrono::duration<double>(
+                            std::chrono::steady_clock::now()
+                                - decode_start).count());
+                    return encoder.encode_streamed(
+                        logger, *streamed_audio, input_file_copy.path);
+                }
+            }
+
+            auto output_file = stats.measure(
+                decoder_name,
+                UnpackingStage::Decode,
+                [&]() { return decoder.decode(logger, input_file_copy); });
+            return stats.measure(
+                decoder_name,
+                UnpackingStage::Encode,
+                [&]()
+                {
+                    return encoder.encode(
+                        logger, output_file, input_file_copy.path);
+                });
         },
-        decoder);
+        decoder,
+        decoder_name);
 }
@@ -17,8 +17,9 @@
 
 #include "flow/parallel_unpacker.h"
 #include <chrono>
+#include <mutex>
 #include <set>
-#include <stack>
+#include <utility>
 #include "algo/format.h"
 #include "dec/idecoder.h"
 #include "err.h"
@@ -28,6 +29,7 @@ using namespace au;
 using namespace au::flow;
 
 static const auto max_depth = 10;
+static const std::string unrecognized_decoder_name = "(unrecognized)";
 static int task_count = 0;
 static std::mutex mutex;
 
@@ -41,11 +43,15 @@ namespace
             const io::path &base_name,
             const std::shared_ptr<const BaseParallelUnpackingTask> parent_task,
             const std::set<std::string> &decoders_to_check,
-            const InputFileFactory file_factory);
+            const InputFileFactory file_factory,
+            const uoff_t memory_usage = 0);
 
         bool work() const override;
 
-        const InputFileFactory file_factory;
+        // Released once the task runs, so that the file isn't kept in
+        // memory for as long as nested tasks refer to this one.
+        mutable InputFileFactory file_factory;
+        const uoff_t memory_usage;
     };
 
     struct ProcessOutputFileTask final : public BaseParallelUnpackingTask
@@ -59,24 +65,61 @@ namespace
             const std::shared_ptr<io::File> input_file,
             const DecoderFileFactory file_factory,
             const std::shared_ptr<const dec::IDecoder> origin_decoder,
+            const std::string &origin_decoder_name,
             const std::string &target_name);
 
         bool work() const override;
 
-        const std::shared_ptr<io::File> input_file;
+        // Released once the task runs, see DecodeInputFileTask.
+        mutable std::shared_ptr<io::File> input_file;
         const DecoderFileFactory file_factory;
         const std::shared_ptr<const dec::IDecoder> origin_decoder;
+        const std::string origin_decoder_name;
         const std::string target_name;
     };
+
+    // Lets the throttle know that a task is done, however work() exits.
+    class ThrottleRelease final
+    {
+    public:
+        ThrottleRelease(TaskThrottle &task_throttle, const uoff_t memory = 0);
+        ~ThrottleRelease();
+
+    private:
+        TaskThrottle &task_throttle;
+        const uoff_t memory;
+    };
+}
+
+ThrottleRelease::ThrottleRelease(
+    TaskThrottle &task_throttle, const uoff_t memory) :
+        task_throttle(task_throttle),
+        memory(memory)
+{
+}
+
+ThrottleRelease::~ThrottleRelease()
+{
+    task_throttle.release(memory);
 }
 
 static bool save(
-    const BaseParallelUnpackingTask &task, std::shared_ptr<io::File> file)
+    const BaseParallelUnpackingTask &task,
+    std::shared_ptr<io::File> file,
+    const std::string &decoder_name)
 {
+    const auto &stats = task.task_context.stats;
     try
     {
-        const auto full_path
-            = task.task_context.unpacker_context.file_saver.save(file);
+        const auto full_path = stats.measure(
+            decoder_name,
+            UnpackingStage::Save,
+            [&]()
+            {
+                return task.task_context.unpacker_context.file_saver.save(
+                    file);
+            });
+        stats.add_output_file(decoder_name, file->stream.size());
         task.logger.success("saved to %s\n", full_path.c_str());
         task.logger.flush();
         return true;
@@ -94,49 +137,41 @@ static std::set<std::string> collect_linked_decoders(
     const dec::IDecoder &base_decoder, const dec::Registry &registry)
 {
     std::set<std::string> known_formats;
-    std::vector<std::shared_ptr<dec::IDecoder>> linked_decoders;
-    std::stack<const dec::IDecoder*> decoders_to_inspect;
-    decoders_to_inspect.push(&base_decoder);
-    while (!decoders_to_inspect.empty())
+    for (const auto &format : base_decoder.get_linked_formats())
     {
-        const auto decoder_to_inspect = decoders_to_inspect.top();
-        decoders_to_inspect.pop();
-        for (const auto &format : decoder_to_inspect->get_linked_formats())
-        {
-            if (known_formats.find(format) != known_formats.end())
-                continue;
-            known_formats.insert(format);
-            auto linked_decoder = registry.create_decoder(format);
-            decoders_to_inspect.push(linked_decoder.get());
-            linked_decoders.push_back(std::move(linked_decoder));
-        }
+        if (known_formats.find(format) != known_formats.end())
+            continue;
+        known_formats.insert(format);
+        const auto closure = registry.get_linked_format_closure(format);
+        known_formats.insert(closure.begin(), closure.end());
     }
-    return std::set<std::string>(known_formats.begin(), known_formats.end());
+    return known_formats;
 }
 
-static std::shared_ptr<dec::IDecoder> guess_decoder(
+static std::string guess_decoder(
     const BaseParallelUnpackingTask &task,
     const std::set<std::string> &decoders_to_check,
     io::File &file,
     const TaskSourceType source_type)
 {
+    const auto &registry = task.task_context.unpacker_context.registry;
+    const auto candidates
+        = registry.get_recognition_candidates(file, decoders_to_check);
     task.logger.info(
-        "guessing decoder among %d decoders...\n", decoders_to_check.size());
+        "guessing decoder among %d decoders (%d candidates)...\n",
+        decoders_to_check.size(),
+        candidates.size());
 
-    std::map<std::string, std::shared_ptr<dec::IDecoder>> matching_decoders;
-    for (const auto &name : decoders_to_check)
-    {
-        const auto current_decoder
-            = task.task_context.unpacker_context.registry.create_decoder(name);
-        if (current_decoder->is_recognized(file))
-            matching_decoders[name] = std::move(current_decoder);
-    }
+    std::set<std::string> matching_decoders;
+    for (const auto &name : candidates)
+        if (registry.get_decoder_prototype(name)->is_recognized(file))
+            matching_decoders.insert(name);
 
     if (matching_decoders.size() == 1)
     {
-        task.logger.success(
-            "recognized as %s.\n", matching_decoders.begin()->first.c_str());
-        return matching_decoders.begin()->second;
+        const auto &name = *matching_decoders.begin();
+        task.logger.success("recognized as %s.\n", name.c_str());
+        return name;
     }
 
     if (matching_decoders.empty())
@@ -149,7 +184,7 @@ static std::shared_ptr<dec::IDecoder> guess_decoder(
         {
             task.logger.err("not recognized by any decoder.\n");
         }
-        return nullptr;
+        return "";
     }
 
     if (source_type == TaskSourceType::NestedDecoding)
@@ -159,11 +194,11 @@ static std::shared_ptr<dec::IDecoder> guess_decoder(
     else
     {
         task.logger.warn("file was recognized by multiple decoders.\n");
-        for (const auto &it : matching_decoders)
-            task.logger.warn("- " + it.first + "\n");
+        for (const auto &name : matching_decoders)
+            task.logger.warn("- " + name + "\n");
         task.logger.warn("Please provide --dec and proceed manually.\n");
     }
-    return nullptr;
+    return "";
 }
 
 ParallelUnpackerContext::ParallelUnpackerContext(
@@ -172,23 +207,37 @@ ParallelUnpackerContext::ParallelUnpackerContext(
     const dec::Registry &registry,
     const bool enable_nested_decoding,
     const std::vector<std::string> &arguments,
-    const std::set<std::string> &decoders_to_check) :
+    const std::set<std::string> &decoders_to_check,
+    const size_t max_inflight_tasks,
+    const uoff_t max_memory,
+    const bool enable_stats,
+    const enc::png::PngImageEncoder &image_encoder) :
         logger(logger),
         file_saver(file_saver),
         registry(registry),
         enable_nested_decoding(enable_nested_decoding),
         arguments(arguments),
-        decoders_to_check(decoders_to_check)
+        decoders_to_check(decoders_to_check),
+        max_inflight_tasks(max_inflight_tasks),
+        max_memory(max_memory),
+        enable_stats(enable_stats),
+        image_encoder(image_encoder)
 {
 }
 
 ParallelTaskContext::ParallelTaskContext(
     ParallelUnpacker &unpacker,
     const ParallelUnpackerContext &unpacker_context,
-    TaskScheduler &task_scheduler) :
+    const ConfiguredDecoderCache &configured_decoders,
+    TaskScheduler &task_scheduler,
+    TaskThrottle &task_throttle,
+    const UnpackingStats &stats) :
         unpacker(unpacker),
         unpacker_context(unpacker_context),
-        task_scheduler(task_scheduler)
+        configured_decoders(configured_decoders),
+        task_scheduler(task_scheduler),
+        task_throttle(task_throttle),
+        stats(stats)
 {
 }
 
@@ -228,8 +277,10 @@ void BaseParallelUnpackingTask::save_file(
     const std::shared_ptr<io::File> input_file,
     const DecoderFileFactory file_factory,
     const dec::BaseDecoder &origin_decoder,
+    const std::string &origin_decoder_name,
     const std::string &target_name) const
 {
+    task_context.task_throttle.acquire();
     task_context.task_scheduler.push_front(
         std::make_shared<ProcessOutputFileTask>(
             task_context,
@@ -241,6 +292,7 @@ void BaseParallelUnpackingTask::save_file(
             input_file,
             file_factory,
             origin_decoder.shared_from_this(),
+            origin_decoder_name,
             target_name));
 }
 
@@ -250,20 +302,29 @@ DecodeInputFileTask::DecodeInputFileTask(
     const io::path &base_name,
     const std::shared_ptr<const BaseParallelUnpackingTask> parent_task,
     const std::set<std::string> &decoders_to_check,
-    const InputFileFactory file_factory) :
+    const InputFileFactory file_factory,
+    const uoff_t memory_usage) :
         BaseParallelUnpackingTask(
             task_context,
             source_type,
             base_name,
             parent_task,
             decoders_to_check),
-        file_factory(file_factory)
+        file_factory(file_factory),
+        memory_usage(memory_usage)
 {
 }
 
 bool DecodeInputFileTask::work() const
 {
+    const ThrottleRelease throttle_release(
+        task_context.task_throttle, memory_usage);
+
+    InputFileFactory file_factory;
+    std::swap(file_factory, this->file_factory);
+
     std::shared_ptr<io::File> input_file;
+    std::string decoder_name = unrecognized_decoder_name;
     try
     {
         input_file = file_factory();
@@ -283,25 +344,30 @@ bool DecodeInputFileTask::work() const
     {
         logger.info("initial recognition...\n");
 
-        const auto decoder = guess_decoder(
+        const auto guess_start = std::chrono::steady_clock::now();
+        decoder_name = guess_decoder(
             *this, decoders_to_check, *input_file, source_type);
-
-        if (!decoder)
+        if (decoder_name.empty())
+            decoder_name = unrecognized_decoder_name;
+        task_context.stats.add_time(
+            decoder_name,
+            UnpackingStage::Guess,
+            std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - guess_start).count());
+        task_context.stats.add_input_file(
+            decoder_name, input_file->stream.size());
+
+        if (decoder_name == unrecognized_decoder_name)
         {
             return source_type == TaskSourceType::NestedDecoding
-                ? save(*this, input_file)
+                ? save(*this, input_file, decoder_name)
                 : false;
         }
 
-        ArgParser decoder_arg_parser;
-        const auto decorators = decoder->get_arg_parser_decorators();
-        for (const auto &decorator : decorators)
-            decorator.register_cli_options(decoder_arg_parser);
-        decoder_arg_parser.parse(task_context.unpacker_context.arguments);
-        for (const auto &decorator : decorators)
-            decorator.parse_cli_options(decoder_arg_parser);
-
-        ParallelDecoderAdapter adapter(shared_from_this(), input_file);
+        const auto decoder
+            = task_context.configured_decoders.get_decoder(decoder_name);
+        ParallelDecoderAdapter adapter(
+            shared_from_this(), input_file, decoder_name);
         decoder->accept(adapter);
         return true;
     }
@@ -309,7 +375,7 @@ bool DecodeInputFileTask::work() const
     {
         logger.err("recognition finished with errors:\n%s\n", e.what());
         if (source_type == TaskSourceType::NestedDecoding)
-            save(*this, input_file);
+            save(*this, input_file, decoder_name);
         return false;
     }
 }
@@ -323,6 +389,7 @@ ProcessOutputFileTask::ProcessOutputFileTask(
     const std::shared_ptr<io::File> input_file,
     const DecoderFileFactory file_factory,
     const std::shared_ptr<const dec::IDecoder> origin_decoder,
+    const std::string &origin_decoder_name,
     const std::string &target_name) :
         BaseParallelUnpackingTask(
             task_context,
@@ -333,17 +400,23 @@ ProcessOutputFileTask::ProcessOutputFileTask(
         input_file(input_file),
         file_factory(file_factory),
         origin_decoder(origin_decoder),
+        origin_decoder_name(origin_decoder_name),
         target_name(target_name)
 {
 }
 
 bool ProcessOutputFileTask::work() const
 {
+    const ThrottleRelease throttle_release(task_context.task_throttle);
+
     logger.info(
         target_name.empty()
             ? "decoding...\n"
             : "decoding \"%s\"...\n",
         target_name.c_str());
+
+    std::shared_ptr<io::File> input_file;
+    std::swap(input_file, this->input_file);
     if (!input_file)
     {
         logger.err("error obtaining input file!\n");
@@ -377,7 +450,7 @@ bool ProcessOutputFileTask::work() const
                 "error decoding \"%s\" (%s)\n", target_name.c_str(), e.what());
         }
         if (source_type == TaskSourceType::NestedDecoding)
-            save(*this, input_file);
+            save(*this, input_file, origin_decoder_name);
         return false;
     }
 
@@ -392,7 +465,7 @@ bool ProcessOutputFileTask::work() const
         naming_strategy, base_name, output_file->path);
 
     if (!task_context.unpacker_context.enable_nested_decoding)
-        return save(*this, output_file);
+        return save(*this, output_file, origin_decoder_name);
 
     auto linked_decoders = collect_linked_decoders(
         *origin_decoder, task_context.unpacker_context.registry);
@@ -400,14 +473,16 @@ bool ProcessOutputFileTask::work() const
         decoders_to_check.begin(), decoders_to_check.end());
 
     if (linked_decoders.empty())
-        return save(*this, output_file);
+        return save(*this, output_file, origin_decoder_name);
 
     if (get_depth() >= max_depth)
     {
         logger.warn("cycle detected.\n");
-        return save(*this, output_file);
+        return save(*this, output_file, origin_decoder_name);
     }
 
+    const auto memory_usage = output_file->stream.size();
+    task_context.task_throttle.acquire(memory_usage);
     task_context.task_scheduler.push_front(
         std::make_shared<DecodeInputFileTask>(
             task_context,
@@ -415,7 +490,8 @@ bool ProcessOutputFileTask::work() const
             output_file->path,
             shared_from_this(),
             linked_decoders,
-            [=]() { return output_file; }));
+            [=]() { return output_file; },
+            memory_usage));
 
     return true;
 }
@@ -427,7 +503,10 @@ struct ParallelUnpacker::Priv final
         const ParallelUnpackerContext &unpacker_context);
 
     const ParallelUnpackerContext &unpacker_context;
+    ConfiguredDecoderCache configured_decoders;
     TaskScheduler task_scheduler;
+    TaskThrottle task_throttle;
+    UnpackingStats stats;
     ParallelTaskContext task_context;
 };
 
@@ -435,7 +514,18 @@ ParallelUnpacker::Priv::Priv(
     ParallelUnpacker &unpacker,
     const ParallelUnpackerContext &unpacker_context) :
         unpacker_context(unpacker_context),
-        task_context(unpacker, unpacker_context, task_scheduler)
+        configured_decoders(
+            unpacker_context.registry, unpacker_context.arguments),
+        task_throttle(
+            unpacker_context.max_inflight_tasks, unpacker_context.max_memory),
+        stats(unpacker_context.enable_stats),
+        task_context(
+            unpacker,
+            unpacker_context,
+            configured_decoders,
+            task_scheduler,
+            task_throttle,
+            stats)
 {
 }
 
@@ -452,6 +542,7 @@ ParallelUnpacker::~ParallelUnpacker()
 void ParallelUnpacker::add_input_file(
     const io::path &base_name, const InputFileFactory file_factory)
 {
+    p->task_throttle.acquire();
     p->task_scheduler.push_back(
         std::make_shared<DecodeInputFileTask>(
             p->task_context,
@@ -467,6 +558,7 @@ bool ParallelUnpacker::run(const size_t thread_count)
     const auto begin = std::chrono::steady_clock::now();
     const auto results = p->task_scheduler.run(thread_count);
     const auto end = std::chrono::steady_clock::now();
+    p->stats.set_peak_queue_depth(p->task_throttle.get_peak_inflight_tasks());
     const auto diff
         = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
 
@@ -497,3 +589,8 @@ bool ParallelUnpacker::run(const size_t thread_count)
 
     return results.error_count == 0;
 }
+
+const UnpackingStats &ParallelUnpacker::get_stats() const
+{
+    return p->stats;
+}
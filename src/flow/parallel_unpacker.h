@@ -22,8 +22,12 @@
 #include <set>
 #include "dec/base_decoder.h"
 #include "dec/registry.h"
+#include "enc/png/png_image_encoder.h"
+#include "flow/configured_decoder_cache.h"
 #include "flow/ifile_saver.h"
 #include "flow/task_scheduler.h"
+#include "flow/task_throttle.h"
+#include "flow/unpacking_stats.h"
 #include "logger.h"
 
 namespace au {
@@ -49,7 +53,12 @@ namespace flow {
             const dec::Registry &registry,
             const bool enable_nested_decoding,
             const std::vector<std::string> &arguments,
-            const std::set<std::string> &decoders_to_check);
+            const std::set<std::string> &decoders_to_check,
+            const size_t max_inflight_tasks = 0,
+            const uoff_t max_memory = 0,
+            const bool enable_stats = false,
+            const enc::png::PngImageEncoder &image_encoder
+                = enc::png::PngImageEncoder());
 
         const Logger &logger;
         const IFileSaver &file_saver;
@@ -57,6 +66,10 @@ namespace flow {
         const bool enable_nested_decoding;
         const std::vector<std::string> arguments;
         const std::set<std::string> decoders_to_check;
+        const size_t max_inflight_tasks;
+        const uoff_t max_memory;
+        const bool enable_stats;
+        const enc::png::PngImageEncoder image_encoder;
     };
 
     struct ParallelTaskContext final
@@ -64,11 +77,17 @@ namespace flow {
         ParallelTaskContext(
             ParallelUnpacker &unpacker,
             const ParallelUnpackerContext &unpacker_context,
-            TaskScheduler &task_scheduler);
+            const ConfiguredDecoderCache &configured_decoders,
+            TaskScheduler &task_scheduler,
+            TaskThrottle &task_throttle,
+            const UnpackingStats &stats);
 
         ParallelUnpacker &unpacker;
         const ParallelUnpackerContext &unpacker_context;
+        const ConfiguredDecoderCache &configured_decoders;
         TaskScheduler &task_scheduler;
+        TaskThrottle &task_throttle;
+        const UnpackingStats &stats;
     };
 
     struct BaseParallelUnpackingTask :
@@ -90,6 +109,7 @@ namespace flow {
             const std::shared_ptr<io::File> input_file,
             const DecoderFileFactory,
             const dec::BaseDecoder &origin_decoder,
+            const std::string &origin_decoder_name,
             const std::string &custom_name = "") const;
 
         Logger logger;
@@ -108,6 +128,7 @@ namespace flow {
 
         void add_input_file(const io::path &base_name, const InputFileFactory);
         bool run(const size_t thread_count = 0);
+        const UnpackingStats &get_stats() const;
 
     private:
         struct Priv;
@@ -16,8 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/task_scheduler.h"
-#include <chrono>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include "algo/range.h"
@@ -25,13 +27,137 @@
 using namespace au;
 using namespace au::flow;
 
+namespace
+{
+    struct Worker final
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<ITask>> tasks;
+    };
+
+    struct WorkerContext final
+    {
+        const TaskScheduler *scheduler;
+        Worker *worker;
+    };
+}
+
+// Lets tasks that push nested work reach the deque of the worker that runs
+// them, so that nested tasks keep the depth-first order without contention.
+static thread_local WorkerContext current_context = {nullptr, nullptr};
+
 struct TaskScheduler::Priv final
 {
-    std::deque<std::shared_ptr<ITask>> tasks;
-    std::vector<std::unique_ptr<std::thread>> threads;
+    Priv(const TaskScheduler &scheduler);
+
+    void push(std::shared_ptr<ITask> task, const bool front);
+    std::shared_ptr<ITask> pop(const size_t worker_index);
+    void notify(const bool all);
+
+    const TaskScheduler &scheduler;
+
+    std::mutex shared_mutex;
+    std::deque<std::shared_ptr<ITask>> shared_tasks;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex idle_mutex;
+    std::condition_variable idle_condition;
+    std::atomic<size_t> idle_count;
+
+    // Tasks sitting in any of the deques.
+    std::atomic<size_t> queued_count;
+    // Tasks sitting in any of the deques plus tasks that are being executed.
+    // Once it drops to zero no task can push any more work.
+    std::atomic<size_t> pending_count;
 };
 
-TaskScheduler::TaskScheduler() : p(new Priv())
+TaskScheduler::Priv::Priv(const TaskScheduler &scheduler)
+    : scheduler(scheduler), idle_count(0), queued_count(0), pending_count(0)
+{
+}
+
+void TaskScheduler::Priv::push(std::shared_ptr<ITask> task, const bool front)
+{
+    ++pending_count;
+    if (front
+        && current_context.scheduler == &scheduler
+        && current_context.worker)
+    {
+        std::unique_lock<std::mutex> lock(current_context.worker->mutex);
+        current_context.worker->tasks.push_front(task);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(shared_mutex);
+        if (front)
+            shared_tasks.push_front(task);
+        else
+            shared_tasks.push_back(task);
+    }
+    ++queued_count;
+    notify(false);
+}
+
+std::shared_ptr<ITask> TaskScheduler::Priv::pop(const size_t worker_index)
+{
+    std::shared_ptr<ITask> task;
+
+    {
+        auto &worker = *workers[worker_index];
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty())
+        {
+            task = worker.tasks.front();
+            worker.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        std::unique_lock<std::mutex> lock(shared_mutex);
+        if (!shared_tasks.empty())
+        {
+            task = shared_tasks.front();
+            shared_tasks.pop_front();
+        }
+    }
+
+    for (const auto i : algo::range(1, workers.size()))
+    {
+        if (task)
+            break;
+        auto &victim = *workers[(worker_index + i) % workers.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+        }
+    }
+
+    if (task)
+        --queued_count;
+    return task;
+}
+
+void TaskScheduler::Priv::notify(const bool all)
+{
+    // Workers register as idle before checking the counters, so if nobody is
+    // idle at this point, whoever goes idle next will see the new counters.
+    // Taking the lock guarantees that an idle worker that has just checked
+    // the counters is already waiting and won't miss the notification.
+    if (!idle_count)
+        return;
+    {
+        std::unique_lock<std::mutex> lock(idle_mutex);
+    }
+    if (all)
+        idle_condition.notify_all();
+    else
+        idle_condition.notify_one();
+}
+
+TaskScheduler::TaskScheduler() : p(new Priv(*this))
 {
 }
 
@@ -41,14 +167,12 @@ TaskScheduler::~TaskScheduler()
 
 void TaskScheduler::push_front(std::shared_ptr<ITask> task)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    p->tasks.push_front(task);
+    p->push(task, true);
 }
 
 void TaskScheduler::push_back(std::shared_ptr<ITask> task)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    p->tasks.push_back(task);
+    p->push(task, false);
 }
 
 TaskSchedulerResult TaskScheduler::run(size_t number_of_threads)
@@ -58,50 +182,57 @@ TaskSchedulerResult TaskScheduler::run(size_t number_of_threads)
     if (!number_of_threads)
         number_of_threads = 1;
 
-    TaskSchedulerResult result;
-    result.success_count = 0;
-    result.error_count = 0;
-    bool still_running = true;
+    std::atomic<int> success_count(0);
+    std::atomic<int> error_count(0);
 
+    p->workers.clear();
+    for (const auto i : algo::range(number_of_threads))
+        p->workers.push_back(std::make_unique<Worker>());
+
+    std::vector<std::unique_ptr<std::thread>> threads;
     for (const auto i : algo::range(number_of_threads))
     {
-        p->threads.push_back(std::make_unique<std::thread>([&]()
+        threads.push_back(std::make_unique<std::thread>([&, i]()
         {
+            current_context.scheduler = this;
+            current_context.worker = p->workers[i].get();
+
             while (true)
             {
-                std::shared_ptr<ITask> task;
-
+                const auto task = p->pop(i);
+                if (!task)
                 {
-                    std::unique_lock<std::mutex> lock(mutex);
-                    if (p->tasks.empty())
+                    std::unique_lock<std::mutex> lock(p->idle_mutex);
+                    ++p->idle_count;
+                    p->idle_condition.wait(lock, [&]()
                     {
-                        if (still_running && number_of_threads > 1)
-                        {
-                            lock.unlock();
-                            std::this_thread::sleep_for(
-                                std::chrono::milliseconds(10));
-                            continue;
-                        }
+                        return p->queued_count > 0 || p->pending_count == 0;
+                    });
+                    --p->idle_count;
+                    if (!p->queued_count && !p->pending_count)
                         break;
-                    }
-                    task = p->tasks.front();
-                    p->tasks.pop_front();
+                    continue;
                 }
 
                 const auto local_success = task->work();
+                success_count += local_success;
+                error_count += !local_success;
 
-                {
-                    std::unique_lock<std::mutex> lock(mutex);
-                    result.success_count += local_success;
-                    result.error_count += !local_success;
-                    still_running = !p->tasks.empty();
-                }
+                if (--p->pending_count == 0)
+                    p->notify(true);
             }
+
+            current_context.scheduler = nullptr;
+            current_context.worker = nullptr;
         }));
     }
 
-    for (auto &t : p->threads)
+    for (auto &t : threads)
         t->join();
+    p->workers.clear();
 
+    TaskSchedulerResult result;
+    result.success_count = success_count;
+    result.error_count = error_count;
     return result;
 }
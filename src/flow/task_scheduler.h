@@ -18,7 +18,6 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
 
 namespace au {
 namespace flow {
@@ -44,8 +43,7 @@ namespace flow {
         TaskSchedulerResult run(const size_t number_of_threads = 0);
         void push_front(std::shared_ptr<ITask> task);
         void push_back(std::shared_ptr<ITask> task);
-        void join();
-        std::mutex mutex;
+
     private:
         struct Priv;
         std::unique_ptr<Priv> p;
@@ -0,0 +1,120 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/task_throttle.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+using namespace au;
+using namespace au::flow;
+
+struct TaskThrottle::Priv final
+{
+    Priv(const size_t max_inflight_tasks, const uoff_t max_memory);
+
+    bool is_saturated() const;
+    void run_producers();
+
+    const size_t max_inflight_tasks;
+    const uoff_t max_memory;
+    std::atomic<size_t> inflight_tasks;
+    std::atomic<size_t> peak_inflight_tasks;
+    std::atomic<uoff_t> used_memory;
+    std::deque<Producer> producers;
+    std::mutex producer_mutex;
+};
+
+TaskThrottle::Priv::Priv(
+    const size_t max_inflight_tasks, const uoff_t max_memory) :
+        max_inflight_tasks(max_inflight_tasks),
+        max_memory(max_memory),
+        inflight_tasks(0),
+        peak_inflight_tasks(0),
+        used_memory(0)
+{
+}
+
+bool TaskThrottle::Priv::is_saturated() const
+{
+    return (max_inflight_tasks && inflight_tasks >= max_inflight_tasks)
+        || (max_memory && used_memory >= max_memory);
+}
+
+void TaskThrottle::Priv::run_producers()
+{
+    // Every producer that gets throttled has at least one task in flight
+    // ahead of it, whose release() brings it back here - so nothing stalls.
+    std::unique_lock<std::mutex> lock(producer_mutex);
+    while (!producers.empty() && !is_saturated())
+    {
+        if (!producers.front()())
+            producers.pop_front();
+    }
+}
+
+TaskThrottle::TaskThrottle(
+    const size_t max_inflight_tasks, const uoff_t max_memory)
+        : p(new Priv(max_inflight_tasks, max_memory))
+{
+}
+
+TaskThrottle::~TaskThrottle()
+{
+}
+
+void TaskThrottle::add_producer(const Producer producer)
+{
+    {
+        std::unique_lock<std::mutex> lock(p->producer_mutex);
+        p->producers.push_back(producer);
+    }
+    p->run_producers();
+}
+
+void TaskThrottle::acquire(const uoff_t memory)
+{
+    const size_t inflight_tasks = ++p->inflight_tasks;
+    size_t peak = p->peak_inflight_tasks;
+    while (inflight_tasks > peak
+        && !p->peak_inflight_tasks.compare_exchange_weak(peak, inflight_tasks))
+    {
+    }
+    p->used_memory += memory;
+}
+
+void TaskThrottle::release(const uoff_t memory)
+{
+    p->inflight_tasks--;
+    p->used_memory -= memory;
+    p->run_producers();
+}
+
+size_t TaskThrottle::get_inflight_tasks() const
+{
+    return p->inflight_tasks;
+}
+
+size_t TaskThrottle::get_peak_inflight_tasks() const
+{
+    return p->peak_inflight_tasks;
+}
+
+uoff_t TaskThrottle::get_used_memory() const
+{
+    return p->used_memory;
+}
@@ -0,0 +1,55 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include "types.h"
+
+namespace au {
+namespace flow {
+
+    // Keeps the number of tasks in flight and the memory held by them within
+    // limits, so that large archives don't queue all of their entries at
+    // once. Work that fans out is added as producers, which get to create
+    // more tasks whenever an earlier one finishes. A zero limit is ignored.
+    class TaskThrottle final
+    {
+    public:
+        // Creates the next task and returns whether there are any more.
+        using Producer = std::function<bool()>;
+
+        TaskThrottle(const size_t max_inflight_tasks, const uoff_t max_memory);
+        ~TaskThrottle();
+
+        void add_producer(const Producer producer);
+
+        // Called when a task is queued and when it's done, respectively.
+        void acquire(const uoff_t memory = 0);
+        void release(const uoff_t memory = 0);
+
+        size_t get_inflight_tasks() const;
+        size_t get_peak_inflight_tasks() const;
+        uoff_t get_used_memory() const;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+} }
@@ -0,0 +1,303 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/unpacking_stats.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include "algo/format.h"
+#include "algo/range.h"
+
+using namespace au;
+using namespace au::flow;
+
+static const size_t stage_count = 6;
+
+static const std::array<std::string, stage_count> stage_names =
+{
+    "guess",
+    "read_meta",
+    "read_file",
+    "decode",
+    "encode",
+    "save",
+};
+
+namespace
+{
+    struct DecoderStats final
+    {
+        DecoderStats();
+
+        size_t input_count, output_count;
+        uoff_t input_size, output_size;
+        std::array<double, stage_count> seconds;
+    };
+}
+
+DecoderStats::DecoderStats() :
+    input_count(0),
+    output_count(0),
+    input_size(0),
+    output_size(0)
+{
+    seconds.fill(0);
+}
+
+static DecoderStats get_total(
+    const std::map<std::string, DecoderStats> &decoder_stats)
+{
+    DecoderStats total;
+    for (const auto &kv : decoder_stats)
+    {
+        total.input_count += kv.second.input_count;
+        total.output_count += kv.second.output_count;
+        total.input_size += kv.second.input_size;
+        total.output_size += kv.second.output_size;
+        for (const auto i : algo::range(stage_count))
+            total.seconds[i] += kv.second.seconds[i];
+    }
+    return total;
+}
+
+static std::string format_size(const uoff_t size)
+{
+    if (size < 1024 * 10)
+        return algo::format("%dB", static_cast<int>(size));
+    if (size < 1024 * 1024 * 10)
+        return algo::format("%.1fK", size / 1024.0);
+    if (size < 1024ull * 1024 * 1024 * 10)
+        return algo::format("%.1fM", size / 1024.0 / 1024.0);
+    return algo::format("%.1fG", size / 1024.0 / 1024.0 / 1024.0);
+}
+
+static std::string escape_json(const std::string &input)
+{
+    std::string output;
+    for (const auto c : input)
+    {
+        if (c == '"' || c == '\\')
+            output += '\\';
+        if (static_cast<u8>(c) < 0x20)
+            output += algo::format("\\u%04x", c);
+        else
+            output += c;
+    }
+    return output;
+}
+
+static std::string format_json(const DecoderStats &stats)
+{
+    std::string output = algo::format(
+        "{\"input_files\": %d, \"output_files\": %d, "
+        "\"input_bytes\": %llu, \"output_bytes\": %llu, \"seconds\": {",
+        stats.input_count,
+        stats.output_count,
+        static_cast<unsigned long long>(stats.input_size),
+        static_cast<unsigned long long>(stats.output_size));
+    for (const auto i : algo::range(stage_count))
+    {
+        output += algo::format(
+            "%s\"%s\": %.06f",
+            i ? ", " : "",
+            stage_names[i].c_str(),
+            stats.seconds[i]);
+    }
+    return output + "}}";
+}
+
+struct UnpackingStats::Priv final
+{
+    Priv(const bool enabled);
+
+    const bool enabled;
+    std::map<std::string, DecoderStats> decoder_stats;
+    size_t peak_queue_depth;
+    size_t vfs_cache_hits, vfs_cache_misses;
+    std::mutex mutex;
+};
+
+UnpackingStats::Priv::Priv(const bool enabled)
+    : enabled(enabled), peak_queue_depth(0), vfs_cache_hits(0),
+        vfs_cache_misses(0)
+{
+}
+
+UnpackingStats::UnpackingStats(const bool enabled) : p(new Priv(enabled))
+{
+}
+
+UnpackingStats::~UnpackingStats()
+{
+}
+
+bool UnpackingStats::is_enabled() const
+{
+    return p->enabled;
+}
+
+void UnpackingStats::add_time(
+    const std::string &decoder_name,
+    const UnpackingStage stage,
+    const double seconds) const
+{
+    if (!p->enabled)
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    p->decoder_stats[decoder_name].seconds[static_cast<size_t>(stage)]
+        += seconds;
+}
+
+void UnpackingStats::add_input_file(
+    const std::string &decoder_name, const uoff_t size) const
+{
+    if (!p->enabled)
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    auto &stats = p->decoder_stats[decoder_name];
+    stats.input_count++;
+    stats.input_size += size;
+}
+
+void UnpackingStats::add_output_file(
+    const std::string &decoder_name, const uoff_t size) const
+{
+    if (!p->enabled)
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    auto &stats = p->decoder_stats[decoder_name];
+    stats.output_count++;
+    stats.output_size += size;
+}
+
+void UnpackingStats::set_peak_queue_depth(const size_t queue_depth) const
+{
+    if (!p->enabled)
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    p->peak_queue_depth = std::max(p->peak_queue_depth, queue_depth);
+}
+
+void UnpackingStats::add_vfs_cache_lookup(const bool hit) const
+{
+    if (!p->enabled)
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    (hit ? p->vfs_cache_hits : p->vfs_cache_misses)++;
+}
+
+void UnpackingStats::print_summary(const Logger &logger) const
+{
+    std::unique_lock<std::mutex> lock(p->mutex);
+
+    size_t name_width = 7;
+    for (const auto &kv : p->decoder_stats)
+        name_width = std::max(name_width, kv.first.size());
+
+    const auto print_row = [&](
+        const std::string &name, const DecoderStats &stats)
+    {
+        auto row = algo::format(
+            "%-*s %7d %7d %8s %8s",
+            static_cast<int>(name_width),
+            name.c_str(),
+            stats.input_count,
+            stats.output_count,
+            format_size(stats.input_size).c_str(),
+            format_size(stats.output_size).c_str());
+        for (const auto seconds : stats.seconds)
+            row += algo::format(" %9.3f", seconds);
+        logger.log(Logger::MessageType::Summary, "%s\n", row.c_str());
+    };
+
+    auto header = algo::format(
+        "%-*s %7s %7s %8s %8s",
+        static_cast<int>(name_width),
+        "decoder",
+        "in",
+        "out",
+        "in size",
+        "out size");
+    for (const auto &stage_name : stage_names)
+        header += algo::format(" %9s", stage_name.c_str());
+    logger.log(Logger::MessageType::Summary, "%s\n", header.c_str());
+
+    for (const auto &kv : p->decoder_stats)
+        print_row(kv.first, kv.second);
+    print_row("total", get_total(p->decoder_stats));
+
+    logger.log(
+        Logger::MessageType::Summary,
+        "Stage times are in seconds summed across threads. "
+        "Peak queue depth: %d tasks.\n",
+        p->peak_queue_depth);
+    logger.log(
+        Logger::MessageType::Summary,
+        "Virtual file system cache: %d hits, %d misses.\n",
+        p->vfs_cache_hits,
+        p->vfs_cache_misses);
+}
+
+std::string UnpackingStats::to_json() const
+{
+    std::unique_lock<std::mutex> lock(p->mutex);
+    std::string output = "{\n";
+    output += algo::format(
+        "    \"peak_queue_depth\": %d,\n", p->peak_queue_depth);
+    output += algo::format(
+        "    \"vfs_cache_hits\": %d,\n    \"vfs_cache_misses\": %d,\n",
+        p->vfs_cache_hits,
+        p->vfs_cache_misses);
+    output += "    \"total\": " + format_json(get_total(p->decoder_stats));
+    output += ",\n    \"decoders\": {";
+    auto first = true;
+    for (const auto &kv : p->decoder_stats)
+    {
+        output += first ? "\n" : ",\n";
+        output += algo::format(
+            "        \"%s\": %s",
+            escape_json(kv.first).c_str(),
+            format_json(kv.second).c_str());
+        first = false;
+    }
+    return output + (first ? "}\n}\n" : "\n    }\n}\n");
+}
+
+UnpackingStageTimer::UnpackingStageTimer(
+    const UnpackingStats &stats,
+    const std::string &decoder_name,
+    const UnpackingStage stage) :
+        stats(stats),
+        decoder_name(decoder_name),
+        stage(stage),
+        start(stats.is_enabled()
+            ? std::chrono::steady_clock::now()
+            : std::chrono::steady_clock::time_point())
+{
+}
+
+UnpackingStageTimer::~UnpackingStageTimer()
+{
+    if (!stats.is_enabled())
+        return;
+    stats.add_time(
+        decoder_name,
+        stage,
+        std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count());
+}
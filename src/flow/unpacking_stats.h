@@ -0,0 +1,101 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include "logger.h"
+#include "types.h"
+
+namespace au {
+namespace flow {
+
+    enum class UnpackingStage : u8
+    {
+        Guess,
+        ReadMeta,
+        ReadFile,
+        Decode,
+        Encode,
+        Save,
+    };
+
+    // Time spent in each stage of unpacking and bytes passing through,
+    // broken down by decoder. Stage times are summed across all threads.
+    // Nothing is collected unless enabled.
+    class UnpackingStats final
+    {
+    public:
+        UnpackingStats(const bool enabled);
+        ~UnpackingStats();
+
+        bool is_enabled() const;
+
+        // Runs the function and attributes its run time to given stage.
+        template<typename F> auto measure(
+            const std::string &decoder_name,
+            const UnpackingStage stage,
+            const F &func) const -> decltype(func());
+
+        void add_time(
+            const std::string &decoder_name,
+            const UnpackingStage stage,
+            const double seconds) const;
+        void add_input_file(
+            const std::string &decoder_name, const uoff_t size) const;
+        void add_output_file(
+            const std::string &decoder_name, const uoff_t size) const;
+        void set_peak_queue_depth(const size_t queue_depth) const;
+        void add_vfs_cache_lookup(const bool hit) const;
+
+        void print_summary(const Logger &logger) const;
+        std::string to_json() const;
+
+    private:
+        struct Priv;
+        std::unique_ptr<Priv> p;
+    };
+
+    // Attributes the time until it goes out of scope to given stage.
+    class UnpackingStageTimer final
+    {
+    public:
+        UnpackingStageTimer(
+            const UnpackingStats &stats,
+            const std::string &decoder_name,
+            const UnpackingStage stage);
+        ~UnpackingStageTimer();
+
+    private:
+        const UnpackingStats &stats;
+        const std::string &decoder_name;
+        const UnpackingStage stage;
+        const std::chrono::steady_clock::time_point start;
+    };
+
+    template<typename F> auto UnpackingStats::measure(
+        const std::string &decoder_name,
+        const UnpackingStage stage,
+        const F &func) const -> decltype(func())
+    {
+        const UnpackingStageTimer timer(*this, decoder_name, stage);
+        return func();
+    }
+
+} }
@@ -16,10 +16,156 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/vfs_bridge.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 using namespace au;
 using namespace au::flow;
 
+static const uoff_t default_cache_size = 64 * 1024 * 1024;
+
+namespace
+{
+    // Keeps the contents of recently looked up entries so that a sibling
+    // referenced by many files (a palette, a mask, a base image) is decoded
+    // once rather than on every lookup. A single cache with a single budget
+    // is shared by all bridges, so nested archives cannot multiply it.
+    // Least recently used entries are dropped once the total size exceeds
+    // the budget.
+    class MaterializedFileCache final
+    {
+    public:
+        MaterializedFileCache();
+
+        void set_max_size(const uoff_t new_max_size);
+        size_t register_owner();
+        void unregister_owner(const size_t owner);
+
+        std::unique_ptr<io::File> get(
+            const size_t owner, const dec::ArchiveEntry &entry);
+
+        void put(
+            const size_t owner, const dec::ArchiveEntry &entry, io::File &file);
+
+    private:
+        using Key = std::pair<size_t, const dec::ArchiveEntry*>;
+
+        struct Item final
+        {
+            io::path path;
+            bstr data;
+            std::list<Key>::iterator lru_it;
+        };
+
+        using OwnerItems = std::unordered_map<const dec::ArchiveEntry*, Item>;
+
+        void shrink(const uoff_t target_size);
+
+        uoff_t max_size;
+        uoff_t size;
+        size_t last_owner;
+        std::list<Key> lru;
+        std::unordered_map<size_t, OwnerItems> items;
+        std::mutex mutex;
+    };
+}
+
+static MaterializedFileCache &get_cache()
+{
+    static MaterializedFileCache cache;
+    return cache;
+}
+
+MaterializedFileCache::MaterializedFileCache()
+    : max_size(default_cache_size), size(0), last_owner(0)
+{
+}
+
+void MaterializedFileCache::set_max_size(const uoff_t new_max_size)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    max_size = new_max_size;
+    shrink(max_size);
+}
+
+size_t MaterializedFileCache::register_owner()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    items[++last_owner];
+    return last_owner;
+}
+
+void MaterializedFileCache::unregister_owner(const size_t owner)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto owner_it = items.find(owner);
+    if (owner_it == items.end())
+        return;
+    for (const auto &kv : owner_it->second)
+    {
+        size -= kv.second.data.size();
+        lru.erase(kv.second.lru_it);
+    }
+    items.erase(owner_it);
+}
+
+std::unique_ptr<io::File> MaterializedFileCache::get(
+    const size_t owner, const dec::ArchiveEntry &entry)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto owner_it = items.find(owner);
+    if (owner_it == items.end())
+        return nullptr;
+    const auto it = owner_it->second.find(&entry);
+    if (it == owner_it->second.end())
+        return nullptr;
+    lru.splice(lru.begin(), lru, it->second.lru_it);
+    return std::make_unique<io::File>(it->second.path, it->second.data);
+}
+
+void MaterializedFileCache::put(
+    const size_t owner, const dec::ArchiveEntry &entry, io::File &file)
+{
+    const auto file_size = file.stream.size();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (file_size > max_size)
+            return;
+    }
+    const auto pos = file.stream.pos();
+    const auto data = file.stream.seek(0).read_to_eof();
+    file.stream.seek(pos);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // The owner is gone if its bridge was destroyed while the factory that
+    // produced this file was still running.
+    const auto owner_it = items.find(owner);
+    if (owner_it == items.end())
+        return;
+    if (file_size > max_size)
+        return;
+    if (owner_it->second.find(&entry) != owner_it->second.end())
+        return;
+    shrink(max_size - file_size);
+    lru.push_front(Key(owner, &entry));
+    owner_it->second[&entry] = {file.path, data, lru.begin()};
+    size += file_size;
+}
+
+void MaterializedFileCache::shrink(const uoff_t target_size)
+{
+    while (size > target_size)
+    {
+        const auto key = lru.back();
+        auto &owner_items = items.at(key.first);
+        const auto it = owner_items.find(key.second);
+        size -= it->second.data.size();
+        owner_items.erase(it);
+        lru.pop_back();
+    }
+}
+
 struct VirtualFileSystemBridge::Priv final
 {
     Priv(
@@ -27,21 +173,41 @@ struct VirtualFileSystemBridge::Priv final
         const dec::BaseArchiveDecoder &decoder,
         const std::shared_ptr<dec::ArchiveMeta> meta,
         const std::shared_ptr<io::File> input_file,
-        const io::path &base_name) :
+        const io::path &base_name,
+        const UnpackingStats &stats) :
             logger(logger),
             decoder(decoder),
             meta(meta),
             base_name(base_name),
-            decoder_refcount(decoder.shared_from_this())
+            decoder_refcount(decoder.shared_from_this()),
+            cache_owner(get_cache().register_owner())
     {
+        // The virtual file system runs factories without holding its lock,
+        // so a factory may still be running after the bridge is destroyed.
+        // Everything it touches is therefore owned by the factory itself,
+        // except for the stats, which outlive all tasks of the unpacker.
+        const auto cache_owner = this->cache_owner;
+        const auto decoder_refcount = this->decoder_refcount;
+        const auto decoder_ptr = &decoder;
+        const auto logger_copy = std::make_shared<const Logger>(logger);
         for (const auto &entry : meta->entries)
         {
+            const auto entry_ptr = entry.get();
             VirtualFileSystem::register_file(
                 get_target_name(entry->path),
-                [&logger, input_file, meta, &entry, &decoder]()
+                [logger_copy, input_file, meta, entry_ptr, decoder_refcount,
+                    decoder_ptr, &stats, cache_owner]()
                 {
+                    auto output_file = get_cache().get(cache_owner, *entry_ptr);
+                    stats.add_vfs_cache_lookup(output_file != nullptr);
+                    if (output_file)
+                        return output_file;
                     io::File file_copy(*input_file);
-                    return decoder.read_file(logger, file_copy, *meta, *entry);
+                    output_file = decoder_ptr->read_file(
+                        *logger_copy, file_copy, *meta, *entry_ptr);
+                    if (output_file)
+                        get_cache().put(cache_owner, *entry_ptr, *output_file);
+                    return output_file;
                 });
         }
     }
@@ -53,6 +219,7 @@ struct VirtualFileSystemBridge::Priv final
             VirtualFileSystem::unregister_file(
                 get_target_name(entry->path));
         }
+        get_cache().unregister_owner(cache_owner);
     }
 
     io::path get_target_name(const io::path &input_path) const
@@ -70,6 +237,9 @@ struct VirtualFileSystemBridge::Priv final
     // the need to downcast to shared_ptr<BaseArchiveDecoder>.
     // TODO: probably not needed after we get long-lived task chains
     const std::shared_ptr<const dec::IDecoder> decoder_refcount;
+
+    // Identifies the files of this bridge in the shared cache.
+    const size_t cache_owner;
 };
 
 VirtualFileSystemBridge::VirtualFileSystemBridge(
@@ -77,11 +247,22 @@ VirtualFileSystemBridge::VirtualFileSystemBridge(
     const dec::BaseArchiveDecoder &decoder,
     const std::shared_ptr<dec::ArchiveMeta> meta,
     const std::shared_ptr<io::File> input_file,
-    const io::path &base_name)
-    : p(new Priv(logger, decoder, meta, input_file, base_name))
+    const io::path &base_name,
+    const UnpackingStats &stats) :
+        p(new Priv(logger, decoder, meta, input_file, base_name, stats))
 {
 }
 
 VirtualFileSystemBridge::~VirtualFileSystemBridge()
 {
 }
+
+void VirtualFileSystemBridge::set_cache_size(const uoff_t cache_size)
+{
+    get_cache().set_max_size(cache_size);
+}
+
+void VirtualFileSystemBridge::reset_cache_size()
+{
+    get_cache().set_max_size(default_cache_size);
+}
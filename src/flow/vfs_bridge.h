@@ -18,6 +18,7 @@
 #pragma once
 
 #include "dec/base_archive_decoder.h"
+#include "flow/unpacking_stats.h"
 #include "logger.h"
 #include "virtual_file_system.h"
 
@@ -25,7 +26,9 @@ namespace au {
 namespace flow {
 
     // A RAII based VirtualFileSystem registerer that cleans up after itself
-    // when the files are no longer needed.
+    // when the files are no longer needed. Files read through it are kept in
+    // a cache until the bridge goes away. The cache is shared by all bridges
+    // and holds 64 MiB unless configured otherwise.
     class VirtualFileSystemBridge final
     {
     public:
@@ -34,10 +37,14 @@ namespace flow {
             const dec::BaseArchiveDecoder &decoder,
             const std::shared_ptr<dec::ArchiveMeta> meta,
             const std::shared_ptr<io::File> input_file,
-            const io::path &base_name);
+            const io::path &base_name,
+            const UnpackingStats &stats);
 
         ~VirtualFileSystemBridge();
 
+        static void set_cache_size(const uoff_t cache_size);
+        static void reset_cache_size();
+
     private:
         struct Priv;
         std::unique_ptr<Priv> p;
@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/base_bit_stream.h"
+#include <algorithm>
 #include "err.h"
 #include "io/memory_byte_stream.h"
 
@@ -29,7 +30,10 @@ BaseBitStream::BaseBitStream(const bstr &input) :
     bits_available(0),
     position(0),
     own_stream_holder(new MemoryByteStream(input)),
-    input_stream(own_stream_holder.get())
+    input_stream(own_stream_holder.get()),
+    input_data(own_stream_holder->contiguous_data()),
+    input_data_size(input.size()),
+    input_data_pos(0)
 {
 }
 
@@ -37,7 +41,10 @@ BaseBitStream::BaseBitStream(io::BaseByteStream &input_stream) :
     buffer(0),
     bits_available(0),
     position(0),
-    input_stream(&input_stream)
+    input_stream(&input_stream),
+    input_data(nullptr),
+    input_data_size(0),
+    input_data_pos(0)
 {
 }
 
@@ -49,6 +56,7 @@ BaseStream &BaseBitStream::seek(const uoff_t new_pos)
     bits_available = 0;
     buffer = 0;
     input_stream->seek(position / 8);
+    input_data_pos = position / 8;
     read(new_pos % 32);
     return *this;
 }
@@ -58,6 +66,22 @@ BaseStream &BaseBitStream::resize(const uoff_t new_size)
     throw err::NotSupportedError("Not implemented");
 }
 
+BaseStream &BaseBitStream::skip(const soff_t offset)
+{
+    if (offset < 0)
+        return BaseStream::skip(offset);
+    if (static_cast<uoff_t>(offset) > left())
+        throw err::EofError();
+    auto bits_left = static_cast<uoff_t>(offset);
+    while (bits_left)
+    {
+        const auto bits = std::min<uoff_t>(bits_left, 32);
+        read(bits);
+        bits_left -= bits;
+    }
+    return *this;
+}
+
 uoff_t BaseBitStream::pos() const
 {
     return position;
@@ -83,6 +107,11 @@ u32 BaseBitStream::read_gamma(const bool stop_mark)
     return value;
 }
 
+u32 BaseBitStream::peek(const size_t bits)
+{
+    throw err::NotSupportedError("Not implemented");
+}
+
 void BaseBitStream::flush()
 {
 }
@@ -36,8 +36,11 @@ namespace io {
         BaseStream &seek(const uoff_t offset) override;
         BaseStream &resize(const uoff_t new_size) override;
 
+        BaseStream &skip(const soff_t offset) override;
+
         u32 read_gamma(const bool stop_mark);
         virtual u32 read(const size_t n) = 0;
+        virtual u32 peek(const size_t n);
         virtual void flush();
         virtual void write(const size_t bits, const u32 value);
 
@@ -47,6 +50,13 @@ namespace io {
         size_t position;
         std::unique_ptr<io::BaseByteStream> own_stream_holder;
         io::BaseByteStream *input_stream;
+
+        // Set when the bits come from a buffer nobody else reads from, in
+        // which case subclasses can refill whole words straight from memory
+        // instead of calling input_stream for every byte.
+        const u8 *input_data;
+        size_t input_data_size;
+        size_t input_data_pos;
     };
 
 } }
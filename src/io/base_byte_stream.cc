@@ -16,12 +16,31 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/base_byte_stream.h"
+#include <cstdint>
 #include "algo/endian.h"
 #include "algo/range.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::io;
 
+static thread_local bool read_size_check_enabled = false;
+
+ReadSizeCheck::ReadSizeCheck() : was_enabled(read_size_check_enabled)
+{
+    read_size_check_enabled = true;
+}
+
+ReadSizeCheck::~ReadSizeCheck()
+{
+    read_size_check_enabled = was_enabled;
+}
+
+bool ReadSizeCheck::enabled()
+{
+    return read_size_check_enabled;
+}
+
 BaseByteStream::~BaseByteStream() {}
 
 bstr BaseByteStream::read_to_zero()
@@ -65,6 +84,16 @@ bstr BaseByteStream::read_line()
     return output;
 }
 
+static bool shares_data(
+    const io::BaseByteStream &stream1, const io::BaseByteStream &stream2)
+{
+    const auto data1 = reinterpret_cast<uintptr_t>(stream1.contiguous_data());
+    const auto data2 = reinterpret_cast<uintptr_t>(stream2.contiguous_data());
+    if (!data1 || !data2)
+        return false;
+    return data1 < data2 + stream2.size() && data2 < data1 + stream1.size();
+}
+
 BaseByteStream &BaseByteStream::write(io::BaseByteStream &other_stream)
 {
     return write(other_stream, other_stream.left());
@@ -73,12 +102,33 @@ BaseByteStream &BaseByteStream::write(io::BaseByteStream &other_stream)
 BaseByteStream &BaseByteStream::write(
     io::BaseByteStream &other_stream, const size_t size)
 {
-    const auto buffer_size = 16 * 1024;
+    if (!size)
+        return *this;
+
+    const auto source = other_stream.contiguous_data();
+    if (source && &other_stream != this)
+    {
+        const auto offset = other_stream.pos();
+        if (offset + size > other_stream.size())
+            throw err::EofError();
+        // streams sharing one buffer (clones, slices) may reallocate it or
+        // overwrite the source while writing, so copy their data first
+        if (shares_data(*this, other_stream))
+            write_impl(bstr(source + offset, size).get<const u8>(), size);
+        else
+            write_impl(source + offset, size);
+        other_stream.seek(offset + size);
+        return *this;
+    }
+
+    const auto buffer_size = 64 * 1024;
+    bstr buffer(std::min<size_t>(buffer_size, size));
     size_t left = size;
-    for (const auto i : algo::range(0, size, buffer_size))
+    while (left)
     {
         const auto bytes_to_transcribe = std::min<size_t>(buffer_size, left);
-        write(other_stream.read(bytes_to_transcribe));
+        other_stream.read_impl(buffer.get<u8>(), bytes_to_transcribe);
+        write_impl(buffer.get<const u8>(), bytes_to_transcribe);
         left -= bytes_to_transcribe;
     }
     return *this;
@@ -20,12 +20,27 @@
 #include <functional>
 #include <memory>
 #include "algo/endian.h"
+#include "err.h"
 #include "io/base_stream.h"
 #include "types.h"
 
 namespace au {
 namespace io {
 
+    // While alive, reads on the current thread fail before allocating more
+    // bytes than their stream has left. Recognition heuristics often read
+    // garbage sizes, which would otherwise allocate gigabytes just to fail.
+    class ReadSizeCheck final
+    {
+    public:
+        ReadSizeCheck();
+        ~ReadSizeCheck();
+        static bool enabled();
+
+    private:
+        const bool was_enabled;
+    };
+
     class BaseByteStream : public BaseStream
     {
     public:
@@ -59,6 +74,8 @@ namespace io {
         {
             if (!bytes)
                 return ""_b;
+            if (ReadSizeCheck::enabled() && bytes > left())
+                throw err::EofError();
             bstr ret(bytes);
             read_impl(&ret[0], bytes);
             return ret;
@@ -151,6 +168,14 @@ namespace io {
 
         virtual std::unique_ptr<BaseByteStream> clone() const = 0;
 
+        // Streams that keep their whole content in contiguous memory return
+        // a pointer to its first byte so that callers can skip copying. The
+        // pointer is invalidated by writing to or resizing the stream.
+        virtual const u8 *contiguous_data() const
+        {
+            return nullptr;
+        }
+
     protected:
         virtual void read_impl(void *input, const size_t size) = 0;
         virtual void write_impl(const void *str, const size_t size) = 0;
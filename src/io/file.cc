@@ -18,6 +18,7 @@
 #include "io/file.h"
 #include <string>
 #include "io/file_byte_stream.h"
+#include "io/mapped_file_byte_stream.h"
 #include "io/memory_byte_stream.h"
 
 using namespace au;
@@ -51,7 +52,11 @@ File::File(const io::path &path, std::unique_ptr<BaseByteStream> stream) :
 }
 
 File::File(const io::path &path, const FileMode mode) :
-    File(path, std::make_unique<FileByteStream>(path, mode))
+    File(
+        path,
+        mode == FileMode::Read
+            ? open_for_reading(path)
+            : std::make_unique<FileByteStream>(path, mode))
 {
 }
 
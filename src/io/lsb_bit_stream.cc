@@ -16,6 +16,9 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/lsb_bit_stream.h"
+#include <cstring>
+#include "algo/endian.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::io;
@@ -29,14 +32,58 @@ LsbBitStream::LsbBitStream(io::BaseByteStream &input_stream)
 {
 }
 
-u32 LsbBitStream::read(const size_t bits)
+// See MsbBitStream::refill.
+void LsbBitStream::refill(const size_t bits)
 {
-    while (bits_available < bits)
+    if (input_data)
+    {
+        if (input_data_pos + 8 <= input_data_size)
+        {
+            const auto count = (63 - bits_available) >> 3;
+            u64 word;
+            std::memcpy(&word, input_data + input_data_pos, 8);
+            word = algo::from_little_endian<u64>(word);
+            buffer |= (word & ((1ull << (count << 3)) - 1)) << bits_available;
+            bits_available += count << 3;
+            input_data_pos += count;
+            return;
+        }
+        while (bits_available < bits && input_data_pos < input_data_size)
+        {
+            buffer |= static_cast<u64>(input_data[input_data_pos++])
+                << bits_available;
+            bits_available += 8;
+        }
+        return;
+    }
+    while (bits_available < bits && input_stream->left())
     {
         const auto tmp = input_stream->read<u8>();
-        buffer |= tmp << bits_available;
+        buffer |= static_cast<u64>(tmp) << bits_available;
         bits_available += 8;
     }
+}
+
+u32 LsbBitStream::read(const size_t bits)
+{
+    if (bits_available < bits)
+    {
+        if (input_data)
+        {
+            refill(bits);
+            if (bits_available < bits)
+                throw err::EofError();
+        }
+        else
+        {
+            while (bits_available < bits)
+            {
+                const auto tmp = input_stream->read<u8>();
+                buffer |= static_cast<u64>(tmp) << bits_available;
+                bits_available += 8;
+            }
+        }
+    }
     const auto mask = (1ull << bits) - 1;
     const auto value = buffer & mask;
     buffer >>= bits;
@@ -44,3 +91,10 @@ u32 LsbBitStream::read(const size_t bits)
     position += bits;
     return value;
 }
+
+u32 LsbBitStream::peek(const size_t bits)
+{
+    if (bits_available < bits)
+        refill(bits);
+    return buffer & ((1ull << bits) - 1);
+}
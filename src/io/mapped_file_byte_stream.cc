@@ -0,0 +1,206 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "io/mapped_file_byte_stream.h"
+#include <cstring>
+#include "err.h"
+#include "io/file_byte_stream.h"
+
+#if _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace au;
+using namespace au::io;
+
+struct MappedFileByteStream::Mapping final
+{
+    Mapping(const path &path);
+    ~Mapping();
+
+    const u8 *data;
+    uoff_t size;
+};
+
+#if _WIN32
+    MappedFileByteStream::Mapping::Mapping(const path &path)
+        : data(nullptr), size(0)
+    {
+        const auto file = CreateFileW(
+            path.wstr().c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw err::FileNotFoundError("Could not open " + path.str());
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size))
+        {
+            CloseHandle(file);
+            throw err::IoError("Could not read size of " + path.str());
+        }
+        size = file_size.QuadPart;
+        if (!size)
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        const auto mapping = CreateFileMappingW(
+            file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            throw err::IoError("Could not map " + path.str());
+        data = reinterpret_cast<const u8*>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (!data)
+            throw err::IoError("Could not map " + path.str());
+    }
+
+    MappedFileByteStream::Mapping::~Mapping()
+    {
+        if (data)
+            UnmapViewOfFile(data);
+    }
+#else
+    MappedFileByteStream::Mapping::Mapping(const path &path)
+        : data(nullptr), size(0)
+    {
+        const auto fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw err::FileNotFoundError("Could not open " + path.str());
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw err::IoError("Could not read size of " + path.str());
+        }
+        size = st.st_size;
+        if (!size || static_cast<uoff_t>(static_cast<size_t>(size)) != size)
+        {
+            close(fd);
+            if (size)
+                throw err::IoError("File too big to be mapped");
+            return;
+        }
+
+        const auto ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED)
+            throw err::IoError("Could not map " + path.str());
+        data = reinterpret_cast<const u8*>(ptr);
+    }
+
+    MappedFileByteStream::Mapping::~Mapping()
+    {
+        if (data)
+            munmap(const_cast<u8*>(data), size);
+    }
+#endif
+
+MappedFileByteStream::MappedFileByteStream(const path &path)
+    : MappedFileByteStream(std::make_shared<const Mapping>(path))
+{
+}
+
+MappedFileByteStream::MappedFileByteStream(
+    const std::shared_ptr<const Mapping> mapping)
+        : mapping(mapping), mapping_pos(0)
+{
+}
+
+MappedFileByteStream::~MappedFileByteStream()
+{
+}
+
+void MappedFileByteStream::seek_impl(const uoff_t offset)
+{
+    if (offset > mapping->size)
+        throw err::EofError();
+    mapping_pos = offset;
+}
+
+void MappedFileByteStream::read_impl(void *destination, const size_t size)
+{
+    // destination MUST exist and size MUST be at least 1
+    if (mapping_pos + size > mapping->size)
+        throw err::EofError();
+    std::memcpy(destination, mapping->data + mapping_pos, size);
+    mapping_pos += size;
+}
+
+void MappedFileByteStream::write_impl(const void *source, const size_t size)
+{
+    throw err::NotSupportedError("Mapped files are read-only");
+}
+
+uoff_t MappedFileByteStream::pos() const
+{
+    return mapping_pos;
+}
+
+uoff_t MappedFileByteStream::size() const
+{
+    return mapping->size;
+}
+
+void MappedFileByteStream::resize_impl(const uoff_t new_size)
+{
+    if (new_size == size())
+        return;
+    throw err::NotSupportedError("Mapped files are read-only");
+}
+
+std::unique_ptr<io::BaseByteStream> MappedFileByteStream::clone() const
+{
+    auto ret = std::unique_ptr<MappedFileByteStream>(
+        new MappedFileByteStream(mapping));
+    ret->mapping_pos = mapping_pos;
+    return std::move(ret);
+}
+
+const u8 *MappedFileByteStream::contiguous_data() const
+{
+    return mapping->data;
+}
+
+std::unique_ptr<io::BaseByteStream> io::open_for_reading(const path &path)
+{
+    try
+    {
+        return std::make_unique<MappedFileByteStream>(path);
+    }
+    catch (const err::FileNotFoundError &)
+    {
+        throw;
+    }
+    catch (const err::IoError &)
+    {
+        return std::make_unique<FileByteStream>(path, FileMode::Read);
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include "io/base_byte_stream.h"
+#include "io/path.h"
+
+namespace au {
+namespace io {
+
+    // Read-only stream over a memory mapped file. Clones share the mapping
+    // and only keep their own position, so reading the same archive from
+    // many threads doesn't need a file handle and stdio buffer per reader.
+    class MappedFileByteStream final : public BaseByteStream
+    {
+    public:
+        MappedFileByteStream(const path &path);
+        ~MappedFileByteStream();
+
+        uoff_t size() const override;
+        uoff_t pos() const override;
+
+        std::unique_ptr<BaseByteStream> clone() const override;
+        const u8 *contiguous_data() const override;
+
+    protected:
+        void read_impl(void *destination, const size_t size) override;
+        void write_impl(const void *source, const size_t size) override;
+        void seek_impl(const uoff_t offset) override;
+        void resize_impl(const uoff_t new_size) override;
+
+    private:
+        struct Mapping;
+        MappedFileByteStream(const std::shared_ptr<const Mapping> mapping);
+
+        std::shared_ptr<const Mapping> mapping;
+        uoff_t mapping_pos;
+    };
+
+    // Maps the file if the platform allows it, otherwise falls back to
+    // regular FileByteStream.
+    std::unique_ptr<BaseByteStream> open_for_reading(const path &path);
+
+} }
@@ -114,3 +114,8 @@ std::unique_ptr<io::BaseByteStream> MemoryByteStream::clone() const
     ret->seek(pos());
     return std::move(ret);
 }
+
+const u8 *MemoryByteStream::contiguous_data() const
+{
+    return buffer->empty() ? nullptr : buffer->get<const u8>();
+}
@@ -41,6 +41,7 @@ namespace io {
         BaseByteStream &reserve(const uoff_t count);
 
         std::unique_ptr<BaseByteStream> clone() const override;
+        const u8 *contiguous_data() const override;
 
     protected:
         void read_impl(void *destination, const size_t size) override;
@@ -16,6 +16,9 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "io/msb_bit_stream.h"
+#include <cstring>
+#include "algo/endian.h"
+#include "err.h"
 
 using namespace au;
 using namespace au::io;
@@ -44,22 +47,91 @@ void MsbBitStream::flush()
     }
 }
 
-u32 MsbBitStream::read(const size_t bits)
+// Loads whole bytes until the buffer holds the requested number of bits or
+// the input runs out. Owned buffers are refilled a word at a time, while
+// borrowed streams are read byte by byte so that their position stays right
+// after the last byte needed.
+void MsbBitStream::refill(const size_t bits)
 {
-    while (bits_available < bits)
+    if (input_data)
+    {
+        if (input_data_pos + 8 <= input_data_size)
+        {
+            const auto count = (63 - bits_available) >> 3;
+            u64 word;
+            std::memcpy(&word, input_data + input_data_pos, 8);
+            word = algo::from_big_endian<u64>(word);
+            buffer = (buffer << (count << 3)) | (word >> (64 - (count << 3)));
+            bits_available += count << 3;
+            input_data_pos += count;
+            return;
+        }
+        while (bits_available < bits && input_data_pos < input_data_size)
+        {
+            buffer = (buffer << 8) | input_data[input_data_pos++];
+            bits_available += 8;
+        }
+        return;
+    }
+    while (bits_available < bits && input_stream->left())
     {
         const auto tmp = input_stream->read<u8>();
         buffer = (buffer << 8) | tmp;
         bits_available += 8;
     }
+}
+
+u32 MsbBitStream::read(const size_t bits)
+{
+    if (bits_available < bits)
+    {
+        if (input_data)
+        {
+            refill(bits);
+            if (bits_available < bits)
+                throw err::EofError();
+        }
+        else
+        {
+            while (bits_available < bits)
+            {
+                const auto tmp = input_stream->read<u8>();
+                buffer = (buffer << 8) | tmp;
+                bits_available += 8;
+            }
+        }
+    }
     const auto mask = (1ull << bits) - 1;
     bits_available -= bits;
     position += bits;
     return (buffer >> bits_available) & mask;
 }
 
+u32 MsbBitStream::peek(const size_t bits)
+{
+    if (bits_available < bits)
+        refill(bits);
+    const auto mask = (1ull << bits) - 1;
+    if (bits_available < bits)
+        return (buffer << (bits - bits_available)) & mask;
+    return (buffer >> (bits_available - bits)) & mask;
+}
+
 void MsbBitStream::write(const size_t bits, const u32 value)
 {
+    if (input_data)
+    {
+        // word refills load bytes ahead of what was read - give back the
+        // whole unread bytes so that writing continues right after the last
+        // byte the reads used, just like with borrowed streams
+        const auto unread_bytes = bits_available / 8;
+        bits_available %= 8;
+        buffer >>= unread_bytes * 8;
+        input_data_pos -= unread_bytes;
+        input_stream->seek(input_data_pos);
+        // writes may reallocate the buffer
+        input_data = nullptr;
+    }
     const auto mask = (1ull << bits) - 1;
     buffer <<= bits;
     buffer |= value & mask;
@@ -30,9 +30,12 @@ namespace io {
         MsbBitStream(io::BaseByteStream &input_stream);
         ~MsbBitStream();
         u32 read(const size_t bits) override;
+        u32 peek(const size_t bits) override;
         void flush() override;
         void write(const size_t bits, const u32 value) override;
     private:
+        void refill(const size_t bits);
+
         bool dirty;
     };
 
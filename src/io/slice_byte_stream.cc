@@ -36,8 +36,12 @@ SliceByteStream::SliceByteStream(
         slice_offset(slice_offset),
         slice_size(slice_size)
 {
-    if (slice_size > parent_stream.size() - slice_offset)
+    if (slice_offset > parent_stream.size()
+        || slice_size > parent_stream.size() - slice_offset)
+    {
         throw err::BadDataSizeError();
+    }
+    this->parent_stream->seek(slice_offset);
 }
 
 SliceByteStream::~SliceByteStream()
@@ -46,13 +50,25 @@ SliceByteStream::~SliceByteStream()
 
 void SliceByteStream::seek_impl(const uoff_t offset)
 {
+    if (offset > slice_size)
+        throw err::EofError();
     parent_stream->seek(slice_offset + offset);
 }
 
 void SliceByteStream::read_impl(void *destination, const size_t size)
 {
-    const auto chunk = parent_stream->read(size);
-    std::memcpy(destination, chunk.get<u8>(), size);
+    const auto parent_pos = parent_stream->pos();
+    if (parent_pos + size > slice_offset + slice_size)
+        throw err::EofError();
+    const auto parent_data = parent_stream->contiguous_data();
+    if (!parent_data)
+    {
+        const auto chunk = parent_stream->read(size);
+        std::memcpy(destination, chunk.get<u8>(), size);
+        return;
+    }
+    std::memcpy(destination, parent_data + parent_pos, size);
+    parent_stream->seek(parent_pos + size);
 }
 
 void SliceByteStream::write_impl(const void *source, const size_t size)
@@ -82,3 +98,9 @@ std::unique_ptr<io::BaseByteStream> SliceByteStream::clone() const
     ret->seek(pos());
     return std::move(ret);
 }
+
+const u8 *SliceByteStream::contiguous_data() const
+{
+    const auto parent_data = parent_stream->contiguous_data();
+    return parent_data ? parent_data + slice_offset : nullptr;
+}
@@ -37,6 +37,7 @@ namespace io {
         uoff_t size() const override;
         uoff_t pos() const override;
         std::unique_ptr<BaseByteStream> clone() const override;
+        const u8 *contiguous_data() const override;
 
     protected:
         void read_impl(void *destination, const size_t size) override;
@@ -64,10 +64,26 @@ Image::Image(
     const size_t width,
     const size_t height,
     const bstr &input,
-    const Palette &palette)
-        : Image(width, height, input, PixelFormat::Gray8)
+    const Palette &palette) : Image(width, height)
 {
-    apply_palette(palette);
+    if (input.size() < width * height)
+        throw err::BadDataSizeError();
+    if (!width || !height)
+        throw err::BadDataSizeError();
+
+    // same as reading Gray8 and applying the palette: indices past its end
+    // become transparent gray
+    Pixel colors[256];
+    for (const auto i : algo::range(256))
+    {
+        const auto index = static_cast<u8>(i);
+        colors[i] = i < static_cast<int>(palette.size())
+            ? palette[i]
+            : Pixel {index, index, index, 0};
+    }
+    const auto *input_ptr = input.get<const u8>();
+    for (auto &c : content)
+        c = colors[*input_ptr++];
 }
 
 Image::Image(
@@ -75,9 +91,8 @@ Image::Image(
     const size_t height,
     io::BaseByteStream &input_stream,
     const Palette &palette)
-        : Image(width, height, input_stream, PixelFormat::Gray8)
+        : Image(width, height, input_stream.read(width * height), palette)
 {
-    apply_palette(palette);
 }
 
 Image &Image::invert()
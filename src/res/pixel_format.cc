@@ -19,6 +19,9 @@
 #include <cstring>
 #include "algo/format.h"
 #include "algo/range.h"
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
 
 namespace au {
 namespace res {
@@ -255,47 +258,289 @@ namespace res {
         return c;
     }
 
-    void read_pixels(
-        const u8 *input_ptr, std::vector<Pixel> &output, const PixelFormat fmt)
+} }
+
+using namespace au;
+using namespace au::res;
+
+namespace
+{
+    using PixelReader = void (*)(const u8 *, Pixel *, const size_t);
+
+    // Where 16-bit formats keep their channels, in B, G, R, A order.
+    // Positive shifts go left. Formats with a single alpha bit stretch it to
+    // the whole byte.
+    struct Layout16 final
     {
-        // save those precious CPU cycles
-        if (fmt == PixelFormat::BGRA8888)
+        u16 masks[4];
+        int shifts[4];
+        bool alpha_bit;
+        u8 alpha_xor;
+    };
+}
+
+static constexpr Layout16 layout_bgr555x =
+    {{0x001F, 0x03E0, 0x7C00, 0}, {3, -2, -7, 0}, false, 0xFF};
+static constexpr Layout16 layout_bgr565 =
+    {{0x001F, 0x07E0, 0xF800, 0}, {3, -3, -8, 0}, false, 0xFF};
+static constexpr Layout16 layout_bgra4444 =
+    {{0x000F, 0x00F0, 0x0F00, 0xF000}, {4, 0, -4, -8}, false, 0};
+static constexpr Layout16 layout_bgra5551 =
+    {{0x001F, 0x03E0, 0x7C00, 0}, {3, -2, -7, 0}, true, 0};
+static constexpr Layout16 layout_bgrna4444 =
+    {{0x000F, 0x00F0, 0x0F00, 0xF000}, {4, 0, -4, -8}, false, 0xFF};
+static constexpr Layout16 layout_bgrna5551 =
+    {{0x001F, 0x03E0, 0x7C00, 0}, {3, -2, -7, 0}, true, 0xFF};
+static constexpr Layout16 layout_rgb555x =
+    {{0x7C00, 0x03E0, 0x001F, 0}, {-7, -2, 3, 0}, false, 0xFF};
+static constexpr Layout16 layout_rgb565 =
+    {{0xF800, 0x07E0, 0x001F, 0}, {-8, -3, 3, 0}, false, 0xFF};
+static constexpr Layout16 layout_rgba4444 =
+    {{0x0F00, 0x00F0, 0x000F, 0xF000}, {-4, 0, 4, -8}, false, 0};
+static constexpr Layout16 layout_rgba5551 =
+    {{0x7C00, 0x03E0, 0x001F, 0}, {-7, -2, 3, 0}, true, 0};
+static constexpr Layout16 layout_rgbna4444 =
+    {{0x0F00, 0x00F0, 0x000F, 0xF000}, {-4, 0, 4, -8}, false, 0xFF};
+static constexpr Layout16 layout_rgbna5551 =
+    {{0x7C00, 0x03E0, 0x001F, 0}, {-7, -2, 3, 0}, true, 0xFF};
+
+static inline u32 load_u32(const u8 *ptr)
+{
+    u32 ret;
+    std::memcpy(&ret, ptr, 4);
+    return ret;
+}
+
+static inline void store_pixel(Pixel *ptr, const u32 value)
+{
+    std::memcpy(ptr, &value, 4);
+}
+
+static inline u32 swap_red_and_blue(const u32 value)
+{
+    return (value & 0xFF00FF00)
+        | ((value >> 16) & 0xFF)
+        | ((value & 0xFF) << 16);
+}
+
+#if __SSE2__
+static inline __m128i swap_red_and_blue(const __m128i value)
+{
+    return _mm_or_si128(
+        _mm_and_si128(value, _mm_set1_epi32(0xFF00FF00)),
+        _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(value, 16), _mm_set1_epi32(0xFF)),
+            _mm_and_si128(
+                _mm_slli_epi32(value, 16), _mm_set1_epi32(0xFF0000))));
+}
+
+static inline __m128i extract_channel(
+    const __m128i value, const u16 mask, const int shift)
+{
+    const auto masked = _mm_and_si128(value, _mm_set1_epi16(mask));
+    return shift >= 0
+        ? _mm_sll_epi16(masked, _mm_cvtsi32_si128(shift))
+        : _mm_srl_epi16(masked, _mm_cvtsi32_si128(-shift));
+}
+#endif
+
+template<PixelFormat fmt> static void read_tail(
+    const u8 *input_ptr,
+    Pixel *output_ptr,
+    const size_t start,
+    const size_t count)
+{
+    input_ptr += start * pixel_format_to_bpp(fmt);
+    for (const auto i : algo::range(start, count))
+        output_ptr[i] = read_pixel<fmt>(input_ptr);
+}
+
+static void read_pixels_gray8(
+    const u8 *input_ptr, Pixel *output_ptr, const size_t count)
+{
+    size_t i = 0;
+#if __SSE2__
+    const auto alpha = _mm_set1_epi8(-1);
+    for (; i + 16 <= count; i += 16)
+    {
+        const auto gray = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input_ptr + i));
+        const auto gray_gray_lo = _mm_unpacklo_epi8(gray, gray);
+        const auto gray_gray_hi = _mm_unpackhi_epi8(gray, gray);
+        const auto gray_alpha_lo = _mm_unpacklo_epi8(gray, alpha);
+        const auto gray_alpha_hi = _mm_unpackhi_epi8(gray, alpha);
+        const auto output = reinterpret_cast<__m128i*>(output_ptr + i);
+        _mm_storeu_si128(
+            output + 0, _mm_unpacklo_epi16(gray_gray_lo, gray_alpha_lo));
+        _mm_storeu_si128(
+            output + 1, _mm_unpackhi_epi16(gray_gray_lo, gray_alpha_lo));
+        _mm_storeu_si128(
+            output + 2, _mm_unpacklo_epi16(gray_gray_hi, gray_alpha_hi));
+        _mm_storeu_si128(
+            output + 3, _mm_unpackhi_epi16(gray_gray_hi, gray_alpha_hi));
+    }
+#endif
+    read_tail<PixelFormat::Gray8>(input_ptr, output_ptr, i, count);
+}
+
+// Four pixels come from three words, with no need for byte shuffles.
+template<PixelFormat fmt, bool swap> static void read_pixels_24(
+    const u8 *input_ptr, Pixel *output_ptr, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto word0 = load_u32(input_ptr + i * 3);
+        const auto word1 = load_u32(input_ptr + i * 3 + 4);
+        const auto word2 = load_u32(input_ptr + i * 3 + 8);
+        u32 pixels[4] =
+        {
+            word0,
+            (word0 >> 24) | (word1 << 8),
+            (word1 >> 16) | (word2 << 16),
+            word2 >> 8,
+        };
+        for (const auto j : algo::range(4))
         {
-            std::memcpy(output.data(), input_ptr, output.size() * 4);
-            return;
+            const auto pixel = swap ? swap_red_and_blue(pixels[j]) : pixels[j];
+            store_pixel(output_ptr + i + j, pixel | 0xFF000000);
         }
+    }
+    read_tail<fmt>(input_ptr, output_ptr, i, count);
+}
 
-        // I don't think there is a better alternative to this
-        using PF = PixelFormat;
-        std::function<void(const u8 *, std::vector<Pixel> &)> impl;
-        switch (fmt)
+template<PixelFormat fmt, bool swap, u32 or_mask, u32 xor_mask>
+    static void read_pixels_32(
+        const u8 *input_ptr, Pixel *output_ptr, const size_t count)
+{
+    size_t i = 0;
+#if __SSE2__
+    const auto or_vector = _mm_set1_epi32(or_mask);
+    const auto xor_vector = _mm_set1_epi32(xor_mask);
+    for (; i + 4 <= count; i += 4)
+    {
+        auto pixels = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input_ptr + i * 4));
+        if (swap)
+            pixels = swap_red_and_blue(pixels);
+        pixels = _mm_xor_si128(_mm_or_si128(pixels, or_vector), xor_vector);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output_ptr + i), pixels);
+    }
+#else
+    for (; i < count; i++)
+    {
+        auto pixel = load_u32(input_ptr + i * 4);
+        if (swap)
+            pixel = swap_red_and_blue(pixel);
+        store_pixel(output_ptr + i, (pixel | or_mask) ^ xor_mask);
+    }
+#endif
+    read_tail<fmt>(input_ptr, output_ptr, i, count);
+}
+
+template<PixelFormat fmt, const Layout16 &layout>
+    static void read_pixels_16(
+        const u8 *input_ptr, Pixel *output_ptr, const size_t count)
+{
+    size_t i = 0;
+#if __SSE2__
+    const auto alpha_xor = _mm_set1_epi16(layout.alpha_xor);
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto input = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input_ptr + i * 2));
+        __m128i channels[4];
+        for (const auto j : algo::range(3))
         {
-            case PF::Gray8:     impl = read_pixels<PF::Gray8>; break;
-            case PF::BGR555X:   impl = read_pixels<PF::BGR555X>; break;
-            case PF::BGR565:    impl = read_pixels<PF::BGR565>; break;
-            case PF::BGR888:    impl = read_pixels<PF::BGR888>; break;
-            case PF::BGR888X:   impl = read_pixels<PF::BGR888X>; break;
-            case PF::BGRA4444:  impl = read_pixels<PF::BGRA4444>; break;
-            case PF::BGRA5551:  impl = read_pixels<PF::BGRA5551>; break;
-            case PF::BGRA8888:  impl = read_pixels<PF::BGRA8888>; break;
-            case PF::BGRnA4444: impl = read_pixels<PF::BGRnA4444>; break;
-            case PF::BGRnA5551: impl = read_pixels<PF::BGRnA5551>; break;
-            case PF::BGRnA8888: impl = read_pixels<PF::BGRnA8888>; break;
-            case PF::RGB555X:   impl = read_pixels<PF::RGB555X>; break;
-            case PF::RGB565:    impl = read_pixels<PF::RGB565>; break;
-            case PF::RGB888:    impl = read_pixels<PF::RGB888>; break;
-            case PF::RGB888X:   impl = read_pixels<PF::RGB888X>; break;
-            case PF::RGBA4444:  impl = read_pixels<PF::RGBA4444>; break;
-            case PF::RGBA5551:  impl = read_pixels<PF::RGBA5551>; break;
-            case PF::RGBA8888:  impl = read_pixels<PF::RGBA8888>; break;
-            case PF::RGBnA4444: impl = read_pixels<PF::RGBnA4444>; break;
-            case PF::RGBnA5551: impl = read_pixels<PF::RGBnA5551>; break;
-            case PF::RGBnA8888: impl = read_pixels<PF::RGBnA8888>; break;
-            default:
-                throw std::logic_error(
-                    algo::format("Unsupported pixel format: %d", fmt));
+            channels[j] = extract_channel(
+                input, layout.masks[j], layout.shifts[j]);
         }
-        impl(input_ptr, output);
+        channels[3] = layout.alpha_bit
+            ? _mm_and_si128(_mm_srai_epi16(input, 15), _mm_set1_epi16(0xFF))
+            : extract_channel(input, layout.masks[3], layout.shifts[3]);
+        channels[3] = _mm_xor_si128(channels[3], alpha_xor);
+
+        const auto blue_green
+            = _mm_or_si128(channels[0], _mm_slli_epi16(channels[1], 8));
+        const auto red_alpha
+            = _mm_or_si128(channels[2], _mm_slli_epi16(channels[3], 8));
+        const auto output = reinterpret_cast<__m128i*>(output_ptr + i);
+        _mm_storeu_si128(
+            output + 0, _mm_unpacklo_epi16(blue_green, red_alpha));
+        _mm_storeu_si128(
+            output + 1, _mm_unpackhi_epi16(blue_green, red_alpha));
     }
+#endif
+    read_tail<fmt>(input_ptr, output_ptr, i, count);
+}
 
-} }
+static void read_pixels_copy(
+    const u8 *input_ptr, Pixel *output_ptr, const size_t count)
+{
+    std::memcpy(output_ptr, input_ptr, count * 4);
+}
+
+static PixelReader get_pixel_reader(const PixelFormat fmt)
+{
+    using PF = PixelFormat;
+    static const u32 opaque = 0xFF000000;
+    switch (fmt)
+    {
+        case PF::Gray8:
+            return read_pixels_gray8;
+
+        case PF::BGR555X:   return read_pixels_16<PF::BGR555X, layout_bgr555x>;
+        case PF::BGR565:    return read_pixels_16<PF::BGR565, layout_bgr565>;
+        case PF::BGR888:    return read_pixels_24<PF::BGR888, false>;
+        case PF::BGR888X:
+            return read_pixels_32<PF::BGR888X, false, opaque, 0>;
+        case PF::BGRA4444:
+            return read_pixels_16<PF::BGRA4444, layout_bgra4444>;
+        case PF::BGRA5551:
+            return read_pixels_16<PF::BGRA5551, layout_bgra5551>;
+        case PF::BGRA8888:  return read_pixels_copy;
+        case PF::BGRnA4444:
+            return read_pixels_16<PF::BGRnA4444, layout_bgrna4444>;
+        case PF::BGRnA5551:
+            return read_pixels_16<PF::BGRnA5551, layout_bgrna5551>;
+        case PF::BGRnA8888:
+            return read_pixels_32<PF::BGRnA8888, false, 0, opaque>;
+
+        case PF::RGB555X:   return read_pixels_16<PF::RGB555X, layout_rgb555x>;
+        case PF::RGB565:    return read_pixels_16<PF::RGB565, layout_rgb565>;
+        case PF::RGB888:    return read_pixels_24<PF::RGB888, true>;
+        case PF::RGB888X:
+            return read_pixels_32<PF::RGB888X, true, opaque, 0>;
+        case PF::RGBA4444:
+            return read_pixels_16<PF::RGBA4444, layout_rgba4444>;
+        case PF::RGBA5551:
+            return read_pixels_16<PF::RGBA5551, layout_rgba5551>;
+        case PF::RGBA8888:
+            return read_pixels_32<PF::RGBA8888, true, 0, 0>;
+        case PF::RGBnA4444:
+            return read_pixels_16<PF::RGBnA4444, layout_rgbna4444>;
+        case PF::RGBnA5551:
+            return read_pixels_16<PF::RGBnA5551, layout_rgbna5551>;
+        case PF::RGBnA8888:
+            return read_pixels_32<PF::RGBnA8888, true, 0, opaque>;
+
+        default:
+            throw std::logic_error(
+                algo::format("Unsupported pixel format: %d", fmt));
+    }
+}
+
+void res::read_pixels(
+    const u8 *input_ptr,
+    Pixel *output_ptr,
+    const size_t count,
+    const PixelFormat fmt)
+{
+    get_pixel_reader(fmt)(input_ptr, output_ptr, count);
+}
+
+void res::read_pixels(
+    const u8 *input_ptr, std::vector<Pixel> &output, const PixelFormat fmt)
+{
+    read_pixels(input_ptr, output.data(), output.size(), fmt);
+}
@@ -90,6 +90,13 @@ namespace res {
             c = read_pixel<fmt>(input_ptr);
     }
 
+    // Converts whole rows at once; the common formats have SSE2 kernels.
+    void read_pixels(
+        const u8 *input_ptr,
+        Pixel *output_ptr,
+        const size_t count,
+        const PixelFormat fmt);
+
     void read_pixels(
         const u8 *input_ptr,
         std::vector<Pixel> &output,
@@ -0,0 +1,54 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include "res/audio.h"
+
+namespace au {
+namespace res {
+
+    // Produces the samples of a track in order, one block at a time.
+    class BaseAudioSampleReader
+    {
+    public:
+        virtual ~BaseAudioSampleReader() {}
+
+        // Replaces output with the next block of samples. Returns false
+        // once the track has ended.
+        virtual bool read_block(bstr &output) = 0;
+    };
+
+    // Audio whose samples are decoded on demand rather than held in memory.
+    // The samples of the audio itself are left empty.
+    struct StreamedAudio final
+    {
+        using SampleReaderFactory
+            = std::function<std::unique_ptr<BaseAudioSampleReader>()>;
+
+        Audio audio;
+        uoff_t samples_size;
+
+        // Returns a new reader positioned at the start of the track. May be
+        // called more than once and from different threads.
+        SampleReaderFactory open_samples;
+    };
+
+} }
@@ -19,17 +19,123 @@
 #include <map>
 #include <mutex>
 #include <set>
+#include <unordered_map>
+#include <vector>
 #include "algo/str.h"
-#include "err.h"
 #include "io/file_system.h"
 
 using namespace au;
 
+namespace
+{
+    using Factory = std::function<std::unique_ptr<io::File>()>;
+
+    // Both factories and directory entries are looked up by lowercase name,
+    // stem and path. Factories keep every candidate ordered by path so that
+    // the first match is the same one a linear scan over the map would find;
+    // directory entries keep the first hit in traversal order.
+    using FactoryIndex = std::unordered_map<std::string, std::set<io::path>>;
+    using DirectoryIndex = std::unordered_map<std::string, io::path>;
+
+    struct DirectoryListing final
+    {
+        DirectoryIndex by_name;
+        DirectoryIndex by_stem;
+        DirectoryIndex by_path;
+    };
+}
+
 static std::mutex mutex;
-static std::map<io::path, std::function<std::unique_ptr<io::File>()>> factories;
+static std::map<io::path, Factory> factories;
+static FactoryIndex factories_by_name;
+static FactoryIndex factories_by_stem;
 static std::set<io::path> directories;
+static std::unique_ptr<DirectoryListing> directory_listing;
 static bool enabled = true;
 
+static io::path normalize(const io::path &path)
+{
+    return io::path(algo::lower(path.str()));
+}
+
+static void index_factory(const io::path &path)
+{
+    factories_by_name[path.name()].insert(path);
+    factories_by_stem[path.stem()].insert(path);
+}
+
+static void unindex_factory(FactoryIndex &index, const std::string &key,
+    const io::path &path)
+{
+    const auto it = index.find(key);
+    if (it == index.end())
+        return;
+    it->second.erase(path);
+    if (it->second.empty())
+        index.erase(it);
+}
+
+static Factory find_factory(const FactoryIndex &index, const std::string &key)
+{
+    const auto it = index.find(key);
+    if (it == index.end())
+        return nullptr;
+    return factories.at(*it->second.begin());
+}
+
+// The registered directories are listed once, on the first lookup that
+// needs them, rather than walked recursively on every call.
+static const DirectoryListing &get_directory_listing()
+{
+    if (directory_listing)
+        return *directory_listing;
+    directory_listing = std::make_unique<DirectoryListing>();
+    for (const auto &directory : directories)
+    for (const auto &other_path : io::recursive_directory_range(directory))
+    {
+        const auto check = normalize(other_path);
+        directory_listing->by_name.emplace(check.name(), other_path);
+        directory_listing->by_stem.emplace(check.stem(), other_path);
+        directory_listing->by_path.emplace(check.str(), other_path);
+    }
+    return *directory_listing;
+}
+
+static bool find_in_directories(
+    const DirectoryIndex DirectoryListing::*index,
+    const std::string &key,
+    io::path &result)
+{
+    const auto &listing = get_directory_listing();
+    const auto it = (listing.*index).find(key);
+    if (it == (listing.*index).end())
+        return false;
+    result = it->second;
+    return true;
+}
+
+// Factories usually decode a whole archive entry, so they run after the
+// lock is released; this also lets them perform nested lookups.
+static std::unique_ptr<io::File> get_by_key(
+    const FactoryIndex &factory_index,
+    const DirectoryIndex DirectoryListing::*directory_index,
+    const std::string &key)
+{
+    Factory factory;
+    io::path path;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!enabled)
+            return nullptr;
+        factory = find_factory(factory_index, key);
+        if (!factory && !find_in_directories(directory_index, key, path))
+            return nullptr;
+    }
+    if (factory)
+        return factory();
+    return std::make_unique<io::File>(path, io::FileMode::Read);
+}
+
 void VirtualFileSystem::disable()
 {
     std::unique_lock<std::mutex> lock(mutex);
@@ -44,8 +150,12 @@ void VirtualFileSystem::enable()
 
 void VirtualFileSystem::clear()
 {
+    std::unique_lock<std::mutex> lock(mutex);
     directories.clear();
+    directory_listing.reset();
     factories.clear();
+    factories_by_name.clear();
+    factories_by_stem.clear();
 }
 
 void VirtualFileSystem::register_file(
@@ -53,85 +163,68 @@ void VirtualFileSystem::register_file(
     const std::function<std::unique_ptr<io::File>()> factory)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    if (enabled)
-        factories[io::path(algo::lower(path.str()))] = factory;
+    if (!enabled)
+        return;
+    const auto check = normalize(path);
+    factories[check] = factory;
+    index_factory(check);
 }
 
 void VirtualFileSystem::unregister_file(const io::path &path)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    factories.erase(io::path(algo::lower(path.str())));
+    const auto check = normalize(path);
+    if (!factories.erase(check))
+        return;
+    unindex_factory(factories_by_name, check.name(), check);
+    unindex_factory(factories_by_stem, check.stem(), check);
 }
 
 void VirtualFileSystem::register_directory(const io::path &path)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    if (enabled)
-        directories.insert(path);
+    if (enabled && directories.insert(path).second)
+        directory_listing.reset();
 }
 
 void VirtualFileSystem::unregister_directory(const io::path &path)
 {
     std::unique_lock<std::mutex> lock(mutex);
-    directories.erase(path);
+    if (directories.erase(path))
+        directory_listing.reset();
 }
 
 std::unique_ptr<io::File> VirtualFileSystem::get_by_stem(
     const std::string &stem)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (!enabled)
-        return nullptr;
-
-    const auto check = algo::lower(stem);
-    for (const auto &kv : factories)
-        if (kv.first.stem() == check)
-            return kv.second();
-
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
-        if (algo::lower(other_path.stem()) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
-
-    return nullptr;
+    return get_by_key(
+        factories_by_stem, &DirectoryListing::by_stem, algo::lower(stem));
 }
 
 std::unique_ptr<io::File> VirtualFileSystem::get_by_name(
     const std::string &name)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (!enabled)
-        return nullptr;
-
-    const auto check = algo::lower(name);
-    for (const auto &kv : factories)
-        if (kv.first.name() == check)
-            return kv.second();
-
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
-        if (algo::lower(other_path.name()) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
-
-    return nullptr;
+    return get_by_key(
+        factories_by_name, &DirectoryListing::by_name, algo::lower(name));
 }
 
 std::unique_ptr<io::File> VirtualFileSystem::get_by_path(const io::path &path)
 {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (!enabled)
-        return nullptr;
-
-    const auto check = io::path(algo::lower(path.str()));
-    if (factories.find(check) != factories.end())
-        return factories[check]();
-
-    for (const auto &directory : directories)
-    for (const auto &other_path : io::recursive_directory_range(directory))
+    Factory factory;
+    io::path other_path;
     {
-        if (io::path(algo::lower(other_path.str())) == check)
-            return std::make_unique<io::File>(other_path, io::FileMode::Read);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!enabled)
+            return nullptr;
+        const auto check = normalize(path);
+        const auto it = factories.find(check);
+        if (it != factories.end())
+            factory = it->second;
+        else if (!find_in_directories(
+                &DirectoryListing::by_path, check.str(), other_path))
+            return nullptr;
     }
-
-    return nullptr;
+    if (factory)
+        return factory();
+    return std::make_unique<io::File>(other_path, io::FileMode::Read);
 }
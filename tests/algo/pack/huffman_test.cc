@@ -0,0 +1,364 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "algo/pack/huffman.h"
+#include <algorithm>
+#include <queue>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "err.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::algo::pack;
+
+namespace
+{
+    struct TestCode final
+    {
+        u32 value;
+        size_t length;
+    };
+}
+
+// Builds an optimal prefix code for given symbol weights and returns the
+// code length of every symbol, leaving symbols with zero weight unused.
+static std::vector<u8> get_code_lengths(const std::vector<u64> &weights)
+{
+    using Item = std::pair<u64, size_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    std::vector<size_t> parents(weights.size() * 2, 0);
+    for (const auto i : algo::range(weights.size()))
+        if (weights[i])
+            queue.push({weights[i], i});
+    auto next_node = weights.size();
+    while (queue.size() > 1)
+    {
+        const auto a = queue.top();
+        queue.pop();
+        const auto b = queue.top();
+        queue.pop();
+        parents[a.second] = parents[b.second] = next_node;
+        queue.push({a.first + b.first, next_node++});
+    }
+    std::vector<u8> lengths(weights.size());
+    for (const auto i : algo::range(weights.size()))
+        if (weights[i])
+            for (auto node = i; node != next_node - 1; node = parents[node])
+                lengths[i]++;
+    return lengths;
+}
+
+static std::vector<TestCode> get_canonical_codes(
+    const std::vector<u8> &code_lengths)
+{
+    std::vector<TestCode> codes(code_lengths.size());
+    u32 code = 0;
+    for (const auto length : algo::range(1, 33))
+    {
+        for (const auto symbol : algo::range(code_lengths.size()))
+        {
+            if (code_lengths[symbol] != length)
+                continue;
+            codes[symbol].value = code++;
+            codes[symbol].length = length;
+        }
+        code <<= 1;
+    }
+    return codes;
+}
+
+static void write_tree(
+    io::MsbBitStream &output_stream,
+    const std::vector<TestCode> &codes,
+    const u32 prefix,
+    const size_t depth)
+{
+    for (const auto symbol : algo::range(codes.size()))
+    {
+        if (codes[symbol].length == depth && codes[symbol].value == prefix)
+        {
+            output_stream.write(1, 0);
+            output_stream.write(8, symbol);
+            return;
+        }
+    }
+    output_stream.write(1, 1);
+    write_tree(output_stream, codes, prefix << 1, depth + 1);
+    write_tree(output_stream, codes, (prefix << 1) | 1, depth + 1);
+}
+
+static void write_symbols(
+    io::MsbBitStream &output_stream,
+    const std::vector<TestCode> &codes,
+    const std::vector<u16> &symbols)
+{
+    for (const auto symbol : symbols)
+    {
+        const auto &code = codes.at(symbol);
+        output_stream.write(code.length, code.value);
+    }
+}
+
+static std::vector<u16> get_test_symbols(
+    const std::vector<u64> &weights, const size_t count)
+{
+    u64 total = 0;
+    for (const auto weight : weights)
+        total += weight;
+    std::vector<u16> symbols;
+    u32 seed = 1;
+    while (symbols.size() < count)
+    {
+        seed = seed * 1103515245 + 12345;
+        auto target = ((static_cast<u64>(seed) << 16) ^ (seed >> 8)) % total;
+        for (const auto symbol : algo::range(weights.size()))
+        {
+            if (target < weights[symbol])
+            {
+                symbols.push_back(symbol);
+                break;
+            }
+            target -= weights[symbol];
+        }
+    }
+    return symbols;
+}
+
+static std::vector<u64> get_skewed_weights(const size_t count)
+{
+    // long codes for the rare symbols, short ones for the common symbols
+    std::vector<u64> weights;
+    for (const auto i : algo::range(count))
+        weights.push_back((1ull << (i * 22 / count)) + i % 7);
+    return weights;
+}
+
+// The original bit-by-bit tree walk, kept as a reference.
+static bstr decode_with_tree_walk(
+    const HuffmanTree &huffman_tree,
+    io::MsbBitStream &input_stream,
+    const size_t size)
+{
+    bstr output;
+    output.reserve(size);
+    while (output.size() < size && input_stream.left())
+    {
+        auto byte = huffman_tree.root;
+        while (byte >= 256 && byte <= 511)
+            byte = huffman_tree.nodes[input_stream.read(1)][byte];
+        output += static_cast<const u8>(byte);
+    }
+    return output;
+}
+
+static bstr encode_with_tree(
+    const std::vector<TestCode> &codes, const std::vector<u16> &symbols)
+{
+    io::MemoryByteStream output_stream;
+    {
+        io::MsbBitStream bit_stream(output_stream);
+        write_tree(bit_stream, codes, 0, 0);
+        write_symbols(bit_stream, codes, symbols);
+    }
+    return output_stream.seek(0).read_to_eof();
+}
+
+static bstr encode_symbols(
+    const std::vector<TestCode> &codes, const std::vector<u16> &symbols)
+{
+    io::MemoryByteStream output_stream;
+    {
+        io::MsbBitStream bit_stream(output_stream);
+        write_symbols(bit_stream, codes, symbols);
+    }
+    return output_stream.seek(0).read_to_eof();
+}
+
+TEST_CASE("Huffman decoding", "[algo][pack]")
+{
+    SECTION("Canonical codes")
+    {
+        // example from RFC 1951
+        const std::vector<u8> code_lengths = {3, 3, 3, 3, 3, 2, 4, 4};
+        const auto input = "\x17\x7B"_b; // 00 010 1110 1111 011
+        for (const auto lookup_bits : {1, 3, 10})
+        {
+            const HuffmanDecoder decoder(code_lengths, lookup_bits);
+            io::MsbBitStream input_stream(input);
+            REQUIRE(decoder.decode(input_stream) == 5);
+            REQUIRE(decoder.decode(input_stream) == 0);
+            REQUIRE(decoder.decode(input_stream) == 6);
+            REQUIRE(decoder.decode(input_stream) == 7);
+            REQUIRE(decoder.decode(input_stream) == 1);
+            REQUIRE(input_stream.pos() == 16);
+        }
+    }
+
+    SECTION("Canonical codes with unused symbols and long codes")
+    {
+        auto weights = get_skewed_weights(512);
+        for (const auto i : algo::range(0, weights.size(), 5))
+            weights[i] = 0;
+        const auto code_lengths = get_code_lengths(weights);
+        REQUIRE(*std::max_element(code_lengths.begin(), code_lengths.end())
+            > 12);
+        const auto codes = get_canonical_codes(code_lengths);
+        const auto symbols = get_test_symbols(weights, 5000);
+        const auto input = encode_symbols(codes, symbols);
+        for (const auto lookup_bits : {1, 9, 12})
+        {
+            const HuffmanDecoder decoder(code_lengths, lookup_bits);
+            io::MsbBitStream input_stream(input);
+            for (const auto symbol : symbols)
+                REQUIRE(decoder.decode(input_stream) == symbol);
+        }
+    }
+
+    SECTION("Explicit trees")
+    {
+        const auto weights = get_skewed_weights(256);
+        const auto codes = get_canonical_codes(get_code_lengths(weights));
+        const auto symbols = get_test_symbols(weights, 5000);
+        const auto input = encode_with_tree(codes, symbols);
+        bstr expected;
+        for (const auto symbol : symbols)
+            expected += static_cast<u8>(symbol);
+
+        for (const auto lookup_bits : {1, 9, 12})
+        {
+            io::MsbBitStream input_stream(input);
+            const HuffmanTree tree(input_stream);
+            const HuffmanDecoder decoder(tree, lookup_bits);
+            bstr actual(symbols.size());
+            REQUIRE(decoder.decode(
+                input_stream, actual.get<u8>(), actual.size())
+                    == symbols.size());
+            tests::compare_binary(actual, expected);
+        }
+
+        io::MsbBitStream input_stream(input);
+        const HuffmanTree tree(input_stream);
+        tests::compare_binary(
+            decode_with_tree_walk(tree, input_stream, symbols.size()),
+            expected);
+    }
+
+    SECTION("Decoding stops at the end of input")
+    {
+        // tree: 1 (0 'a') (0 'b'), followed by "abba" and a bit of padding
+        const auto input = "\x98\x4C\x4C"_b;
+        io::MsbBitStream input_stream(input);
+        const HuffmanTree tree(input_stream);
+        const HuffmanDecoder decoder(tree);
+        bstr output(100);
+        const auto size = decoder.decode(
+            input_stream, output.get<u8>(), output.size());
+        REQUIRE(size == 5);
+        tests::compare_binary(output.substr(0, 4), "abba"_b);
+    }
+
+    SECTION("Trees with a single leaf")
+    {
+        const auto input = "\x30\x80"_b; // 0 'a'
+        tests::compare_binary(
+            decode_huffman(HuffmanTree(input), input, 3), "aaa"_b);
+    }
+
+    SECTION("Bad codes")
+    {
+        REQUIRE_THROWS_AS(
+            HuffmanDecoder(std::vector<u8>{1, 1, 1}), err::CorruptDataError);
+        REQUIRE_THROWS_AS(
+            HuffmanDecoder(std::vector<u8>{0, 0}), err::CorruptDataError);
+
+        const HuffmanDecoder decoder(std::vector<u8>{1, 2});
+        io::MsbBitStream input_stream("\xC0"_b); // 11: unassigned
+        REQUIRE_THROWS_AS(decoder.decode(input_stream), err::CorruptDataError);
+    }
+}
+
+TEST_CASE("Huffman decoding throughput", "[.benchmark][algo][pack]")
+{
+    const auto symbol_count = 4 * 1024 * 1024;
+
+    SECTION("Byte symbols from explicit trees")
+    {
+        const auto weights = get_skewed_weights(256);
+        const auto codes = get_canonical_codes(get_code_lengths(weights));
+        const auto symbols = get_test_symbols(weights, symbol_count);
+        const auto input = encode_with_tree(codes, symbols);
+
+        bstr expected;
+        const auto tree_walk_time = tests::measure_seconds([&]()
+        {
+            io::MsbBitStream input_stream(input);
+            const HuffmanTree tree(input_stream);
+            expected = decode_with_tree_walk(tree, input_stream, symbol_count);
+        });
+        tests::report_throughput(
+            "tree walk", symbol_count, "symbols", tree_walk_time);
+
+        for (const auto lookup_bits : {9, 12})
+        {
+            bstr actual(symbol_count);
+            const auto table_time = tests::measure_seconds([&]()
+            {
+                io::MsbBitStream input_stream(input);
+                const HuffmanTree tree(input_stream);
+                HuffmanDecoder(tree, lookup_bits).decode(
+                    input_stream, actual.get<u8>(), actual.size());
+            });
+            REQUIRE(actual == expected);
+            tests::report_throughput(
+                algo::format("%d-bit table", lookup_bits),
+                symbol_count,
+                "symbols",
+                table_time);
+        }
+    }
+
+    SECTION("Canonical codes")
+    {
+        const auto weights = get_skewed_weights(512);
+        const auto code_lengths = get_code_lengths(weights);
+        const auto symbols = get_test_symbols(weights, symbol_count);
+        const auto input = encode_symbols(
+            get_canonical_codes(code_lengths), symbols);
+
+        for (const auto lookup_bits : {1, 9, 12})
+        {
+            size_t checksum = 0;
+            const auto time = tests::measure_seconds([&]()
+            {
+                const HuffmanDecoder decoder(code_lengths, lookup_bits);
+                io::MsbBitStream input_stream(input);
+                for (const auto i : algo::range(symbol_count))
+                    checksum += decoder.decode(input_stream);
+            });
+            REQUIRE(checksum > 0);
+            tests::report_throughput(
+                algo::format("%d-bit table", lookup_bits),
+                symbol_count,
+                "symbols",
+                time);
+        }
+    }
+}
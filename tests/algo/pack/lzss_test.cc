@@ -16,7 +16,11 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/lzss.h"
+#include "algo/format.h"
 #include "algo/range.h"
+#include "err.h"
+#include "io/msb_bit_stream.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 #include "test_support/common.h"
 
@@ -45,6 +49,72 @@ static void test_bytes(const bstr &input, size_t size)
     test_bytes(input, bstr(size, 'a'));
 }
 
+static BitwiseLzssSettings make_settings(
+    const size_t position_bits,
+    const size_t size_bits,
+    const size_t min_match_size,
+    const size_t initial_dictionary_pos)
+{
+    BitwiseLzssSettings settings;
+    settings.position_bits = position_bits;
+    settings.size_bits = size_bits;
+    settings.min_match_size = min_match_size;
+    settings.initial_dictionary_pos = initial_dictionary_pos;
+    return settings;
+}
+
+static bstr get_random_bytes(const size_t size, u32 seed)
+{
+    bstr output(size);
+    for (const auto i : algo::range(size))
+    {
+        seed = seed * 1103515245 + 12345;
+        output[i] = seed >> 16;
+    }
+    return output;
+}
+
+// Words drawn from a small vocabulary, so that the encoder finds plenty of
+// matches of all sizes and distances.
+static bstr get_compressible_bytes(const size_t size, u32 seed)
+{
+    static const std::vector<bstr> words = {
+        "lorem "_b, "ipsum "_b, "dolor "_b, "\x00\x00\x00\x00"_b, "a"_b,
+        "sit amet, "_b, "\xFF\xFE"_b, "consectetur "_b, "\n"_b};
+    bstr output;
+    while (output.size() < size)
+    {
+        seed = seed * 1103515245 + 12345;
+        output += words[(seed >> 16) % words.size()];
+    }
+    return output.substr(0, size);
+}
+
+template<typename T> static void compare_with_reference(
+    const bstr &input, const size_t output_size, const T &settings)
+{
+    bstr expected, actual;
+    bool expected_eof = false, actual_eof = false;
+    try
+    {
+        expected = lzss_decompress_reference(input, output_size, settings);
+    }
+    catch (const err::EofError &)
+    {
+        expected_eof = true;
+    }
+    try
+    {
+        actual = lzss_decompress(input, output_size, settings);
+    }
+    catch (const err::EofError &)
+    {
+        actual_eof = true;
+    }
+    REQUIRE(actual_eof == expected_eof);
+    tests::compare_binary(actual, expected);
+}
+
 TEST_CASE("LZSS unpacking", "[algo][pack]")
 {
     SECTION("Bitwise")
@@ -151,3 +221,128 @@ TEST_CASE("LZSS packing", "[algo][pack]")
             input);
     }
 }
+
+TEST_CASE("LZSS unpacking matches the reference", "[algo][pack]")
+{
+    // the first five are specialized, the rest go through the generic path
+    const std::vector<BitwiseLzssSettings> bitwise_settings = {
+        make_settings(13, 4, 3, 1),
+        make_settings(12, 4, 3, 0xFEE),
+        make_settings(12, 4, 2, 1),
+        make_settings(11, 4, 2, 2031),
+        make_settings(8, 4, 2, 239),
+        make_settings(10, 5, 1, 7),
+        make_settings(16, 4, 3, 0),
+        make_settings(4, 2, 1, 3),
+    };
+
+    SECTION("Bitwise")
+    {
+        for (const auto &settings : bitwise_settings)
+        {
+            const auto data = get_compressible_bytes(20000, 1);
+            const auto input = lzss_compress(data, settings);
+            compare_with_reference(input, data.size(), settings);
+            compare_with_reference(input, data.size() / 2, settings);
+            compare_with_reference(input, data.size() + 100, settings);
+            compare_with_reference(
+                input.substr(0, input.size() / 2), data.size(), settings);
+            for (const auto seed : algo::range(1, 20))
+            {
+                compare_with_reference(
+                    get_random_bytes(8000, seed), 10000, settings);
+            }
+        }
+    }
+
+    SECTION("Bitwise from a stream")
+    {
+        for (const auto &settings : bitwise_settings)
+        {
+            const auto input = get_random_bytes(8000, 1);
+            io::MsbBitStream expected_stream(input);
+            io::MsbBitStream actual_stream(input);
+            const auto expected = lzss_decompress_reference(
+                expected_stream, 5000, settings);
+            const auto actual = lzss_decompress(
+                actual_stream, 5000, settings);
+            tests::compare_binary(actual, expected);
+            REQUIRE(actual_stream.pos() == expected_stream.pos());
+        }
+    }
+
+    SECTION("Bytewise")
+    {
+        for (const auto initial_dictionary_pos : {0, 1, 0xFEE, 0xFFF})
+        {
+            BytewiseLzssSettings settings;
+            settings.initial_dictionary_pos = initial_dictionary_pos;
+            const auto data = get_compressible_bytes(20000, 1);
+            const auto input = lzss_compress(data, settings);
+            compare_with_reference(input, data.size(), settings);
+            compare_with_reference(input, data.size() / 2, settings);
+            compare_with_reference(input, data.size() + 100, settings);
+            compare_with_reference(
+                input.substr(0, input.size() / 2), data.size(), settings);
+            for (const auto seed : algo::range(1, 20))
+            {
+                compare_with_reference(
+                    get_random_bytes(8000, seed), 10000, settings);
+            }
+        }
+    }
+}
+
+TEST_CASE("LZSS unpacking throughput", "[.benchmark][algo][pack]")
+{
+    const auto data = get_compressible_bytes(4 * 1024 * 1024, 1);
+
+    const auto run = [&](
+        const std::string &label,
+        const std::function<bstr()> &reference,
+        const std::function<bstr()> &optimized)
+    {
+        bstr expected, actual;
+        const auto reference_time = tests::measure_seconds(
+            [&]() { expected = reference(); });
+        const auto optimized_time = tests::measure_seconds(
+            [&]() { actual = optimized(); });
+        REQUIRE(actual == expected);
+        tests::report_throughput(
+            label + " (reference)", data.size() / 1e6, "MB", reference_time);
+        tests::report_throughput(
+            label, data.size() / 1e6, "MB", optimized_time);
+    };
+
+    SECTION("Bitwise")
+    {
+        for (const auto &settings : {
+            make_settings(13, 4, 3, 1), make_settings(10, 5, 1, 7)})
+        {
+            const auto input = lzss_compress(data, settings);
+            run(
+                algo::format(
+                    "bitwise %d/%d",
+                    settings.position_bits,
+                    settings.size_bits),
+                [&]()
+                {
+                    return lzss_decompress_reference(
+                        input, data.size(), settings);
+                },
+                [&]()
+                {
+                    return lzss_decompress(input, data.size(), settings);
+                });
+        }
+    }
+
+    SECTION("Bytewise")
+    {
+        const auto input = lzss_compress(data);
+        run(
+            "bytewise",
+            [&]() { return lzss_decompress_reference(input, data.size()); },
+            [&]() { return lzss_decompress(input, data.size()); });
+    }
+}
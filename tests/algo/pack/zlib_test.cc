@@ -16,6 +16,8 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "algo/pack/zlib.h"
+#include "algo/range.h"
+#include "err.h"
 #include "io/memory_byte_stream.h"
 #include "test_support/catch.h"
 #include "test_support/common.h"
@@ -43,6 +45,21 @@ TEST_CASE("ZLIB compression", "[algo][pack]")
         REQUIRE(input_stream.left() == 0);
     }
 
+    SECTION("Inflating ZLIB with known size")
+    {
+        tests::compare_binary(zlib_inflate(input, output.size()), output);
+        tests::compare_binary(zlib_inflate(input, 1), output);
+        tests::compare_binary(zlib_inflate(input, 1000), output);
+    }
+
+    SECTION("Inflating ZLIB with known size from stream")
+    {
+        io::MemoryByteStream input_stream(input + "garbage"_b);
+        tests::compare_binary(
+            zlib_inflate(input_stream, output.size()), output);
+        REQUIRE(input_stream.pos() == input.size());
+    }
+
     SECTION("Deflating ZLIB from bstr")
     {
         tests::compare_binary(zlib_inflate(zlib_deflate(output)), output);
@@ -55,3 +72,64 @@ TEST_CASE("ZLIB compression", "[algo][pack]")
         tests::compare_binary(inflated, output);
     }
 }
+
+TEST_CASE("ZLIB inflating streams", "[algo][pack]")
+{
+    bstr output;
+    for (const auto i : algo::range(100000))
+        output += static_cast<u8>((i * i) >> 7);
+    const auto input = zlib_deflate(output);
+    io::MemoryByteStream input_stream(input);
+
+    SECTION("Reading sequentially")
+    {
+        ZlibInflateStream stream(input_stream, output.size());
+        REQUIRE(stream.size() == output.size());
+        REQUIRE(stream.contiguous_data() == nullptr);
+        tests::compare_binary(stream.read(10), output.substr(0, 10));
+        tests::compare_binary(stream.read_to_eof(), output.substr(10));
+        REQUIRE(stream.contiguous_data() != nullptr);
+    }
+
+    SECTION("Seeking")
+    {
+        ZlibInflateStream stream(input_stream, output.size());
+        stream.seek(50000);
+        tests::compare_binary(stream.read(10), output.substr(50000, 10));
+        stream.seek(5);
+        tests::compare_binary(stream.read(10), output.substr(5, 10));
+        REQUIRE_THROWS_AS(stream.seek(output.size() + 1), err::EofError);
+    }
+
+    SECTION("Cloning")
+    {
+        ZlibInflateStream stream(input_stream, output.size());
+        stream.seek(20000);
+        const auto clone = stream.clone();
+        REQUIRE(clone->pos() == 20000);
+        tests::compare_binary(clone->read_to_eof(), output.substr(20000));
+        tests::compare_binary(stream.read_to_eof(), output.substr(20000));
+    }
+
+    SECTION("Leaving the input stream alone")
+    {
+        input_stream.seek(3);
+        ZlibInflateStream stream(input_stream.seek(0), output.size());
+        input_stream.seek(3);
+        tests::compare_binary(stream.read_to_eof(), output);
+        REQUIRE(input_stream.pos() == 3);
+    }
+
+    SECTION("Data shorter than declared")
+    {
+        ZlibInflateStream stream(input_stream, output.size() + 1);
+        REQUIRE_THROWS_AS(stream.read_to_eof(), err::BadDataSizeError);
+    }
+
+    SECTION("Corrupt data")
+    {
+        io::MemoryByteStream bad_input_stream(input.substr(0, 100));
+        ZlibInflateStream stream(bad_input_stream, output.size());
+        REQUIRE_THROWS_AS(stream.read_to_eof(), err::CorruptDataError);
+    }
+}
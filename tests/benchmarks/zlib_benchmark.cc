@@ -0,0 +1,191 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+// Compares the DEFLATE backend arc_unpacker was built with against stock
+// zlib. Takes XP3 archives or directories holding them, and falls back to
+// the archives in the test suite.
+//
+// The archives are unpacked first, and their files are deflated again with
+// stock zlib at the default level, like the KiriKiri packer does, to get
+// one segment per file.
+
+#include <algorithm>
+#include <cstdio>
+#include <zlib.h>
+#include "algo/pack/zlib.h"
+#include "algo/range.h"
+#include "dec/kirikiri/xp3_archive_decoder.h"
+#include "io/file.h"
+#include "io/file_system.h"
+#include "logger.h"
+#include "test_support/benchmark.h"
+
+using namespace au;
+
+static const std::string backend_name
+    = LIBDEFLATE_FOUND ? "libdeflate" : "zlib";
+
+static std::vector<io::path> find_archives(const std::vector<io::path> &paths)
+{
+    std::vector<io::path> archive_paths;
+    for (const auto &path : paths)
+    {
+        if (!io::is_directory(path))
+        {
+            archive_paths.push_back(path);
+            continue;
+        }
+        for (const auto &child_path : io::recursive_directory_range(path))
+            if (io::is_regular_file(child_path))
+                archive_paths.push_back(child_path);
+    }
+    return archive_paths;
+}
+
+static std::vector<bstr> read_files(const std::vector<io::path> &paths)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    dec::kirikiri::Xp3ArchiveDecoder decoder;
+    decoder.plugin_manager.set("noop");
+    std::vector<bstr> files;
+    for (const auto &path : find_archives(paths))
+    {
+        io::File input_file(path, io::FileMode::Read);
+        if (!decoder.is_recognized(input_file))
+            continue;
+        const auto meta = decoder.read_meta(dummy_logger, input_file);
+        for (const auto &entry : meta->entries)
+        {
+            const auto output_file = decoder.read_file(
+                dummy_logger, input_file, *meta, *entry);
+            files.push_back(output_file->stream.seek(0).read_to_eof());
+        }
+    }
+    return files;
+}
+
+static bstr compress_with_zlib(const bstr &input, const int level)
+{
+    uLongf output_size = compressBound(input.size());
+    bstr output(output_size);
+    compress2(
+        output.get<Bytef>(),
+        &output_size,
+        input.get<const Bytef>(),
+        input.size(),
+        level);
+    return output.substr(0, output_size);
+}
+
+static bstr uncompress_with_zlib(const bstr &input, const size_t size)
+{
+    uLongf output_size = size;
+    bstr output(output_size);
+    uncompress(
+        output.get<Bytef>(),
+        &output_size,
+        input.get<const Bytef>(),
+        input.size());
+    return output;
+}
+
+static void measure(
+    const std::string &label,
+    const size_t iterations,
+    const size_t total_size,
+    const std::function<void()> &callback)
+{
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+            callback();
+    });
+    tests::report_throughput(
+        label, iterations * total_size / 1e6, "MB", seconds);
+}
+
+int main(int argc, const char **argv)
+{
+    std::vector<io::path> paths;
+    for (const auto i : algo::range(1, argc))
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths.push_back("tests/dec/kirikiri/files/xp3/");
+
+    const auto files = read_files(paths);
+    std::vector<bstr> segments;
+    size_t total_size = 0;
+    for (const auto &file : files)
+    {
+        segments.push_back(compress_with_zlib(file, Z_DEFAULT_COMPRESSION));
+        total_size += file.size();
+    }
+    if (!total_size)
+    {
+        std::printf("No XP3 files found\n");
+        return 1;
+    }
+
+    // repeat small corpora until there is enough to measure
+    const auto iterations = std::max<size_t>(
+        1, (64 * 1024 * 1024) / total_size);
+    std::printf(
+        "%d files, %.02f MB, %d iterations, backend: %s\n",
+        static_cast<int>(files.size()),
+        total_size / 1e6,
+        static_cast<int>(iterations),
+        backend_name.c_str());
+
+    measure("inflate: stock zlib", iterations, total_size, [&]()
+    {
+        for (const auto i : algo::range(files.size()))
+            uncompress_with_zlib(segments[i], files[i].size());
+    });
+    measure("inflate: unknown size", iterations, total_size, [&]()
+    {
+        for (const auto &segment : segments)
+            algo::pack::zlib_inflate(segment);
+    });
+    measure("inflate: known size, " + backend_name, iterations, total_size,
+        [&]()
+        {
+            for (const auto i : algo::range(files.size()))
+                algo::pack::zlib_inflate(segments[i], files[i].size());
+        });
+    // the best presets differ between backends (zlib tops out at level 9,
+    // libdeflate at 12), so compare them at level 6 that both share
+    const auto deflate_iterations = std::max<size_t>(1, iterations / 16);
+    measure("deflate level 6: stock zlib", deflate_iterations, total_size,
+        [&]()
+        {
+            for (const auto &file : files)
+                compress_with_zlib(file, 6);
+        });
+    measure("deflate level 6: " + backend_name, deflate_iterations, total_size,
+        [&]()
+        {
+            for (const auto &file : files)
+            {
+                algo::pack::zlib_deflate(
+                    file,
+                    algo::pack::ZlibKind::PlainZlib,
+                    algo::pack::CompressionLevel::Good);
+            }
+        });
+    return 0;
+}
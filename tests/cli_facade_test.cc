@@ -16,6 +16,7 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/cli_facade.h"
+#include "err.h"
 #include "io/file_system.h"
 #include "test_support/catch.h"
 
@@ -60,4 +61,19 @@ TEST_CASE("CLI facade", "[core]")
         io::remove("./xp3-v2~.xp3/123.txt");
         io::remove("./xp3-v2~.xp3");
     }
+
+    SECTION("Rejecting task limits below one")
+    {
+        for (const auto limit : {"0", "-1"})
+        {
+            REQUIRE_THROWS_AS(
+                flow::CliFacade(
+                    logger,
+                    {
+                        "./tests/dec/real_live/files/g00/AYU_03.g00",
+                        std::string("--max-inflight=") + limit
+                    }),
+                err::UsageError);
+        }
+    }
 }
@@ -91,8 +91,7 @@ std::unique_ptr<io::File> TestArchiveDecoder::read_file_impl(
     const ArchiveEntry &e) const
 {
     const auto entry = static_cast<const PlainArchiveEntry*>(&e);
-    const auto data = input_file.stream.seek(entry->offset).read(entry->size);
-    return std::make_unique<io::File>(entry->path, data);
+    return read_plain_file(input_file, *entry);
 }
 
 static std::unique_ptr<io::File> make_archive(
@@ -207,6 +206,32 @@ TEST_CASE("Simple archive unpacks correctly", "[dec]")
     REQUIRE(saved_files[0]->stream.read_to_eof() == "abc"_b);
 }
 
+TEST_CASE("Stored archive entries are read lazily", "[dec]")
+{
+    const TestArchiveDecoder decoder(algo::NamingStrategy::Child);
+    auto archive_file = make_archive(
+        "test.archive",
+        {
+            tests::stub_file("first.txt", "abc"_b),
+            tests::stub_file("second.txt", "defgh"_b),
+        });
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto meta = decoder.read_meta(dummy_logger, *archive_file);
+    REQUIRE(meta->entries.size() == 2);
+
+    const auto file = decoder.read_file(
+        dummy_logger, *archive_file, *meta, *meta->entries[1]);
+    archive_file->stream.seek(0);
+    tests::compare_paths(file->path, "second.txt");
+    REQUIRE(file->stream.size() == 5);
+    REQUIRE(file->stream.pos() == 0);
+    REQUIRE(file->stream.read(2) == "de"_b);
+    REQUIRE(archive_file->stream.pos() == 0);
+    REQUIRE(file->stream.seek(1).read_to_eof() == "efgh"_b);
+    REQUIRE_THROWS(file->stream.seek(6));
+}
+
 TEST_CASE("Archive files get proper fallback names", "[dec]")
 {
     SECTION("Child naming strategy")
@@ -16,6 +16,8 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/bgi/dsc_file_decoder.h"
+#include "algo/range.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 #include "test_support/decoder_support.h"
 #include "test_support/file_support.h"
@@ -68,3 +70,23 @@ TEST_CASE("BGI DSC files / images", "[dec]")
         do_test_image("SGTitle000000", "SGTitle000000-out.png");
     }
 }
+
+TEST_CASE("BGI DSC decoding throughput", "[.benchmark][dec]")
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto decoder = DscFileDecoder();
+    const auto input_file = tests::file_from_path(dir + "setupforgallery");
+    const auto iterations = 2000;
+    uoff_t output_size = 0;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+        {
+            input_file->stream.seek(0);
+            output_size += decoder.decode(dummy_logger, *input_file)
+                ->stream.size();
+        }
+    });
+    tests::report_throughput("DSC", output_size / 1e6, "MB", seconds);
+}
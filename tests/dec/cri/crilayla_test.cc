@@ -0,0 +1,212 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/cri/crilayla.h"
+#include "algo/range.h"
+#include "algo/str.h"
+#include "err.h"
+#include "io/memory_byte_stream.h"
+#include "io/msb_bit_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::dec::cri;
+
+// Greedy encoder working on the reversed body, as the decoder sees it.
+static bstr compress(const bstr &prefix, const bstr &body)
+{
+    const auto data = algo::reverse(body);
+    io::MemoryByteStream output_stream;
+    {
+        io::MsbBitStream bit_stream(output_stream);
+        size_t pos = 0;
+        while (pos < data.size())
+        {
+            size_t best_size = 0, best_distance = 0;
+            const auto max_distance = std::min<size_t>(pos, 0x2002);
+            for (size_t distance = 3; distance <= max_distance; distance++)
+            {
+                size_t size = 0;
+                while (pos + size < data.size()
+                    && size < 300
+                    && data[pos + size] == data[pos + size - distance])
+                {
+                    size++;
+                }
+                if (size > best_size)
+                {
+                    best_size = size;
+                    best_distance = distance;
+                }
+            }
+            if (best_size < 3)
+            {
+                bit_stream.write(1, 0);
+                bit_stream.write(8, data[pos++]);
+                continue;
+            }
+            bit_stream.write(1, 1);
+            bit_stream.write(13, best_distance - 3);
+            auto left = best_size - 3;
+            for (const auto bits : {2, 3, 5, 8, 8})
+            {
+                const auto part = std::min<size_t>(left, (1 << bits) - 1);
+                bit_stream.write(bits, part);
+                left -= part;
+                if (part != (1u << bits) - 1)
+                    break;
+            }
+            pos += best_size;
+        }
+    }
+    const auto data_comp = algo::reverse(output_stream.seek(0).read_to_eof());
+    io::MemoryByteStream result;
+    result.write("CRILAYLA"_b);
+    result.write_le<u32>(body.size());
+    result.write_le<u32>(data_comp.size());
+    result.write(data_comp);
+    result.write(prefix);
+    return result.seek(0).read_to_eof();
+}
+
+// The original implementation, kept as a reference.
+static bstr decompress_with_reference(const bstr &input)
+{
+    io::MemoryByteStream input_stream(input);
+    input_stream.seek(8);
+    const auto size_orig = input_stream.read_le<u32>();
+    const auto size_comp = input_stream.read_le<u32>();
+    const auto data_comp = algo::reverse(input_stream.read(size_comp));
+    const auto prefix = input_stream.read_to_eof();
+
+    io::MsbBitStream bit_stream(data_comp);
+    bstr output;
+    output.reserve(size_orig);
+    while (output.size() < size_orig)
+    {
+        if (bit_stream.read(1))
+        {
+            auto repetitions = 3;
+            auto look_behind = bit_stream.read(13) + 3;
+
+            std::vector<size_t> sizes = {5, 3, 2};
+            while (true)
+            {
+                size_t size = 8;
+                if (!sizes.empty())
+                {
+                    size = sizes.back();
+                    sizes.pop_back();
+                }
+                const auto marker = bit_stream.read(size);
+                repetitions += marker;
+                if (marker != (1u << size) - 1)
+                    break;
+            }
+
+            while (repetitions--)
+                output += output.at(output.size() - look_behind);
+        }
+        else
+            output += static_cast<u8>(bit_stream.read(8));
+    }
+
+    return prefix + algo::reverse(output);
+}
+
+static bstr get_test_body(const size_t size)
+{
+    bstr output;
+    u32 seed = 1;
+    while (output.size() < size)
+    {
+        seed = seed * 1103515245 + 12345;
+        const auto kind = (seed >> 16) % 4;
+        if (kind == 0)
+            output += bstr((seed >> 20) % 400, seed >> 8);
+        else if (kind == 1 && output.size() > 10)
+            output += output.substr(output.size() - 10, 10);
+        else
+            output += static_cast<u8>(seed >> 24);
+    }
+    return output.substr(0, size);
+}
+
+TEST_CASE("CRI CRILAYLA decompression", "[dec]")
+{
+    bstr prefix(0x100);
+    for (const auto i : algo::range(prefix.size()))
+        prefix[i] = i;
+
+    SECTION("Literals and matches")
+    {
+        const auto body = "abcabcabcabcabcxyzxyzabcabcabcabcabc"_b;
+        const auto input = compress(prefix, body);
+        tests::compare_binary(decompress_crilayla(input), prefix + body);
+    }
+
+    SECTION("Long and overlapping matches")
+    {
+        const auto body = get_test_body(100000);
+        const auto input = compress(prefix, body);
+        const auto expected = prefix + body;
+        tests::compare_binary(decompress_with_reference(input), expected);
+        tests::compare_binary(decompress_crilayla(input), expected);
+    }
+
+    SECTION("Truncated data")
+    {
+        auto input = compress(prefix, get_test_body(1000));
+        input.get<u32>()[2] += 100;
+        REQUIRE_THROWS_AS(decompress_crilayla(input), err::EofError);
+    }
+
+    SECTION("Look-behind before the start")
+    {
+        // a match right away has nothing to copy from
+        auto input = compress(""_b, "aaaaaaaa"_b);
+        input[input.size() - 1] |= 0x80;
+        REQUIRE_THROWS_AS(
+            decompress_crilayla(input), err::BadDataOffsetError);
+    }
+
+    SECTION("Not CRILAYLA")
+    {
+        REQUIRE(!is_crilayla("CRILAYL"_b));
+        REQUIRE(is_crilayla(compress(prefix, "a"_b)));
+        REQUIRE_THROWS_AS(
+            decompress_crilayla("CRILAYLA"_b), err::RecognitionError);
+    }
+}
+
+TEST_CASE("CRI CRILAYLA decompression throughput", "[.benchmark][dec]")
+{
+    const auto body = get_test_body(4 * 1024 * 1024);
+    const auto input = compress(bstr(0x100), body);
+
+    bstr expected, actual;
+    const auto reference_time = tests::measure_seconds(
+        [&]() { expected = decompress_with_reference(input); });
+    const auto time = tests::measure_seconds(
+        [&]() { actual = decompress_crilayla(input); });
+    REQUIRE(actual == expected);
+    tests::report_throughput(
+        "CRILAYLA (reference)", body.size() / 1e6, "MB", reference_time);
+    tests::report_throughput("CRILAYLA", body.size() / 1e6, "MB", time);
+}
@@ -16,6 +16,11 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/cri/hca_audio_decoder.h"
+#include "algo/parallel.h"
+#include "algo/range.h"
+#include "dec/cri/hca/stream_decoder.h"
+#include "enc/microsoft/wav_audio_encoder.h"
+#include "test_support/benchmark.h"
 #include "test_support/audio_support.h"
 #include "test_support/catch.h"
 #include "test_support/decoder_support.h"
@@ -42,4 +47,97 @@ TEST_CASE("CRI HCA audio", "[dec]")
     {
         do_test("test.hca", "test-out.wav");
     }
+
+    SECTION("Block by block")
+    {
+        const auto input_file = tests::file_from_path(dir + "test.hca");
+        const auto expected_audio = tests::decode(
+            HcaAudioDecoder(), *input_file);
+
+        input_file->stream.seek(0);
+        hca::StreamDecoder stream_decoder(input_file->stream);
+        REQUIRE(stream_decoder.get_channel_count() == 1);
+        const auto block_size = hca::StreamDecoder::samples_per_block;
+        bstr block(block_size * 2);
+        bstr samples;
+        size_t block_count = 0;
+        while (stream_decoder.read_block(block.get<s16>()))
+        {
+            samples += block;
+            block_count++;
+        }
+        REQUIRE(block_count == stream_decoder.get_block_count());
+        REQUIRE(!stream_decoder.read_block(block.get<s16>()));
+        REQUIRE(samples == expected_audio.samples);
+    }
+
+    SECTION("Streamed decoding")
+    {
+        Logger dummy_logger;
+        dummy_logger.mute();
+        const auto decoder = HcaAudioDecoder();
+        const auto encoder = enc::microsoft::WavAudioEncoder();
+        const auto input_file = tests::file_from_path(dir + "test.hca");
+        const auto expected_file = encoder.encode(
+            dummy_logger, tests::decode(decoder, *input_file), "test.hca");
+
+        REQUIRE(decoder.supports_streaming());
+        const auto streamed_audio
+            = decoder.decode_streamed(dummy_logger, *input_file);
+        REQUIRE(streamed_audio);
+        REQUIRE(streamed_audio->audio.samples.empty());
+        const auto actual_file = encoder.encode_streamed(
+            dummy_logger, *streamed_audio, "test.hca");
+        REQUIRE(actual_file->path == expected_file->path);
+        REQUIRE(actual_file->stream.seek(0).read_to_eof()
+            == expected_file->stream.seek(0).read_to_eof());
+    }
+
+    SECTION("Block count past the end of the stream")
+    {
+        Logger dummy_logger;
+        dummy_logger.mute();
+        const auto decoder = HcaAudioDecoder();
+        io::File input_file(
+            "test.hca",
+            tests::file_from_path(dir + "test.hca")->stream.read_to_eof());
+        input_file.stream.seek(0x10).write_be<u32>(0x7FFFFFFF);
+        REQUIRE_THROWS_AS(
+            decoder.decode(dummy_logger, input_file), err::BadDataSizeError);
+        REQUIRE_THROWS_AS(
+            decoder.decode_streamed(dummy_logger, input_file),
+            err::BadDataSizeError);
+    }
+
+    SECTION("Concurrent decoding")
+    {
+        const auto expected_file = tests::file_from_path(dir + "test-out.wav");
+        std::vector<std::unique_ptr<res::Audio>> actual_audio(4);
+        algo::run_in_parallel(actual_audio.size(), [&](const size_t i)
+        {
+            const auto input_file = tests::file_from_path(dir + "test.hca");
+            actual_audio[i] = std::make_unique<res::Audio>(
+                tests::decode(HcaAudioDecoder(), *input_file));
+        });
+        for (const auto &audio : actual_audio)
+            tests::compare_audio(*audio, *expected_file);
+    }
+}
+
+TEST_CASE("CRI HCA decoding throughput", "[.benchmark]")
+{
+    static const size_t repetitions = 2000;
+    const auto decoder = HcaAudioDecoder();
+    const auto input_file = tests::file_from_path(dir + "test.hca");
+    size_t sample_count = 0;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(repetitions))
+        {
+            const auto audio = tests::decode(decoder, *input_file);
+            sample_count += audio.samples.size() / 2;
+        }
+    });
+    tests::report_throughput(
+        "HCA, mono", sample_count / 1e6, "MS", seconds);
 }
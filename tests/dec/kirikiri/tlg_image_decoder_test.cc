@@ -16,6 +16,10 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/kirikiri/tlg_image_decoder.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "dec/kirikiri/tlg/tlg6_decoder.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 #include "test_support/decoder_support.h"
 #include "test_support/file_support.h"
@@ -48,8 +52,46 @@ TEST_CASE("KiriKiri TLG images", "[dec]")
         do_test("tlg6.tlg", "tlg6-out.png");
     }
 
+    SECTION("TLG6, multithreaded")
+    {
+        const auto input_file = tests::file_from_path(dir + "tlg6.tlg");
+        const auto expected_file = tests::file_from_path(dir + "tlg6-out.png");
+        for (const auto thread_count : {1, 2, 3, 8})
+        {
+            input_file->stream.seek(11);
+            const auto actual_image
+                = tlg::Tlg6Decoder(thread_count).decode(*input_file);
+            tests::compare_images(actual_image, *expected_file);
+        }
+    }
+
     SECTION("TLG0")
     {
         do_test("bg08d.tlg", "bg08d-out.png");
     }
 }
+
+TEST_CASE("KiriKiri TLG6 decoding throughput", "[.benchmark]")
+{
+    static const size_t repetitions = 20;
+    const auto input_file = tests::file_from_path(dir + "tlg6.tlg");
+    for (const auto thread_count : {1, 2, 4})
+    {
+        size_t pixel_count = 0;
+        const auto seconds = tests::measure_seconds([&]()
+        {
+            for (const auto i : algo::range(repetitions))
+            {
+                input_file->stream.seek(11);
+                const auto image
+                    = tlg::Tlg6Decoder(thread_count).decode(*input_file);
+                pixel_count += image.width() * image.height();
+            }
+        });
+        tests::report_throughput(
+            algo::format("TLG6, %d threads", thread_count),
+            pixel_count / 1e6,
+            "MP",
+            seconds);
+    }
+}
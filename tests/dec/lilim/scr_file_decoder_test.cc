@@ -16,6 +16,8 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dec/lilim/scr_file_decoder.h"
+#include "algo/range.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 #include "test_support/decoder_support.h"
 #include "test_support/file_support.h"
@@ -39,3 +41,23 @@ TEST_CASE("Lilim AOS scripts", "[dec]")
 {
     do_test("var.scr", "var-out.txt");
 }
+
+TEST_CASE("Lilim AOS script decoding throughput", "[.benchmark][dec]")
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto decoder = ScrFileDecoder();
+    const auto input_file = tests::file_from_path(dir + "var.scr");
+    const auto iterations = 2000;
+    uoff_t output_size = 0;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+        {
+            input_file->stream.seek(0);
+            output_size += decoder.decode(dummy_logger, *input_file)
+                ->stream.size();
+        }
+    });
+    tests::report_throughput("SCR", output_size / 1e6, "MB", seconds);
+}
@@ -0,0 +1,147 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/malie/common/camellia_stream.h"
+#include "algo/range.h"
+#include "err.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::dec::malie::common;
+
+static const std::vector<u32> key = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x16C976B6, 0x6CEC462F, 0xBA30F99A, 0x6E6CDE71,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0xBB5B3676, 0x2317DD18, 0x7CCD3736, 0x6F388B64,
+    0x9B3B118B, 0xEE8C3E66, 0x9B9B379C, 0x45B25DAD,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x88C5F746, 0x1F334DCD, 0x00000000, 0x00000000,
+    0xFBA30F99, 0xA6E6CDE7, 0x116C976B, 0x66CEC462,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x9B9B379C, 0x45B25DAD, 0x9B3B118B, 0xEE8C3E66,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    0x6F388B64, 0xBB5B3676, 0x2317DD18, 0x7CCD3736,
+};
+
+static bstr get_random_bytes(const size_t size, u32 seed)
+{
+    bstr output(size);
+    for (auto &c : output)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = seed >> 16;
+    }
+    return output;
+}
+
+// Decrypts one block at a time, the way the stream used to.
+static bstr decrypt_with_reference(const bstr &input)
+{
+    algo::crypt::Camellia camellia(key);
+    io::MemoryByteStream input_stream(input);
+    io::MemoryByteStream output_stream;
+    for (const auto i : algo::range(input.size() / 0x10))
+    {
+        u32 input_block[4];
+        u32 output_block[4];
+        for (const auto j : algo::range(4))
+            input_block[j] = input_stream.read_le<u32>();
+        camellia.decrypt_block_128(i * 0x10, input_block, output_block);
+        for (const auto j : algo::range(4))
+            output_stream.write_be<u32>(output_block[j]);
+    }
+    return output_stream.seek(0).read_to_eof();
+}
+
+TEST_CASE("Malie Camellia stream", "[dec]")
+{
+    const auto input = get_random_bytes(0x10000, 1);
+    const auto expected = decrypt_with_reference(input);
+    io::MemoryByteStream input_stream(input);
+
+    SECTION("Reading everything at once")
+    {
+        CamelliaStream stream(input_stream, key);
+        tests::compare_binary(stream.read_to_eof(), expected);
+    }
+
+    SECTION("Reading unaligned spans of any size")
+    {
+        CamelliaStream stream(input_stream, key);
+        u32 seed = 1;
+        for (const auto i : algo::range(500))
+        {
+            seed = seed * 1103515245 + 12345;
+            const auto offset = (seed >> 8) % input.size();
+            const auto max_size = i % 2 ? 0x3000 : 0x20;
+            const auto size = std::min<size_t>(
+                (seed >> 4) % max_size, input.size() - offset);
+            stream.seek(offset);
+            REQUIRE(stream.read(size) == expected.substr(offset, size));
+            REQUIRE(stream.pos() == offset + size);
+        }
+    }
+
+    SECTION("Reading from an offset")
+    {
+        CamelliaStream stream(input_stream, key, 0x1230, 0x100);
+        stream.seek(0);
+        REQUIRE(stream.read_le<u32>()
+            == expected.substr(0x1230, 4).get<const u32>()[0]);
+        REQUIRE(stream.read(0xFC) == expected.substr(0x1234, 0xFC));
+        auto clone = stream.clone();
+        clone->seek(0x10);
+        REQUIRE(clone->read(0x10) == expected.substr(0x1240, 0x10));
+    }
+
+    SECTION("Truncated input")
+    {
+        io::MemoryByteStream truncated_stream(input.substr(0, 0x1008));
+        CamelliaStream stream(truncated_stream, key, 0, 0x1010);
+        REQUIRE(stream.read(0x1000) == expected.substr(0, 0x1000));
+        REQUIRE_THROWS_AS(stream.read(4), err::EofError);
+    }
+}
+
+TEST_CASE("Malie Camellia stream throughput", "[.benchmark][dec]")
+{
+    const auto input = get_random_bytes(8 * 1024 * 1024, 1);
+    io::MemoryByteStream input_stream(input);
+
+    bstr actual;
+    const auto bulk_time = tests::measure_seconds([&]()
+    {
+        CamelliaStream stream(input_stream, key);
+        actual = stream.read_to_eof();
+    });
+    const auto small_time = tests::measure_seconds([&]()
+    {
+        CamelliaStream stream(input_stream, key);
+        while (stream.left())
+            stream.read_le<u32>();
+    });
+    REQUIRE(actual == decrypt_with_reference(input));
+    tests::report_throughput(
+        "Camellia stream (bulk)", input.size() / 1e6, "MB", bulk_time);
+    tests::report_throughput(
+        "Camellia stream (u32 reads)", input.size() / 1e6, "MB", small_time);
+}
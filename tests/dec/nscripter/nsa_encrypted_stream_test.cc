@@ -23,6 +23,7 @@
 #include "algo/crypt/sha1.h"
 #include "algo/range.h"
 #include "io/memory_byte_stream.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 #include "test_support/common.h"
 
@@ -77,33 +78,96 @@ static void transform_block(
     }
 }
 
-TEST_CASE("NScripter NSA encryption", "[dec]")
+static bstr encrypt(const bstr &key, const bstr &input)
 {
-    bstr input;
-    for (const auto i : algo::range(10000))
-        input += "weird things"_b;
-    const auto key = "weird key"_b;
-
-    bstr encrypted_input = input;
+    bstr output = input;
     for (const auto i : algo::range(0, input.size(), 1024))
     {
         transform_block(
             key,
             i / 1024,
-            encrypted_input.get<u8>() + i,
+            output.get<u8>() + i,
             std::max<size_t>(0, std::min<size_t>(input.size() - i, 1024)));
     }
+    return output;
+}
 
-    const size_t chunk_size = 555;
+TEST_CASE("NScripter NSA encryption", "[dec]")
+{
+    bstr input;
+    for (const auto i : algo::range(10000))
+        input += "weird things"_b;
+    const auto key = "weird key"_b;
+    const auto encrypted_input = encrypt(key, input);
     io::MemoryByteStream base_stream(encrypted_input);
-    dec::nscripter::NsaEncryptedStream encrypted_stream(base_stream, key);
 
-    bstr output;
-    while (encrypted_stream.left())
+    SECTION("Reading in chunks")
     {
-        output += encrypted_stream.read(
-            std::min<size_t>(encrypted_stream.left(), chunk_size));
+        const size_t chunk_size = 555;
+        NsaEncryptedStream encrypted_stream(base_stream, key);
+
+        bstr output;
+        while (encrypted_stream.left())
+        {
+            output += encrypted_stream.read(
+                std::min<size_t>(encrypted_stream.left(), chunk_size));
+        }
+
+        tests::compare_binary(output, input);
     }
 
-    tests::compare_binary(output, input);
+    SECTION("Reading on many threads")
+    {
+        const auto cache = std::make_shared<NsaKeystreamCache>(key, 8);
+        NsaEncryptedStream encrypted_stream(base_stream, cache, 4);
+        tests::compare_binary(encrypted_stream.read_to_eof(), input);
+        encrypted_stream.seek(1000);
+        tests::compare_binary(
+            encrypted_stream.read(100000), input.substr(1000, 100000));
+    }
+
+    SECTION("Sharing the keystreams")
+    {
+        const auto cache = std::make_shared<NsaKeystreamCache>(key, 2);
+        NsaEncryptedStream encrypted_stream1(base_stream, cache);
+        NsaEncryptedStream encrypted_stream2(base_stream, cache);
+        for (const auto i : algo::range(0, input.size() - 10, 700))
+        {
+            encrypted_stream1.seek(i);
+            encrypted_stream2.seek(input.size() - i - 10);
+            REQUIRE(encrypted_stream1.read(10) == input.substr(i, 10));
+            REQUIRE(encrypted_stream2.read(10)
+                == input.substr(input.size() - i - 10, 10));
+        }
+        REQUIRE(cache->get(3) == cache->get(3));
+    }
+}
+
+TEST_CASE("NScripter NSA encryption throughput", "[.benchmark][dec]")
+{
+    bstr input;
+    for (const auto i : algo::range(100000))
+        input += "weird things"_b;
+    const auto key = "weird key"_b;
+    io::MemoryByteStream base_stream(encrypt(key, input));
+
+    bstr actual;
+    const auto bulk_time = tests::measure_seconds([&]()
+    {
+        NsaEncryptedStream encrypted_stream(base_stream, key);
+        actual = encrypted_stream.read_to_eof();
+    });
+    REQUIRE(actual == input);
+
+    const auto small_time = tests::measure_seconds([&]()
+    {
+        NsaEncryptedStream encrypted_stream(base_stream, key);
+        while (encrypted_stream.left() >= 4)
+            encrypted_stream.read_le<u32>();
+    });
+
+    tests::report_throughput(
+        "NSA stream (bulk)", input.size() / 1e6, "MB", bulk_time);
+    tests::report_throughput(
+        "NSA stream (u32 reads)", input.size() / 1e6, "MB", small_time);
 }
@@ -0,0 +1,172 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "dec/qlie/pack_archive_decoder.h"
+#include "algo/binary.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/decoder_support.h"
+#include "test_support/file_support.h"
+
+using namespace au;
+using namespace au::dec::qlie;
+
+static const std::string dir = "tests/dec/qlie/files/pack/";
+
+static std::unique_ptr<PackArchiveDecoder> create_decoder(
+    const std::vector<std::string> &arguments)
+{
+    auto decoder = std::make_unique<PackArchiveDecoder>();
+    ArgParser arg_parser;
+    const auto decorators = decoder->get_arg_parser_decorators();
+    for (const auto &decorator : decorators)
+        decorator.register_cli_options(arg_parser);
+    arg_parser.parse(arguments);
+    for (const auto &decorator : decorators)
+        decorator.parse_cli_options(arg_parser);
+    return decoder;
+}
+
+static void do_test(
+    const std::vector<std::string> &arguments,
+    const std::string &input_path,
+    const std::string &expected_dir)
+{
+    const auto decoder = create_decoder(arguments);
+    const auto input_file = tests::file_from_path(dir + input_path);
+    const auto actual_files = tests::unpack(*decoder, *input_file);
+    const std::vector<std::shared_ptr<io::File>> expected_files
+    {
+        tests::file_from_path(dir + expected_dir + "tail.dat", "tail.dat"),
+        tests::file_from_path(dir + expected_dir + "word.dat", "word.dat"),
+        tests::file_from_path(dir + expected_dir + "odd.dat", "odd.dat"),
+        tests::file_from_path(dir + expected_dir + "table.dat", "table.dat"),
+        tests::file_from_path(dir + expected_dir + "block.dat", "block.dat"),
+    };
+    tests::compare_files(actual_files, expected_files, true);
+}
+
+// Builds a FilePackVer3 archive holding uncompressed entries of random data
+// flagged as encrypted, so that unpacking it runs only the data ciphers.
+static std::unique_ptr<io::File> create_archive(
+    const std::string &path, const size_t entry_count, const size_t entry_size)
+{
+    const bstr seed_source(256);
+    u64 key = 0;
+    u64 seed = 0;
+    for (const auto i : algo::range(seed_source.size() >> 3))
+    {
+        key = algo::padw(key, 0x0307030703070307);
+        seed = algo::padw(seed, seed_source.get<u64>()[i] ^ key);
+    }
+    seed = ((seed ^ (seed >> 32)) & 0xFFFFFFFF) & 0x0FFFFFFF;
+
+    io::MemoryByteStream data_stream;
+    io::MemoryByteStream table_stream;
+    u32 random = 0x12345678;
+    for (const auto i : algo::range(entry_count))
+    {
+        bstr name = algo::format("%04d.dat", i);
+        const u8 x = ((seed ^ 0x3E) + name.size()) & 0xFF;
+        for (const auto j : algo::range(1, name.size() + 1))
+            name.get<u8>()[j - 1] ^= ((j ^ x) & 0xFF) + j;
+
+        bstr data(entry_size);
+        for (auto &c : data)
+        {
+            random = random * 1103515245 + 12345;
+            c = random >> 24;
+        }
+
+        table_stream.write_le<u16>(name.size());
+        table_stream.write(name);
+        table_stream.write_le<u64>(data_stream.pos());
+        table_stream.write_le<u32>(data.size());
+        table_stream.write_le<u32>(data.size());
+        table_stream.write_le<u32>(0);
+        table_stream.write_le<u32>(1);
+        table_stream.write_le<u32>(0);
+        data_stream.write(data);
+    }
+    table_stream.write(bstr(28));
+    table_stream.write_le<u32>(0);
+    table_stream.write(bstr(36));
+    table_stream.write(seed_source);
+
+    auto output_file = std::make_unique<io::File>(path, ""_b);
+    output_file->stream.write(data_stream.seek(0).read_to_eof());
+    output_file->stream.write(table_stream.seek(0).read_to_eof());
+    output_file->stream.write("FilePackVer3.0\x00\x00"_b);
+    output_file->stream.write_le<u32>(entry_count);
+    output_file->stream.write_le<u64>(data_stream.size());
+    return output_file;
+}
+
+TEST_CASE("QLiE FilePackVer3 archives", "[dec]")
+{
+    SECTION("Basic encryption")
+    {
+        do_test({"--no-external-keys"}, "basic.pack", "basic-out/");
+    }
+
+    SECTION("Encryption with external keys")
+    {
+        do_test({}, "keyed/GameData/data0.pack", "keyed-out/");
+    }
+}
+
+TEST_CASE("QLiE FilePackVer3 decryption throughput", "[.benchmark]")
+{
+    static const size_t entry_count = 16;
+    static const size_t entry_size = 4 * 1024 * 1024 + 3;
+    static const size_t repetitions = 4;
+
+    const std::vector<std::tuple<std::string, std::string, std::string>> runs
+    {
+        {"basic", dir + "bench.pack", "--no-external-keys"},
+        {"external keys", dir + "keyed/GameData/bench.pack", "--fkey="
+            + dir + "keyed/game.fkey"},
+    };
+    for (const auto &run : runs)
+    {
+        const auto decoder = create_decoder({std::get<2>(run)});
+        const auto input_file = create_archive(
+            std::get<1>(run), entry_count, entry_size);
+        Logger dummy_logger;
+        dummy_logger.mute();
+        const auto meta = decoder->read_meta(dummy_logger, *input_file);
+        size_t byte_count = 0;
+        const auto seconds = tests::measure_seconds([&]()
+        {
+            for (const auto i : algo::range(repetitions))
+            for (const auto &entry : meta->entries)
+            {
+                byte_count += decoder->read_file(
+                    dummy_logger, *input_file, *meta, *entry)->stream.size();
+            }
+        });
+        tests::report_throughput(
+            "QLiE pack, " + std::get<0>(run),
+            byte_count / 1024.0 / 1024.0,
+            "MB",
+            seconds);
+    }
+}
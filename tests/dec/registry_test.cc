@@ -0,0 +1,343 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/registry.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "dec/base_file_decoder.h"
+#include "io/file_byte_stream.h"
+#include "io/file_system.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::dec;
+
+namespace
+{
+    class TestFileDecoder final : public BaseFileDecoder
+    {
+    public:
+        TestFileDecoder(
+            const std::vector<RecognitionSignature> &signatures,
+            const std::vector<std::string> &linked_formats = {});
+
+        std::vector<std::string> get_linked_formats() const override;
+
+    protected:
+        bool is_recognized_impl(io::File &input_file) const override;
+
+        std::vector<RecognitionSignature> get_recognition_signatures_impl()
+            const override;
+
+        std::unique_ptr<io::File> decode_impl(
+            const Logger &logger, io::File &input_file) const override;
+
+    private:
+        const std::vector<RecognitionSignature> signatures;
+        const std::vector<std::string> linked_formats;
+    };
+}
+
+TestFileDecoder::TestFileDecoder(
+    const std::vector<RecognitionSignature> &signatures,
+    const std::vector<std::string> &linked_formats) :
+        signatures(signatures),
+        linked_formats(linked_formats)
+{
+}
+
+std::vector<std::string> TestFileDecoder::get_linked_formats() const
+{
+    return linked_formats;
+}
+
+bool TestFileDecoder::is_recognized_impl(io::File &input_file) const
+{
+    return true;
+}
+
+std::vector<RecognitionSignature>
+    TestFileDecoder::get_recognition_signatures_impl() const
+{
+    return signatures;
+}
+
+std::unique_ptr<io::File> TestFileDecoder::decode_impl(
+    const Logger &logger, io::File &input_file) const
+{
+    return nullptr;
+}
+
+static std::set<std::string> guess(
+    const Registry &registry,
+    io::File &input_file,
+    const std::set<std::string> &candidates)
+{
+    std::set<std::string> matches;
+    for (const auto &name : candidates)
+        if (registry.get_decoder_prototype(name)->is_recognized(input_file))
+            matches.insert(name);
+    return matches;
+}
+
+static std::vector<std::shared_ptr<io::File>> load_test_files(
+    const size_t max_size)
+{
+    std::vector<std::shared_ptr<io::File>> files;
+    for (const auto &path : io::recursive_directory_range("tests/dec"))
+    {
+        if (!io::is_regular_file(path)
+            || path.str().find("/files/") == std::string::npos
+            || io::FileByteStream(path, io::FileMode::Read).size() > max_size)
+        {
+            continue;
+        }
+        io::File file(path, io::FileMode::Read);
+        files.push_back(std::make_shared<io::File>(
+            path, file.stream.seek(0).read_to_eof()));
+    }
+    return files;
+}
+
+TEST_CASE("Decoder recognition index", "[dec]")
+{
+    auto registry = Registry::create_mock();
+    const auto add_decoder = [&](
+        const std::string &name,
+        const std::vector<RecognitionSignature> &signatures)
+    {
+        registry->add_decoder(
+            name,
+            [=]() { return std::make_shared<TestFileDecoder>(signatures); });
+    };
+    add_decoder("magic", {RecognitionSignature::magic("ABC"_b)});
+    add_decoder("offset-magic", {RecognitionSignature::magic("XY"_b, 4)});
+    add_decoder("extension", {RecognitionSignature::extension("ext")});
+    add_decoder("unindexed", {});
+    add_decoder(
+        "any-of",
+        {
+            RecognitionSignature::magic("ABD"_b),
+            RecognitionSignature::extension(".bin"),
+        });
+
+    const auto names = registry->get_decoder_names();
+    const std::set<std::string> all_names(names.begin(), names.end());
+    const auto candidates = [&](io::File &&file)
+    {
+        return registry->get_recognition_candidates(file, all_names);
+    };
+
+    SECTION("Magic at the beginning")
+    {
+        REQUIRE(candidates(io::File("test.dat", "ABCxXYz"_b))
+            == std::set<std::string>({"magic", "offset-magic", "unindexed"}));
+        REQUIRE(candidates(io::File("test.dat", "ABD"_b))
+            == std::set<std::string>({"any-of", "unindexed"}));
+    }
+
+    SECTION("Magic at an offset")
+    {
+        REQUIRE(candidates(io::File("test.dat", "....XY"_b))
+            == std::set<std::string>({"offset-magic", "unindexed"}));
+        REQUIRE(candidates(io::File("test.dat", "....X"_b))
+            == std::set<std::string>({"unindexed"}));
+    }
+
+    SECTION("Extensions")
+    {
+        REQUIRE(candidates(io::File("test.EXT", ""_b))
+            == std::set<std::string>({"extension", "unindexed"}));
+        REQUIRE(candidates(io::File("dir/test.bin", "AB"_b))
+            == std::set<std::string>({"any-of", "unindexed"}));
+    }
+
+    SECTION("Restricting to given decoders")
+    {
+        io::File file("test.ext", "ABC"_b);
+        REQUIRE(registry->get_recognition_candidates(file, {"magic"})
+            == std::set<std::string>({"magic"}));
+    }
+
+    SECTION("File position is preserved")
+    {
+        io::File file("test.ext", "ABC"_b);
+        file.stream.seek(2);
+        registry->get_recognition_candidates(file, all_names);
+        REQUIRE(file.stream.pos() == 2);
+    }
+}
+
+TEST_CASE("Decoder prototypes", "[dec]")
+{
+    auto registry = Registry::create_mock();
+    size_t created = 0;
+    const auto add_decoder = [&](
+        const std::string &name, const std::vector<std::string> &linked)
+    {
+        registry->add_decoder(name, [&created, linked]()
+        {
+            created++;
+            return std::make_shared<TestFileDecoder>(
+                std::vector<RecognitionSignature>(), linked);
+        });
+    };
+    add_decoder("a", {"b"});
+    add_decoder("b", {"c", "a"});
+    add_decoder("c", {});
+    add_decoder("d", {"c"});
+
+    SECTION("Prototypes are created once")
+    {
+        const auto prototype = registry->get_decoder_prototype("a");
+        REQUIRE(registry->get_decoder_prototype("a") == prototype);
+        REQUIRE(created == 1);
+        REQUIRE(registry->create_decoder("a") != prototype);
+        REQUIRE(created == 2);
+    }
+
+    SECTION("Unknown decoders")
+    {
+        REQUIRE_THROWS(registry->get_decoder_prototype("e"));
+    }
+
+    SECTION("Linked format closure")
+    {
+        REQUIRE(registry->get_linked_format_closure("a")
+            == std::set<std::string>({"a", "b", "c"}));
+        REQUIRE(registry->get_linked_format_closure("c").empty());
+        REQUIRE(registry->get_linked_format_closure("d")
+            == std::set<std::string>({"c"}));
+        const auto created_before = created;
+        REQUIRE(registry->get_linked_format_closure("a")
+            == std::set<std::string>({"a", "b", "c"}));
+        REQUIRE(created == created_before);
+    }
+}
+
+TEST_CASE("Decoder recognition index agrees with full scan", "[dec]")
+{
+    const auto &registry = Registry::instance();
+    const auto names = registry.get_decoder_names();
+    const std::set<std::string> all_names(names.begin(), names.end());
+    for (const auto &file : load_test_files(64 * 1024))
+    {
+        INFO(file->path.str());
+        const auto candidates
+            = registry.get_recognition_candidates(*file, all_names);
+        for (const auto &name : guess(registry, *file, all_names))
+            REQUIRE(candidates.find(name) != candidates.end());
+    }
+}
+
+TEST_CASE("Decoder guessing throughput", "[.benchmark][dec]")
+{
+    const auto &registry = Registry::instance();
+    const auto names = registry.get_decoder_names();
+    const std::set<std::string> all_names(names.begin(), names.end());
+
+    const auto test_files = load_test_files(16 * 1024);
+    REQUIRE(!test_files.empty());
+    std::vector<std::shared_ptr<io::File>> files;
+    for (const auto i : algo::range(10000))
+    {
+        const auto &test_file = test_files[i % test_files.size()];
+        auto path = test_file->path;
+        path.change_stem(algo::format("%s-%d", path.stem().c_str(), i));
+        files.push_back(std::make_shared<io::File>(
+            path, test_file->stream.seek(0).read_to_eof()));
+    }
+
+    size_t full_scan_matches = 0;
+    const auto full_scan_time = tests::measure_seconds([&]()
+    {
+        for (const auto &file : files)
+            full_scan_matches += guess(registry, *file, all_names).size();
+    });
+
+    size_t indexed_matches = 0;
+    const auto indexed_time = tests::measure_seconds([&]()
+    {
+        for (const auto &file : files)
+        {
+            const auto candidates
+                = registry.get_recognition_candidates(*file, all_names);
+            indexed_matches += guess(registry, *file, candidates).size();
+        }
+    });
+
+    REQUIRE(indexed_matches == full_scan_matches);
+    tests::report_throughput(
+        "full scan", files.size(), "files", full_scan_time);
+    tests::report_throughput(
+        "recognition index", files.size(), "files", indexed_time);
+}
+
+TEST_CASE("Linked decoder collection throughput", "[.benchmark][dec]")
+{
+    const auto &registry = Registry::instance();
+    const auto names = registry.get_decoder_names();
+    const auto iterations = 100;
+
+    size_t created_formats = 0;
+    const auto created_time = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+        {
+            for (const auto &name : names)
+            {
+                std::set<std::string> known_formats;
+                std::vector<std::shared_ptr<IDecoder>> decoders_to_inspect;
+                decoders_to_inspect.push_back(registry.create_decoder(name));
+                while (!decoders_to_inspect.empty())
+                {
+                    const auto decoder = decoders_to_inspect.back();
+                    decoders_to_inspect.pop_back();
+                    for (const auto &format : decoder->get_linked_formats())
+                    {
+                        if (known_formats.insert(format).second)
+                        {
+                            decoders_to_inspect.push_back(
+                                registry.create_decoder(format));
+                        }
+                    }
+                }
+                created_formats += known_formats.size();
+            }
+        }
+    });
+
+    size_t cached_formats = 0;
+    const auto cached_time = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+        {
+            for (const auto &name : names)
+            {
+                cached_formats
+                    += registry.get_linked_format_closure(name).size();
+            }
+        }
+    });
+
+    REQUIRE(cached_formats == created_formats);
+    tests::report_throughput(
+        "new decoders", iterations * names.size(), "lookups", created_time);
+    tests::report_throughput(
+        "cached closure", iterations * names.size(), "lookups", cached_time);
+}
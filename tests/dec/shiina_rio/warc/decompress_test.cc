@@ -0,0 +1,97 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "dec/shiina_rio/warc/decompress.h"
+#include "algo/range.h"
+#include "io/memory_byte_stream.h"
+#include "io/msb_bit_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::dec::shiina_rio;
+
+static void write_balanced_tree(io::MsbBitStream &output_stream, size_t depth)
+{
+    static u8 next_value = 0;
+    if (!depth)
+    {
+        output_stream.write(1, 0);
+        output_stream.write(8, next_value++);
+        return;
+    }
+    output_stream.write(1, 1);
+    write_balanced_tree(output_stream, depth - 1);
+    write_balanced_tree(output_stream, depth - 1);
+}
+
+TEST_CASE("ShiinaRio WARC YH1 decompression", "[dec]")
+{
+    // the tree 1 (0 'a') (0 'b') and 13 bits of data make the first word,
+    // which YH1 stores in little endian; the two trailing bytes get shifted
+    // into the end of the previous word
+    const auto input = "\x32\x4D\x4C\x98\xF0\x0F"_b;
+    const auto expected
+        = "abbabaabbaabaabaabbabaabbaababbbbaaaaaaaabbbb"_b;
+
+    SECTION("Plain")
+    {
+        tests::compare_binary(
+            warc::decompress_yh1(input, expected.size(), false), expected);
+    }
+
+    SECTION("Encrypted")
+    {
+        auto encrypted_input = input;
+        encrypted_input.get<u32>()[0] ^= 0x6393528E ^ 0x4B4D;
+        tests::compare_binary(
+            warc::decompress_yh1(encrypted_input, expected.size(), true),
+            expected);
+    }
+}
+
+TEST_CASE("ShiinaRio WARC YH1 decompression throughput", "[.benchmark][dec]")
+{
+    // with a balanced tree every byte encodes itself
+    bstr expected(16 * 1024 * 1024);
+    for (const auto i : algo::range(expected.size()))
+        expected[i] = i * 7 + (i >> 9);
+    io::MemoryByteStream bit_output;
+    {
+        io::MsbBitStream bit_stream(bit_output);
+        write_balanced_tree(bit_stream, 8);
+        for (const auto i : algo::range(expected.size()))
+            bit_stream.write(8, expected[i]);
+        bit_stream.write(31, 0);
+    }
+    auto input = bit_output.seek(0).read(bit_output.size() & ~3);
+    for (const auto i : algo::range(input.size() / 4))
+    {
+        auto &word = input.get<u32>()[i];
+        word = (word >> 24) | ((word >> 8) & 0xFF00)
+            | ((word << 8) & 0xFF0000) | (word << 24);
+    }
+
+    bstr actual;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        actual = warc::decompress_yh1(input, expected.size(), false);
+    });
+    REQUIRE(actual == expected);
+    tests::report_throughput("YH1", expected.size() / 1e6, "MB", seconds);
+}
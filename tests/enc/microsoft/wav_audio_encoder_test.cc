@@ -0,0 +1,149 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "enc/microsoft/wav_audio_encoder.h"
+#include "algo/range.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+using namespace au::enc::microsoft;
+
+namespace
+{
+    class TestSampleReader final : public res::BaseAudioSampleReader
+    {
+    public:
+        TestSampleReader(const bstr &samples, const size_t block_size);
+        bool read_block(bstr &output) override;
+
+    private:
+        const bstr samples;
+        const size_t block_size;
+        size_t offset;
+    };
+}
+
+TestSampleReader::TestSampleReader(
+    const bstr &samples, const size_t block_size)
+        : samples(samples), block_size(block_size), offset(0)
+{
+}
+
+bool TestSampleReader::read_block(bstr &output)
+{
+    if (offset >= samples.size())
+        return false;
+    output = samples.substr(offset, block_size);
+    offset += block_size;
+    return true;
+}
+
+static res::Audio create_audio()
+{
+    res::Audio audio;
+    audio.channel_count = 2;
+    audio.sample_rate = 22050;
+    audio.samples.resize(10000);
+    for (const auto i : algo::range(audio.samples.size()))
+        audio.samples[i] = i * 7;
+    audio.loops.push_back(res::AudioLoopInfo{100, 2000, 0});
+    return audio;
+}
+
+TEST_CASE("Microsoft WAV audio encoding", "[enc]")
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto encoder = WavAudioEncoder();
+    const auto input_audio = create_audio();
+    const auto expected_file
+        = encoder.encode(dummy_logger, input_audio, "test.dat");
+    const auto expected_data = expected_file->stream.seek(0).read_to_eof();
+
+    size_t open_count = 0;
+    res::StreamedAudio streamed_audio;
+    streamed_audio.audio = input_audio;
+    streamed_audio.audio.samples = ""_b;
+    streamed_audio.samples_size = input_audio.samples.size();
+    streamed_audio.open_samples = [&]()
+    {
+        open_count++;
+        return std::make_unique<TestSampleReader>(input_audio.samples, 999);
+    };
+    const auto output_file = encoder.encode_streamed(
+        dummy_logger, streamed_audio, "test.dat");
+
+    SECTION("Whole tracks")
+    {
+        REQUIRE(expected_file->path.name() == "test.wavloop");
+        REQUIRE(expected_data.substr(0, 4) == "RIFF"_b);
+        REQUIRE(expected_data.size() == 46 + 10000 + 8 + 36 + 24);
+    }
+
+    SECTION("Streamed tracks match whole tracks")
+    {
+        REQUIRE(output_file->path.name() == "test.wavloop");
+        REQUIRE(output_file->stream.size() == expected_data.size());
+        REQUIRE(open_count == 0);
+        tests::compare_binary(
+            output_file->stream.seek(0).read_to_eof(), expected_data);
+        REQUIRE(open_count == 1);
+    }
+
+    SECTION("Streamed tracks read in small chunks")
+    {
+        bstr actual_data;
+        while (output_file->stream.left())
+        {
+            actual_data += output_file->stream.read(
+                std::min<uoff_t>(37, output_file->stream.left()));
+        }
+        tests::compare_binary(actual_data, expected_data);
+        REQUIRE(open_count == 1);
+    }
+
+    SECTION("Seeking back into the samples starts decoding over")
+    {
+        const auto read_at = [&](const uoff_t offset)
+        {
+            return output_file->stream.seek(offset).read(100);
+        };
+        REQUIRE(read_at(5000) == expected_data.substr(5000, 100));
+        REQUIRE(read_at(3000) == expected_data.substr(3000, 100));
+        REQUIRE(open_count == 2);
+        REQUIRE(read_at(8000) == expected_data.substr(8000, 100));
+        REQUIRE(open_count == 2);
+    }
+
+    SECTION("Cloning streamed tracks")
+    {
+        output_file->stream.seek(4000);
+        const auto stream_copy = output_file->stream.clone();
+        REQUIRE(stream_copy->pos() == 4000);
+        REQUIRE(stream_copy->read_to_eof() == expected_data.substr(4000));
+    }
+
+    SECTION("Streamed tracks shorter than announced")
+    {
+        streamed_audio.samples_size++;
+        const auto bad_file = encoder.encode_streamed(
+            dummy_logger, streamed_audio, "test.dat");
+        REQUIRE_THROWS(bad_file->stream.seek(0).read_to_eof());
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "enc/png/png_image_encoder.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "dec/png/png_image_decoder.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/image_support.h"
+
+using namespace au;
+using namespace au::enc::png;
+
+static const std::vector<PngCompressionPreset> presets =
+{
+    PngCompressionPreset::Store,
+    PngCompressionPreset::Fast,
+    PngCompressionPreset::Balanced,
+    PngCompressionPreset::Small,
+};
+
+static res::Image get_tiled_test_image(const size_t width, const size_t height)
+{
+    const auto tile = tests::get_transparent_test_image();
+    res::Image output_image(width, height);
+    for (const auto y : algo::range(height))
+    for (const auto x : algo::range(width))
+    {
+        output_image.at(x, y)
+            = tile.at(x % tile.width(), (y * 3 + x / 5) % tile.height());
+    }
+    return output_image;
+}
+
+static void test_round_trip(
+    const PngImageEncoder &encoder, const res::Image &input_image)
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto decoder = dec::png::PngImageDecoder();
+    const auto output_file
+        = encoder.encode(dummy_logger, input_image, "test.dat");
+    REQUIRE(output_file->path.name() == "test.png");
+    const auto output_image = decoder.decode(dummy_logger, *output_file);
+    tests::compare_images(input_image, output_image);
+}
+
+TEST_CASE("PNG images encoding", "[enc]")
+{
+    SECTION("Presets")
+    {
+        const auto input_image = tests::get_transparent_test_image();
+        for (const auto preset : presets)
+            test_round_trip(PngImageEncoder(preset), input_image);
+    }
+
+    SECTION("Small images ignore thread count")
+    {
+        const auto input_image = tests::get_opaque_test_image();
+        test_round_trip(
+            PngImageEncoder(PngCompressionPreset::Fast, 4), input_image);
+    }
+
+    SECTION("Parallel encoding")
+    {
+        const auto input_image = get_tiled_test_image(1024, 1030);
+        REQUIRE(input_image.width() * input_image.height()
+            >= PngImageEncoder::parallel_min_pixels);
+        for (const auto preset : presets)
+            for (const auto thread_count : {2, 3})
+                test_round_trip(
+                    PngImageEncoder(preset, thread_count), input_image);
+    }
+}
+
+TEST_CASE("PNG encoding throughput", "[.benchmark][enc]")
+{
+    Logger dummy_logger;
+    dummy_logger.mute();
+    const auto input_image = get_tiled_test_image(4096, 3072);
+    const auto megapixels
+        = input_image.width() * input_image.height() / 1000000.0;
+    const auto iterations = 3;
+
+    for (const auto preset : presets)
+    for (const auto thread_count : {1, 4})
+    {
+        const auto encoder = PngImageEncoder(preset, thread_count);
+        uoff_t output_size = 0;
+        const auto seconds = tests::measure_seconds([&]()
+        {
+            for (const auto i : algo::range(iterations))
+            {
+                output_size = encoder.encode(
+                    dummy_logger, input_image, "test.dat")->stream.size();
+            }
+        });
+        tests::report_throughput(
+            algo::format(
+                "preset %d, %d thread(s), %d KB",
+                static_cast<int>(preset),
+                thread_count,
+                static_cast<int>(output_size / 1024)),
+            megapixels * iterations,
+            "MP",
+            seconds);
+    }
+}
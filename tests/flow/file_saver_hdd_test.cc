@@ -16,11 +16,71 @@
 // along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
 
 #include "flow/file_saver_hdd.h"
+#include <cstring>
+#include "err.h"
 #include "io/file_system.h"
+#include "io/mapped_file_byte_stream.h"
+#include "io/slice_byte_stream.h"
 #include "test_support/catch.h"
 
 using namespace au;
 
+namespace
+{
+    // Yields zeros, but fails once reading goes past the given offset, like
+    // a lazy stream running into corrupt data halfway through.
+    class FailingByteStream final : public io::BaseByteStream
+    {
+    public:
+        FailingByteStream(const uoff_t stream_size, const uoff_t fail_pos)
+            : stream_size(stream_size), fail_pos(fail_pos), stream_pos(0)
+        {
+        }
+
+        uoff_t size() const override { return stream_size; }
+        uoff_t pos() const override { return stream_pos; }
+
+        std::unique_ptr<io::BaseByteStream> clone() const override
+        {
+            std::unique_ptr<io::BaseByteStream> ret
+                = std::make_unique<FailingByteStream>(stream_size, fail_pos);
+            ret->seek(stream_pos);
+            return ret;
+        }
+
+    protected:
+        void read_impl(void *destination, const size_t size) override
+        {
+            if (stream_pos + size > fail_pos)
+                throw err::CorruptDataError("Broken stream");
+            std::memset(destination, 0, size);
+            stream_pos += size;
+        }
+
+        void write_impl(const void *, const size_t) override
+        {
+            throw err::NotSupportedError("Not implemented");
+        }
+
+        void seek_impl(const uoff_t offset) override
+        {
+            if (offset > stream_size)
+                throw err::EofError();
+            stream_pos = offset;
+        }
+
+        void resize_impl(const uoff_t) override
+        {
+            throw err::NotSupportedError("Not implemented");
+        }
+
+    private:
+        const uoff_t stream_size;
+        const uoff_t fail_pos;
+        uoff_t stream_pos;
+    };
+}
+
 static void do_test(const io::path &path)
 {
     const flow::FileSaverHdd file_saver(".", true);
@@ -74,6 +134,47 @@ TEST_CASE("FileSaver", "[core]")
         do_test(u8"不用意な変換.out");
     }
 
+    SECTION("Streaming slices of other files")
+    {
+        const io::path input_path
+            = "tests/dec/png/files/reimu_transparent.png";
+        const io::path output_path = "test.out";
+        io::MappedFileByteStream input_stream(input_path);
+        const auto expected = input_stream.seek(8).read(100);
+        for (const auto use_mapping : {true, false})
+        {
+            INFO("Mapped input: " << use_mapping);
+            std::unique_ptr<io::BaseByteStream> source_stream;
+            if (use_mapping)
+                source_stream = input_stream.clone();
+            else
+                source_stream = std::make_unique<io::FileByteStream>(
+                    input_path, io::FileMode::Read);
+            const auto file = std::make_shared<io::File>(
+                output_path.str(),
+                std::make_unique<io::SliceByteStream>(*source_stream, 8, 100));
+            const flow::FileSaverHdd file_saver(".", true);
+            file_saver.save(file);
+            {
+                io::FileByteStream file_stream(
+                    output_path, io::FileMode::Read);
+                REQUIRE(file_stream.read_to_eof() == expected);
+            }
+            io::remove(output_path);
+        }
+    }
+
+    SECTION("Streams failing halfway leave no file behind")
+    {
+        const io::path output_path = "test.out";
+        const auto file = std::make_shared<io::File>(
+            output_path.str(),
+            std::make_unique<FailingByteStream>(200 * 1024, 100 * 1024));
+        const flow::FileSaverHdd file_saver(".", true);
+        REQUIRE_THROWS(file_saver.save(file));
+        REQUIRE(!io::exists(output_path));
+    }
+
     SECTION("Two file savers overwrite the same file")
     {
         const flow::FileSaverHdd file_saver1(".", true);
@@ -0,0 +1,258 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "dec/base_archive_decoder.h"
+#include "dec/base_file_decoder.h"
+#include "flow/configured_decoder_cache.h"
+#include "io/memory_byte_stream.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+#include "test_support/flow_support.h"
+
+using namespace au;
+using namespace au::dec;
+
+namespace
+{
+    class TestFileDecoder final : public BaseFileDecoder
+    {
+    public:
+        TestFileDecoder(std::atomic<size_t> &parse_count);
+
+    protected:
+        bool is_recognized_impl(io::File &input_file) const override;
+
+        std::unique_ptr<io::File> decode_impl(
+            const Logger &logger, io::File &input_file) const override;
+
+    private:
+        std::string suffix;
+    };
+
+    class TestArchiveDecoder final : public BaseArchiveDecoder
+    {
+    public:
+        std::vector<std::string> get_linked_formats() const override;
+
+    protected:
+        bool is_recognized_impl(io::File &input_file) const override;
+
+        std::unique_ptr<ArchiveMeta> read_meta_impl(
+            const Logger &logger, io::File &input_file) const override;
+
+        std::unique_ptr<io::File> read_file_impl(
+            const Logger &logger,
+            io::File &input_file,
+            const ArchiveMeta &m,
+            const ArchiveEntry &e) const override;
+    };
+}
+
+TestFileDecoder::TestFileDecoder(std::atomic<size_t> &parse_count)
+{
+    add_arg_parser_decorator(
+        [](ArgParser &arg_parser)
+        {
+            arg_parser.register_switch({"--suffix"})
+                ->set_value_name("TEXT")
+                ->set_description("Text to append to decoded files.");
+        },
+        [&](const ArgParser &arg_parser)
+        {
+            parse_count++;
+            if (arg_parser.has_switch("suffix"))
+                suffix = arg_parser.get_switch("suffix");
+        });
+}
+
+bool TestFileDecoder::is_recognized_impl(io::File &input_file) const
+{
+    return input_file.path.has_extension("txt");
+}
+
+std::unique_ptr<io::File> TestFileDecoder::decode_impl(
+    const Logger &logger, io::File &input_file) const
+{
+    auto output_file = std::make_unique<io::File>(
+        input_file.path, input_file.stream.seek(0).read_to_eof());
+    output_file->stream.seek(output_file->stream.size()).write(suffix);
+    output_file->path.change_extension("out");
+    return output_file;
+}
+
+std::vector<std::string> TestArchiveDecoder::get_linked_formats() const
+{
+    return {"test/test-file"};
+}
+
+bool TestArchiveDecoder::is_recognized_impl(io::File &input_file) const
+{
+    return input_file.path.has_extension("arc");
+}
+
+std::unique_ptr<ArchiveMeta> TestArchiveDecoder::read_meta_impl(
+    const Logger &logger, io::File &input_file) const
+{
+    input_file.stream.seek(0);
+    auto meta = std::make_unique<ArchiveMeta>();
+    while (input_file.stream.left())
+    {
+        auto entry = std::make_unique<PlainArchiveEntry>();
+        entry->path = input_file.stream.read_to_zero().str();
+        entry->size = input_file.stream.read_le<u32>();
+        entry->offset = input_file.stream.pos();
+        input_file.stream.skip(entry->size);
+        meta->entries.push_back(std::move(entry));
+    }
+    return meta;
+}
+
+std::unique_ptr<io::File> TestArchiveDecoder::read_file_impl(
+    const Logger &logger,
+    io::File &input_file,
+    const ArchiveMeta &m,
+    const ArchiveEntry &e) const
+{
+    return read_plain_file(
+        input_file, static_cast<const PlainArchiveEntry&>(e));
+}
+
+static std::unique_ptr<Registry> create_registry(
+    std::atomic<size_t> &parse_count)
+{
+    auto registry = Registry::create_mock();
+    registry->add_decoder(
+        "test/test-archive",
+        []() { return std::make_shared<TestArchiveDecoder>(); });
+    registry->add_decoder(
+        "test/test-file",
+        [&]() { return std::make_shared<TestFileDecoder>(parse_count); });
+    return registry;
+}
+
+static std::unique_ptr<io::File> make_archive(const size_t file_count)
+{
+    io::MemoryByteStream archive_stream;
+    for (const auto i : algo::range(file_count))
+    {
+        archive_stream.write(algo::format("%05d.txt", i));
+        archive_stream.write<u8>(0);
+        archive_stream.write_le<u32>(4);
+        archive_stream.write("text"_b);
+    }
+    return std::make_unique<io::File>(
+        "archive.arc", archive_stream.seek(0).read_to_eof());
+}
+
+TEST_CASE("Decoder options", "[flow]")
+{
+    std::atomic<size_t> parse_count(0);
+    const auto registry = create_registry(parse_count);
+    const auto archive_file = make_archive(10);
+    const auto saved_files = tests::flow_unpack(
+        *registry, true, *archive_file, {"--suffix=!"});
+
+    REQUIRE(saved_files.size() == 10);
+    for (const auto &saved_file : saved_files)
+        REQUIRE(saved_file->stream.read_to_eof() == "text!"_b);
+    REQUIRE(parse_count == 1);
+}
+
+TEST_CASE("Throttled unpacking", "[flow]")
+{
+    std::atomic<size_t> parse_count(0);
+    const auto registry = create_registry(parse_count);
+    const auto archive_file = make_archive(100);
+
+    SECTION("Limited tasks in flight")
+    {
+        const auto saved_files = tests::flow_unpack(
+            *registry, true, *archive_file, {}, 2, 0);
+        REQUIRE(saved_files.size() == 100);
+    }
+
+    SECTION("Limited memory")
+    {
+        const auto saved_files = tests::flow_unpack(
+            *registry, true, *archive_file, {}, 0, 1);
+        REQUIRE(saved_files.size() == 100);
+    }
+}
+
+TEST_CASE("Nested decoding throughput", "[.benchmark][flow]")
+{
+    std::atomic<size_t> parse_count(0);
+    const auto registry = create_registry(parse_count);
+    const auto file_count = 20000;
+    const auto archive_file = make_archive(file_count);
+    size_t saved_file_count = 0;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        saved_file_count = tests::flow_unpack(
+            *registry, true, *archive_file, {"--suffix=!"}).size();
+    });
+    REQUIRE(saved_file_count == file_count);
+    tests::report_throughput("nested decoding", file_count, "files", seconds);
+}
+
+TEST_CASE("Decoder option resolution throughput", "[.benchmark][flow]")
+{
+    const auto &registry = Registry::instance();
+    const auto names = registry.get_decoder_names();
+    const std::vector<std::string> arguments = {"--dec=test", "input.arc"};
+    const auto iterations = 20;
+
+    const auto parsing_seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+        {
+            for (const auto &name : names)
+            {
+                const auto decoder = registry.create_decoder(name);
+                ArgParser decoder_arg_parser;
+                const auto decorators = decoder->get_arg_parser_decorators();
+                for (const auto &decorator : decorators)
+                    decorator.register_cli_options(decoder_arg_parser);
+                decoder_arg_parser.parse(arguments);
+                for (const auto &decorator : decorators)
+                    decorator.parse_cli_options(decoder_arg_parser);
+            }
+        }
+    });
+
+    const flow::ConfiguredDecoderCache configured_decoders(registry, arguments);
+    const auto cached_seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(iterations))
+            for (const auto &name : names)
+                configured_decoders.get_decoder(name);
+    });
+
+    tests::report_throughput(
+        "parsing per task",
+        iterations * names.size(),
+        "tasks",
+        parsing_seconds);
+    tests::report_throughput(
+        "cached decoders",
+        iterations * names.size(),
+        "tasks",
+        cached_seconds);
+}
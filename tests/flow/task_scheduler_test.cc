@@ -0,0 +1,337 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/task_scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "algo/format.h"
+#include "algo/range.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::flow;
+
+namespace
+{
+    // The scheduler that used to sit in flow/task_scheduler.cc: one shared
+    // deque and idle workers polling it every 10 ms. Kept only as the
+    // baseline for the benchmark below.
+    class PollingTaskScheduler final
+    {
+    public:
+        TaskSchedulerResult run(const size_t number_of_threads);
+        void push_front(std::shared_ptr<ITask> task);
+        void push_back(std::shared_ptr<ITask> task);
+
+    private:
+        std::mutex mutex;
+        std::deque<std::shared_ptr<ITask>> tasks;
+    };
+
+    template<typename T> struct CountingTask final : public ITask
+    {
+        CountingTask(
+            T &scheduler,
+            std::atomic<int> &counter,
+            const size_t fanout,
+            const size_t depth,
+            const bool success = true);
+
+        bool work() const override;
+
+        T &scheduler;
+        std::atomic<int> &counter;
+        const size_t fanout;
+        const size_t depth;
+        const bool success;
+    };
+
+    struct RecordingTask final : public ITask
+    {
+        RecordingTask(
+            TaskScheduler &scheduler,
+            std::mutex &mutex,
+            std::vector<std::string> &log,
+            const std::string &name,
+            const bool spawn_child);
+
+        bool work() const override;
+
+        TaskScheduler &scheduler;
+        std::mutex &mutex;
+        std::vector<std::string> &log;
+        const std::string name;
+        const bool spawn_child;
+    };
+}
+
+void PollingTaskScheduler::push_front(std::shared_ptr<ITask> task)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks.push_front(task);
+}
+
+void PollingTaskScheduler::push_back(std::shared_ptr<ITask> task)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks.push_back(task);
+}
+
+TaskSchedulerResult PollingTaskScheduler::run(const size_t number_of_threads)
+{
+    TaskSchedulerResult result;
+    result.success_count = 0;
+    result.error_count = 0;
+    bool still_running = true;
+
+    std::vector<std::unique_ptr<std::thread>> threads;
+    for (const auto i : algo::range(number_of_threads))
+    {
+        threads.push_back(std::make_unique<std::thread>([&]()
+        {
+            while (true)
+            {
+                std::shared_ptr<ITask> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (tasks.empty())
+                    {
+                        if (still_running && number_of_threads > 1)
+                        {
+                            lock.unlock();
+                            std::this_thread::sleep_for(
+                                std::chrono::milliseconds(10));
+                            continue;
+                        }
+                        break;
+                    }
+                    task = tasks.front();
+                    tasks.pop_front();
+                }
+
+                const auto local_success = task->work();
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    result.success_count += local_success;
+                    result.error_count += !local_success;
+                    still_running = !tasks.empty();
+                }
+            }
+        }));
+    }
+
+    for (auto &t : threads)
+        t->join();
+
+    return result;
+}
+
+template<typename T> CountingTask<T>::CountingTask(
+    T &scheduler,
+    std::atomic<int> &counter,
+    const size_t fanout,
+    const size_t depth,
+    const bool success)
+        : scheduler(scheduler),
+            counter(counter),
+            fanout(fanout),
+            depth(depth),
+            success(success)
+{
+}
+
+template<typename T> bool CountingTask<T>::work() const
+{
+    ++counter;
+    if (depth)
+    {
+        for (const auto i : algo::range(fanout))
+        {
+            scheduler.push_front(
+                std::make_shared<CountingTask<T>>(
+                    scheduler, counter, fanout, depth - 1, success));
+        }
+    }
+    return success;
+}
+
+RecordingTask::RecordingTask(
+    TaskScheduler &scheduler,
+    std::mutex &mutex,
+    std::vector<std::string> &log,
+    const std::string &name,
+    const bool spawn_child)
+        : scheduler(scheduler),
+            mutex(mutex),
+            log(log),
+            name(name),
+            spawn_child(spawn_child)
+{
+}
+
+bool RecordingTask::work() const
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        log.push_back(name);
+    }
+    if (spawn_child)
+    {
+        scheduler.push_front(
+            std::make_shared<RecordingTask>(
+                scheduler, mutex, log, name + "/child", false));
+    }
+    return true;
+}
+
+// 1 + fanout + fanout^2 + ... + fanout^depth
+static int count_tasks(const size_t fanout, const size_t depth)
+{
+    int total = 0;
+    int level = 1;
+    for (const auto i : algo::range(depth + 1))
+    {
+        total += level;
+        level *= fanout;
+    }
+    return total;
+}
+
+template<typename T> static TaskSchedulerResult run_tree(
+    const size_t thread_count,
+    const size_t root_count,
+    const size_t fanout,
+    const size_t depth,
+    std::atomic<int> &counter)
+{
+    T scheduler;
+    for (const auto i : algo::range(root_count))
+    {
+        scheduler.push_back(
+            std::make_shared<CountingTask<T>>(
+                scheduler, counter, fanout, depth));
+    }
+    return scheduler.run(thread_count);
+}
+
+TEST_CASE("TaskScheduler", "[flow]")
+{
+    SECTION("Runs every task that was queued before starting")
+    {
+        TaskScheduler scheduler;
+        std::atomic<int> counter(0);
+        for (const auto i : algo::range(50))
+        {
+            scheduler.push_back(
+                std::make_shared<CountingTask<TaskScheduler>>(
+                    scheduler, counter, 0, 0, i % 5 != 0));
+        }
+        const auto result = scheduler.run(4);
+        REQUIRE(counter == 50);
+        REQUIRE(result.success_count == 40);
+        REQUIRE(result.error_count == 10);
+    }
+
+    SECTION("Waits for nested tasks pushed by running tasks")
+    {
+        for (const auto thread_count : {1, 2, 8})
+        {
+            INFO("Thread count: " << thread_count);
+            std::atomic<int> counter(0);
+            const auto result = run_tree<TaskScheduler>(
+                thread_count, 4, 4, 4, counter);
+            REQUIRE(counter == 4 * count_tasks(4, 4));
+            REQUIRE(result.success_count == counter);
+            REQUIRE(result.error_count == 0);
+        }
+    }
+
+    SECTION("Runs nested tasks before queued input with a single thread")
+    {
+        TaskScheduler scheduler;
+        std::mutex mutex;
+        std::vector<std::string> log;
+        scheduler.push_back(
+            std::make_shared<RecordingTask>(
+                scheduler, mutex, log, "first", true));
+        scheduler.push_back(
+            std::make_shared<RecordingTask>(
+                scheduler, mutex, log, "second", true));
+        scheduler.run(1);
+        REQUIRE(log.size() == 4);
+        REQUIRE(log[0] == "first");
+        REQUIRE(log[1] == "first/child");
+        REQUIRE(log[2] == "second");
+        REQUIRE(log[3] == "second/child");
+    }
+
+    SECTION("Finishes immediately when there is nothing to do")
+    {
+        TaskScheduler scheduler;
+        const auto result = scheduler.run(8);
+        REQUIRE(result.success_count == 0);
+        REQUIRE(result.error_count == 0);
+    }
+}
+
+TEST_CASE("TaskScheduler throughput", "[.benchmark][flow]")
+{
+    const size_t root_count = 64;
+    const size_t fanout = 8;
+    const size_t depth = 4;
+    const auto task_count = root_count * count_tasks(fanout, depth);
+    const auto max_threads = std::max<size_t>(
+        std::thread::hardware_concurrency(), 1);
+
+    for (size_t thread_count = 1; ; thread_count *= 2)
+    {
+        thread_count = std::min(thread_count, max_threads);
+
+        std::atomic<int> polling_counter(0);
+        const auto polling_time = tests::measure_seconds([&]()
+        {
+            run_tree<PollingTaskScheduler>(
+                thread_count, root_count, fanout, depth, polling_counter);
+        });
+
+        std::atomic<int> stealing_counter(0);
+        const auto stealing_time = tests::measure_seconds([&]()
+        {
+            run_tree<TaskScheduler>(
+                thread_count, root_count, fanout, depth, stealing_counter);
+        });
+
+        REQUIRE(polling_counter == static_cast<int>(task_count));
+        REQUIRE(stealing_counter == static_cast<int>(task_count));
+        tests::report_throughput(
+            algo::format("polling (%d threads)", thread_count),
+            task_count, "tasks", polling_time);
+        tests::report_throughput(
+            algo::format("work stealing (%d threads)", thread_count),
+            task_count, "tasks", stealing_time);
+
+        if (thread_count == max_threads)
+            break;
+    }
+}
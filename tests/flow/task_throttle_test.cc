@@ -0,0 +1,100 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/task_throttle.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::flow;
+
+TEST_CASE("TaskThrottle", "[flow]")
+{
+    SECTION("Unlimited")
+    {
+        TaskThrottle task_throttle(0, 0);
+        size_t produced = 0;
+        task_throttle.add_producer([&]()
+        {
+            task_throttle.acquire(1000);
+            return ++produced < 100;
+        });
+        REQUIRE(produced == 100);
+        REQUIRE(task_throttle.get_inflight_tasks() == 100);
+        REQUIRE(task_throttle.get_used_memory() == 100000);
+    }
+
+    SECTION("Task limit")
+    {
+        TaskThrottle task_throttle(3, 0);
+        size_t produced = 0;
+        task_throttle.add_producer([&]()
+        {
+            task_throttle.acquire();
+            return ++produced < 10;
+        });
+        REQUIRE(produced == 3);
+        task_throttle.release();
+        REQUIRE(produced == 4);
+        task_throttle.release();
+        task_throttle.release();
+        REQUIRE(produced == 6);
+        REQUIRE(task_throttle.get_inflight_tasks() == 3);
+        while (task_throttle.get_inflight_tasks())
+            task_throttle.release();
+        REQUIRE(produced == 10);
+    }
+
+    SECTION("Memory limit")
+    {
+        TaskThrottle task_throttle(0, 1000);
+        size_t produced = 0;
+        task_throttle.add_producer([&]()
+        {
+            task_throttle.acquire(400);
+            return ++produced < 10;
+        });
+        REQUIRE(produced == 3);
+        REQUIRE(task_throttle.get_used_memory() == 1200);
+        task_throttle.release(400);
+        REQUIRE(produced == 4);
+        task_throttle.release(100);
+        REQUIRE(produced == 4);
+        task_throttle.release(300);
+        REQUIRE(produced == 5);
+    }
+
+    SECTION("Producers run in order")
+    {
+        TaskThrottle task_throttle(1, 0);
+        std::string log;
+        task_throttle.acquire();
+        for (const auto name : {'a', 'b'})
+        {
+            auto count = 0;
+            task_throttle.add_producer([&, name, count]() mutable
+            {
+                task_throttle.acquire();
+                log += name;
+                return ++count < 2;
+            });
+        }
+        REQUIRE(log.empty());
+        for (auto i = 0; i < 4; i++)
+            task_throttle.release();
+        REQUIRE(log == "aabb");
+    }
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/unpacking_stats.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::flow;
+
+static bool contains(const std::string &haystack, const std::string &needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+
+TEST_CASE("UnpackingStats", "[flow]")
+{
+    SECTION("Collecting")
+    {
+        const UnpackingStats stats(true);
+        stats.add_input_file("test/archive", 1000);
+        stats.add_time("test/archive", UnpackingStage::ReadMeta, 0.5);
+        stats.add_time("test/archive", UnpackingStage::ReadFile, 0.25);
+        stats.add_time("test/archive", UnpackingStage::ReadFile, 0.25);
+        stats.add_output_file("test/archive", 300);
+        stats.add_output_file("test/archive", 400);
+        stats.add_time("(unrecognized)", UnpackingStage::Guess, 1);
+        stats.set_peak_queue_depth(5);
+        stats.set_peak_queue_depth(3);
+        stats.add_vfs_cache_lookup(false);
+        stats.add_vfs_cache_lookup(true);
+        stats.add_vfs_cache_lookup(true);
+        REQUIRE(stats.measure(
+            "test/image", UnpackingStage::Decode, []() { return 5; }) == 5);
+
+        const auto json = stats.to_json();
+        REQUIRE(contains(json, "\"peak_queue_depth\": 5,"));
+        REQUIRE(contains(json, "\"vfs_cache_hits\": 2,"));
+        REQUIRE(contains(json, "\"vfs_cache_misses\": 1,"));
+        REQUIRE(contains(json,
+            "\"total\": {\"input_files\": 1, \"output_files\": 2, "
+            "\"input_bytes\": 1000, \"output_bytes\": 700, "
+            "\"seconds\": {\"guess\": 1.000000, \"read_meta\": 0.500000, "
+            "\"read_file\": 0.500000, "));
+        REQUIRE(contains(json,
+            "\"test/archive\": {\"input_files\": 1, \"output_files\": 2, "
+            "\"input_bytes\": 1000, \"output_bytes\": 700, "
+            "\"seconds\": {\"guess\": 0.000000, \"read_meta\": 0.500000, "
+            "\"read_file\": 0.500000, \"decode\": 0.000000, "
+            "\"encode\": 0.000000, \"save\": 0.000000}}"));
+        REQUIRE(contains(json,
+            "\"(unrecognized)\": {\"input_files\": 0, \"output_files\": 0, "
+            "\"input_bytes\": 0, \"output_bytes\": 0, "
+            "\"seconds\": {\"guess\": 1.000000, "));
+        REQUIRE(contains(json, "\"test/image\": {"));
+    }
+
+    SECTION("Disabled")
+    {
+        const UnpackingStats stats(false);
+        REQUIRE(!stats.is_enabled());
+        stats.add_input_file("test/archive", 1000);
+        stats.add_time("test/archive", UnpackingStage::ReadMeta, 0.5);
+        stats.set_peak_queue_depth(5);
+        stats.add_vfs_cache_lookup(true);
+        const auto json = stats.to_json();
+        REQUIRE(contains(json, "\"peak_queue_depth\": 0,"));
+        REQUIRE(contains(json, "\"vfs_cache_hits\": 0,"));
+        REQUIRE(contains(json, "\"decoders\": {}"));
+    }
+}
@@ -0,0 +1,176 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "flow/vfs_bridge.h"
+#include "test_support/catch.h"
+
+using namespace au;
+using namespace au::dec;
+
+namespace
+{
+    class TestArchiveDecoder final : public BaseArchiveDecoder
+    {
+    public:
+        TestArchiveDecoder();
+
+        mutable size_t read_count;
+        std::function<void()> read_callback;
+
+    protected:
+        bool is_recognized_impl(io::File &input_file) const override;
+
+        std::unique_ptr<ArchiveMeta> read_meta_impl(
+            const Logger &logger, io::File &input_file) const override;
+
+        std::unique_ptr<io::File> read_file_impl(
+            const Logger &logger,
+            io::File &input_file,
+            const ArchiveMeta &m,
+            const ArchiveEntry &e) const override;
+    };
+}
+
+TestArchiveDecoder::TestArchiveDecoder() : read_count(0)
+{
+}
+
+bool TestArchiveDecoder::is_recognized_impl(io::File &input_file) const
+{
+    return true;
+}
+
+std::unique_ptr<ArchiveMeta> TestArchiveDecoder::read_meta_impl(
+    const Logger &logger, io::File &input_file) const
+{
+    auto meta = std::make_unique<ArchiveMeta>();
+    for (const auto &name : {"small.txt", "large.txt"})
+    {
+        auto entry = std::make_unique<ArchiveEntry>();
+        entry->path = name;
+        meta->entries.push_back(std::move(entry));
+    }
+    return meta;
+}
+
+std::unique_ptr<io::File> TestArchiveDecoder::read_file_impl(
+    const Logger &logger,
+    io::File &input_file,
+    const ArchiveMeta &m,
+    const ArchiveEntry &e) const
+{
+    read_count++;
+    if (read_callback)
+        read_callback();
+    const auto size = e.path.name() == "large.txt" ? 100 : 10;
+    return std::make_unique<io::File>(e.path, bstr(size, 'x'));
+}
+
+TEST_CASE("VirtualFileSystemBridge", "[flow]")
+{
+    const Logger dummy_logger;
+    const flow::UnpackingStats stats(true);
+    const auto decoder = std::make_shared<TestArchiveDecoder>();
+    const auto input_file = std::make_shared<io::File>("test.arc", ""_b);
+    const auto meta = std::shared_ptr<ArchiveMeta>(
+        decoder->read_meta(dummy_logger, *input_file));
+
+    // The cache budget is global, so restore it for other tests.
+    struct CacheSizeGuard final
+    {
+        CacheSizeGuard()
+        {
+            flow::VirtualFileSystemBridge::set_cache_size(50);
+        }
+
+        ~CacheSizeGuard()
+        {
+            flow::VirtualFileSystemBridge::reset_cache_size();
+        }
+    } cache_size_guard;
+
+    auto bridge = std::make_unique<flow::VirtualFileSystemBridge>(
+        dummy_logger, *decoder, meta, input_file, "test.arc", stats);
+
+    SECTION("Repeated lookups are served from the cache")
+    {
+        for (const auto i : {0, 1, 2})
+        {
+            const auto file = VirtualFileSystem::get_by_name("small.txt");
+            REQUIRE(file);
+            REQUIRE(file->path.name() == "small.txt");
+            REQUIRE(file->stream.read_to_eof() == bstr(10, 'x'));
+        }
+        REQUIRE(decoder->read_count == 1);
+        REQUIRE(stats.to_json().find("\"vfs_cache_hits\": 2,")
+            != std::string::npos);
+        REQUIRE(stats.to_json().find("\"vfs_cache_misses\": 1,")
+            != std::string::npos);
+    }
+
+    SECTION("Files over the budget are not cached")
+    {
+        VirtualFileSystem::get_by_name("large.txt");
+        VirtualFileSystem::get_by_name("large.txt");
+        REQUIRE(decoder->read_count == 2);
+    }
+
+    SECTION("All bridges share one cache budget")
+    {
+        const auto other_meta = std::shared_ptr<ArchiveMeta>(
+            decoder->read_meta(dummy_logger, *input_file));
+        for (auto &entry : other_meta->entries)
+            entry->path = "other-" + entry->path.str();
+        const flow::VirtualFileSystemBridge other_bridge(
+            dummy_logger, *decoder, other_meta, input_file, "test.arc", stats);
+
+        flow::VirtualFileSystemBridge::set_cache_size(15);
+        VirtualFileSystem::get_by_name("small.txt");
+        VirtualFileSystem::get_by_name("other-small.txt");
+        REQUIRE(decoder->read_count == 2);
+        VirtualFileSystem::get_by_name("other-small.txt");
+        REQUIRE(decoder->read_count == 2);
+        VirtualFileSystem::get_by_name("small.txt");
+        REQUIRE(decoder->read_count == 3);
+    }
+
+    SECTION("Destroying the bridge unregisters its files")
+    {
+        REQUIRE(VirtualFileSystem::get_by_name("small.txt"));
+        bridge.reset();
+        REQUIRE(!VirtualFileSystem::get_by_name("small.txt"));
+    }
+
+    SECTION("Running factories outlive the bridge")
+    {
+        bridge.reset();
+        auto own_decoder = std::make_shared<TestArchiveDecoder>();
+        const std::weak_ptr<TestArchiveDecoder> weak_decoder = own_decoder;
+        bridge = std::make_unique<flow::VirtualFileSystemBridge>(
+            dummy_logger, *own_decoder, meta, input_file, "test.arc", stats);
+        own_decoder->read_callback = [&]()
+        {
+            bridge.reset();
+            REQUIRE(!weak_decoder.expired());
+        };
+        own_decoder.reset();
+        const auto file = VirtualFileSystem::get_by_name("small.txt");
+        REQUIRE(file);
+        REQUIRE(file->stream.read_to_eof() == bstr(10, 'x'));
+        REQUIRE(weak_decoder.expired());
+    }
+}
@@ -19,6 +19,7 @@
 #include "io/lsb_bit_stream.h"
 #include "io/memory_byte_stream.h"
 #include "io/msb_bit_stream.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 
 using namespace au;
@@ -428,6 +429,126 @@ template<class T> static void test_retracting()
     }
 }
 
+template<class T> static void test_peeking(const TestType type)
+{
+    SECTION("Peeking")
+    {
+        SECTION("Peeking doesn't consume bits")
+        {
+            T reader(from_bits({0b11001100, 0b10101010}));
+            reader.read(2);
+            const auto peeked = reader.peek(9);
+            REQUIRE((reader.pos() == 2));
+            REQUIRE((reader.read(9) == peeked));
+            REQUIRE((peeked == (type == TestType::Msb
+                ? 0b001100101
+                : 0b010110011)));
+        }
+
+        SECTION("Peeking beyond EOF pads with zeros")
+        {
+            T reader(from_bits({0b11001100}));
+            reader.read(4);
+            REQUIRE((reader.peek(8) == (type == TestType::Msb
+                ? 0b11000000
+                : 0b00001100)));
+            REQUIRE((reader.pos() == 4));
+            REQUIRE_THROWS(reader.read(8));
+        }
+
+        SECTION("Peeking from borrowed streams")
+        {
+            io::MemoryByteStream stream(from_bits({0b11001100, 0b10101010}));
+            T reader(stream);
+            REQUIRE((reader.peek(4) == (type == TestType::Msb
+                ? 0b1100
+                : 0b1100)));
+            REQUIRE((stream.pos() == 1));
+            REQUIRE((reader.peek(12) == (type == TestType::Msb
+                ? 0b110011001010
+                : 0b101011001100)));
+            REQUIRE((reader.peek(20) == (type == TestType::Msb
+                ? 0b11001100101010100000
+                : 0b00001010101011001100)));
+        }
+    }
+
+    SECTION("Skipping forward")
+    {
+        T reader(from_bits(
+            {0b11001100, 0b10101010, 0b11110000, 0b00110011, 0b01010101,
+             0b11001100, 0b10101010, 0b11110000, 0b00110011, 0b01010101}));
+        reader.skip(3);
+        REQUIRE((reader.pos() == 3));
+        reader.skip(40);
+        REQUIRE((reader.pos() == 43));
+        REQUIRE((reader.read(5) == (type == TestType::Msb
+            ? 0b01100
+            : 0b11001)));
+        REQUIRE_THROWS(reader.skip(33));
+        REQUIRE((reader.pos() == 48));
+        reader.skip(32);
+        REQUIRE((reader.left() == 0));
+    }
+}
+
+template<class T> static void test_word_refill()
+{
+    SECTION("Reading owned buffers matches reading borrowed streams")
+    {
+        bstr input(1000);
+        u32 seed = 1;
+        for (const auto i : algo::range(input.size()))
+        {
+            seed = seed * 1103515245 + 12345;
+            input[i] = seed >> 16;
+        }
+
+        io::MemoryByteStream stream(input);
+        T borrowed_reader(stream);
+        T owned_reader(input);
+        while (borrowed_reader.left())
+        {
+            seed = seed * 1103515245 + 12345;
+            const auto bits = std::min<size_t>(
+                (seed >> 16) % 33, borrowed_reader.left());
+            REQUIRE((owned_reader.peek(bits) == borrowed_reader.peek(bits)));
+            REQUIRE((owned_reader.read(bits) == borrowed_reader.read(bits)));
+            REQUIRE((owned_reader.pos() == borrowed_reader.pos()));
+        }
+        REQUIRE(!owned_reader.left());
+        REQUIRE_THROWS(owned_reader.read(1));
+    }
+}
+
+template<class T> static void test_writing_after_reading()
+{
+    SECTION("Writing after reading owned buffers matches borrowed streams")
+    {
+        const auto input =
+            "\x12\x34\x56\x78\x9A\xBC\xDE\xF0\x11\x22\x33\x44"_b;
+        for (const auto read_bits : {4, 8, 12, 16, 32})
+        {
+            io::MemoryByteStream stream(input);
+            T borrowed_stream(stream);
+            T owned_stream(input);
+            REQUIRE((owned_stream.read(read_bits)
+                == borrowed_stream.read(read_bits)));
+            for (auto *bit_stream : {&borrowed_stream, &owned_stream})
+            {
+                bit_stream->write(8, 0xFF);
+                bit_stream->write(4, 0x5);
+                bit_stream->flush();
+            }
+            borrowed_stream.seek(0);
+            owned_stream.seek(0);
+            REQUIRE((owned_stream.read(32) == borrowed_stream.read(32)));
+            REQUIRE((owned_stream.read(32) == borrowed_stream.read(32)));
+            REQUIRE((owned_stream.read(32) == borrowed_stream.read(32)));
+        }
+    }
+}
+
 TEST_CASE("BaseBitStream", "[io]")
 {
     test_reading_missing_bits<io::MsbBitStream>();
@@ -443,6 +564,8 @@ TEST_CASE("LsbBitStream", "[io]")
     test_reading_single_bits<io::LsbBitStream>(TestType::Lsb);
     test_reading_multiple_bits<io::LsbBitStream>(TestType::Lsb);
     test_reading_multiple_bytes<io::LsbBitStream>(TestType::Lsb);
+    test_peeking<io::LsbBitStream>(TestType::Lsb);
+    test_word_refill<io::LsbBitStream>();
 }
 
 TEST_CASE("MsbBitStream", "[io]")
@@ -451,4 +574,54 @@ TEST_CASE("MsbBitStream", "[io]")
     test_reading_multiple_bits<io::MsbBitStream>(TestType::Msb);
     test_reading_multiple_bytes<io::MsbBitStream>(TestType::Msb);
     test_writing<io::MsbBitStream>(TestType::Msb);
+    test_peeking<io::MsbBitStream>(TestType::Msb);
+    test_word_refill<io::MsbBitStream>();
+    test_writing_after_reading<io::MsbBitStream>();
+}
+
+template<class T> static void benchmark_reading(const std::string &name)
+{
+    bstr input(16 * 1024 * 1024);
+    for (const auto i : algo::range(input.size()))
+        input[i] = i * 7 + (i >> 5);
+    const size_t bit_count = input.size() * 8;
+    const size_t widths[] = {1, 3, 8, 1, 13, 5, 1, 2, 17, 1, 9, 4};
+
+    const auto read_all = [&](T &reader)
+    {
+        u32 checksum = 0;
+        size_t left = bit_count, i = 0;
+        while (left >= 32)
+        {
+            const auto bits = widths[i++ % 12];
+            checksum += reader.read(bits);
+            left -= bits;
+        }
+        return checksum;
+    };
+
+    u32 borrowed_checksum = 0, owned_checksum = 0;
+    const auto borrowed_time = tests::measure_seconds([&]()
+    {
+        io::MemoryByteStream stream(input);
+        T reader(stream);
+        borrowed_checksum = read_all(reader);
+    });
+    const auto owned_time = tests::measure_seconds([&]()
+    {
+        T reader(input);
+        owned_checksum = read_all(reader);
+    });
+
+    REQUIRE(owned_checksum == borrowed_checksum);
+    tests::report_throughput(
+        name + ", byte stream", bit_count, "bits", borrowed_time);
+    tests::report_throughput(
+        name + ", owned buffer", bit_count, "bits", owned_time);
+}
+
+TEST_CASE("Bit stream reading throughput", "[.benchmark][io]")
+{
+    benchmark_reading<io::MsbBitStream>("MSB");
+    benchmark_reading<io::LsbBitStream>("LSB");
 }
@@ -0,0 +1,102 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "io/mapped_file_byte_stream.h"
+#include "err.h"
+#include "io/file_byte_stream.h"
+#include "io/file_system.h"
+#include "test_support/catch.h"
+#include "test_support/common.h"
+
+using namespace au;
+
+TEST_CASE("MappedFileByteStream", "[io][stream]")
+{
+    SECTION("Reading from existing files")
+    {
+        static const bstr png_magic = "\x89PNG"_b;
+        io::MappedFileByteStream stream(
+            "tests/dec/png/files/reimu_transparent.png");
+        tests::compare_binary(stream.read(png_magic.size()), png_magic);
+    }
+
+    SECTION("Reading the same data as FileByteStream")
+    {
+        const io::path path = "tests/dec/png/files/reimu_transparent.png";
+        io::MappedFileByteStream mapped_stream(path);
+        io::FileByteStream file_stream(path, io::FileMode::Read);
+        REQUIRE(mapped_stream.size() == file_stream.size());
+        tests::compare_binary(
+            mapped_stream.seek(10).read(100),
+            file_stream.seek(10).read(100));
+        tests::compare_binary(
+            mapped_stream.seek(0).read_to_eof(),
+            file_stream.seek(0).read_to_eof());
+    }
+
+    SECTION("Clones keep their own position")
+    {
+        io::MappedFileByteStream stream(
+            "tests/dec/png/files/reimu_transparent.png");
+        stream.seek(1);
+        const auto clone = stream.clone();
+        REQUIRE(clone->pos() == 1);
+        REQUIRE(clone->read(3) == "PNG"_b);
+        REQUIRE(stream.pos() == 1);
+        stream.seek(0);
+        REQUIRE(clone->pos() == 4);
+        REQUIRE(clone->size() == stream.size());
+    }
+
+    SECTION("Reading and seeking beyond EOF throws errors")
+    {
+        io::MappedFileByteStream stream(
+            "tests/dec/png/files/reimu_transparent.png");
+        REQUIRE_THROWS(stream.seek(stream.size() + 1));
+        stream.seek(stream.size() - 1);
+        REQUIRE_THROWS(stream.read(2));
+    }
+
+    SECTION("Writing throws errors")
+    {
+        io::MappedFileByteStream stream(
+            "tests/dec/png/files/reimu_transparent.png");
+        REQUIRE_THROWS(stream.write("test"_b));
+        REQUIRE_THROWS(stream.resize(0));
+    }
+
+    SECTION("Mapping empty files")
+    {
+        REQUIRE(!io::exists("tests/trash.out"));
+        {
+            io::FileByteStream stream("tests/trash.out", io::FileMode::Write);
+        }
+        {
+            io::MappedFileByteStream stream("tests/trash.out");
+            REQUIRE(stream.size() == 0);
+            REQUIRE(stream.read_to_eof() == ""_b);
+        }
+        io::remove("tests/trash.out");
+    }
+
+    SECTION("Mapping missing files throws errors")
+    {
+        REQUIRE_THROWS_AS(
+            io::MappedFileByteStream("tests/nonexistent.out"),
+            err::FileNotFoundError);
+    }
+}
@@ -29,4 +29,31 @@ TEST_CASE("MemoryByteStream", "[io][stream]")
             []() { return std::make_unique<io::MemoryByteStream>(); },
             []() { });
     }
+
+    SECTION("Writing clones that share the buffer")
+    {
+        io::MemoryByteStream stream("abcd"_b);
+        const auto clone = stream.clone();
+        stream.seek(2);
+        stream.write(*clone);
+        REQUIRE(stream.pos() == 6);
+        REQUIRE(stream.seek(0).read_to_eof() == "ababcd"_b);
+    }
+
+    SECTION("Read size checks")
+    {
+        io::MemoryByteStream stream("abc"_b);
+        REQUIRE(!io::ReadSizeCheck::enabled());
+        {
+            const io::ReadSizeCheck outer_check;
+            {
+                const io::ReadSizeCheck inner_check;
+                REQUIRE(io::ReadSizeCheck::enabled());
+            }
+            REQUIRE(io::ReadSizeCheck::enabled());
+            REQUIRE_THROWS(stream.read(0x7FFFFFFF));
+            REQUIRE(stream.read(3) == "abc"_b);
+        }
+        REQUIRE(!io::ReadSizeCheck::enabled());
+    }
 }
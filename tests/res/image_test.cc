@@ -17,6 +17,7 @@
 
 #include "res/image.h"
 #include "algo/range.h"
+#include "err.h"
 #include "test_support/catch.h"
 
 using namespace au;
@@ -269,3 +270,22 @@ TEST_CASE("Image offsetting", "[res]")
         }
     }
 }
+
+TEST_CASE("Image palettes", "[res]")
+{
+    res::Palette palette(2);
+    palette[0] = {1, 2, 3, 4};
+    palette[1] = {5, 6, 7, 8};
+    const res::Image image(20, 1, "\x00\x01\x02\xFF"_b + bstr(16), palette);
+    REQUIRE(image.at(0, 0) == (res::Pixel {1, 2, 3, 4}));
+    REQUIRE(image.at(1, 0) == (res::Pixel {5, 6, 7, 8}));
+    REQUIRE(image.at(2, 0) == (res::Pixel {2, 2, 2, 0}));
+    REQUIRE(image.at(3, 0) == (res::Pixel {0xFF, 0xFF, 0xFF, 0}));
+    REQUIRE(image.at(4, 0) == (res::Pixel {1, 2, 3, 4}));
+    REQUIRE_THROWS_AS(
+        res::Image(20, 2, bstr(39), palette), err::BadDataSizeError);
+    REQUIRE_THROWS_AS(
+        res::Image(0, 2, bstr(4), palette), err::BadDataSizeError);
+    REQUIRE_THROWS_AS(
+        res::Image(2, 0, bstr(4), palette), err::BadDataSizeError);
+}
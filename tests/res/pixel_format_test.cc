@@ -18,6 +18,8 @@
 #include "res/pixel_format.h"
 #include "algo/format.h"
 #include "algo/range.h"
+#include "res/image.h"
+#include "test_support/benchmark.h"
 #include "test_support/catch.h"
 
 using namespace au;
@@ -126,4 +128,86 @@ TEST_CASE("PixelFormat", "[res]")
         test_read(
             0b11111110000000010000001000000011, PF::RGBnA8888, {1, 2, 3, 1});
     }
+
+    SECTION("Reading rows")
+    {
+        // whole rows go through vectorized kernels, single pixels don't
+        const size_t count = 101;
+        bstr input(count * 4);
+        u32 seed = 1;
+        for (auto &c : input)
+        {
+            seed = seed * 1103515245 + 12345;
+            c = seed >> 16;
+        }
+        const auto format_count = static_cast<int>(res::PixelFormat::Count);
+        for (const auto i : algo::range(format_count))
+        {
+            const auto fmt = static_cast<res::PixelFormat>(i);
+            const auto bpp = res::pixel_format_to_bpp(fmt);
+            std::vector<res::Pixel> actual_pixels(count);
+            res::read_pixels(input.get<u8>(), actual_pixels, fmt);
+            for (const auto j : algo::range(count))
+            {
+                res::Pixel expected_pixel;
+                res::read_pixels(
+                    input.get<u8>() + j * bpp, &expected_pixel, 1, fmt);
+                compare_pixels(actual_pixels[j], expected_pixel);
+            }
+        }
+    }
+}
+
+TEST_CASE("PixelFormat conversion throughput", "[.benchmark][res]")
+{
+    using PF = res::PixelFormat;
+    static const std::vector<std::pair<PF, std::string>> formats =
+    {
+        {PF::Gray8, "Gray8"},
+        {PF::BGR555X, "BGR555X"},
+        {PF::BGR565, "BGR565"},
+        {PF::BGR888, "BGR888"},
+        {PF::BGR888X, "BGR888X"},
+        {PF::BGRA4444, "BGRA4444"},
+        {PF::BGRA5551, "BGRA5551"},
+        {PF::BGRA8888, "BGRA8888"},
+        {PF::BGRnA4444, "BGRnA4444"},
+        {PF::BGRnA5551, "BGRnA5551"},
+        {PF::BGRnA8888, "BGRnA8888"},
+        {PF::RGB555X, "RGB555X"},
+        {PF::RGB565, "RGB565"},
+        {PF::RGB888, "RGB888"},
+        {PF::RGB888X, "RGB888X"},
+        {PF::RGBA4444, "RGBA4444"},
+        {PF::RGBA5551, "RGBA5551"},
+        {PF::RGBA8888, "RGBA8888"},
+        {PF::RGBnA4444, "RGBnA4444"},
+        {PF::RGBnA5551, "RGBnA5551"},
+        {PF::RGBnA8888, "RGBnA8888"},
+    };
+
+    const size_t pixel_count = 1024 * 1024;
+    const size_t repetitions = 20;
+    const bstr input(pixel_count * 4, '\x5A');
+    std::vector<res::Pixel> output(pixel_count);
+    for (const auto &kv : formats)
+    {
+        const auto seconds = tests::measure_seconds([&]()
+        {
+            for (const auto i : algo::range(repetitions))
+                res::read_pixels(input.get<const u8>(), output, kv.first);
+        });
+        tests::report_throughput(
+            kv.second, repetitions * pixel_count / 1e6, "MP", seconds);
+    }
+
+    res::Image image(1024, 1024);
+    const res::Palette palette(256, input, PF::BGRA8888);
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(repetitions))
+            image = res::Image(1024, 1024, input, palette);
+    });
+    tests::report_throughput(
+        "Palette", repetitions * pixel_count / 1e6, "MP", seconds);
 }
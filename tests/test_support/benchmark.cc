@@ -0,0 +1,45 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "test_support/benchmark.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace au;
+
+double tests::measure_seconds(const std::function<void()> &callback)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    callback();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+void tests::report_throughput(
+    const std::string &label,
+    const double amount,
+    const std::string &unit,
+    const double seconds)
+{
+    std::printf(
+        "%-40s %12.2f %s/s (%.03fs)\n",
+        label.c_str(),
+        seconds > 0 ? amount / seconds : 0.0,
+        unit.c_str(),
+        seconds);
+    std::fflush(stdout);
+}
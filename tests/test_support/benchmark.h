@@ -0,0 +1,37 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace au {
+namespace tests {
+
+    // Benchmarks are regular test cases hidden behind the [.benchmark] tag;
+    // run them with `run_tests [benchmark]` on an optimized build.
+
+    double measure_seconds(const std::function<void()> &callback);
+
+    void report_throughput(
+        const std::string &label,
+        const double amount,
+        const std::string &unit,
+        const double seconds);
+
+} }
@@ -24,7 +24,10 @@ using namespace au;
 std::vector<std::shared_ptr<io::File>> tests::flow_unpack(
     const dec::Registry &registry,
     const bool enable_nested_decoding,
-    io::File &input_file)
+    io::File &input_file,
+    const std::vector<std::string> &arguments,
+    const size_t max_inflight_tasks,
+    const uoff_t max_memory)
 {
     Logger dummy_logger;
     dummy_logger.mute();
@@ -43,8 +46,10 @@ std::vector<std::shared_ptr<io::File>> tests::flow_unpack(
         file_saver,
         registry,
         enable_nested_decoding,
-        {},
-        std::set<std::string>(name_list.begin(), name_list.end()));
+        arguments,
+        std::set<std::string>(name_list.begin(), name_list.end()),
+        max_inflight_tasks,
+        max_memory);
 
     flow::ParallelUnpacker unpacker(context);
     unpacker.add_input_file(
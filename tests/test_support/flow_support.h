@@ -26,6 +26,9 @@ namespace tests {
     std::vector<std::shared_ptr<io::File>> flow_unpack(
         const dec::Registry &registry,
         const bool enable_ensted_decoding,
-        io::File &input_file);
+        io::File &input_file,
+        const std::vector<std::string> &arguments = {},
+        const size_t max_inflight_tasks = 0,
+        const uoff_t max_memory = 0);
 
 } }
@@ -0,0 +1,150 @@
+// Copyright (C) 2016 by rr-
+//
+// This file is part of arc_unpacker.
+//
+// arc_unpacker is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at
+// your option) any later version.
+//
+// arc_unpacker is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with arc_unpacker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "virtual_file_system.h"
+#include "algo/format.h"
+#include "algo/range.h"
+#include "algo/str.h"
+#include "io/file_system.h"
+#include "test_support/benchmark.h"
+#include "test_support/catch.h"
+
+using namespace au;
+
+static std::function<std::unique_ptr<io::File>()> make_factory(
+    const std::string &content)
+{
+    return [content]()
+    {
+        return std::make_unique<io::File>("dummy", bstr(content));
+    };
+}
+
+static std::string read(const std::unique_ptr<io::File> &file)
+{
+    REQUIRE(file);
+    return file->stream.seek(0).read_to_eof().str();
+}
+
+TEST_CASE("VirtualFileSystem", "[core]")
+{
+    VirtualFileSystem::clear();
+
+    SECTION("Lookups are case insensitive")
+    {
+        VirtualFileSystem::register_file("dir/Test.TXT", make_factory("a"));
+        REQUIRE(read(VirtualFileSystem::get_by_stem("test")) == "a");
+        REQUIRE(read(VirtualFileSystem::get_by_name("TEST.txt")) == "a");
+        REQUIRE(read(VirtualFileSystem::get_by_path("DIR/test.txt")) == "a");
+        REQUIRE(!VirtualFileSystem::get_by_stem("dir"));
+        REQUIRE(!VirtualFileSystem::get_by_name("test"));
+        REQUIRE(!VirtualFileSystem::get_by_path("test.txt"));
+    }
+
+    SECTION("Ambiguous lookups prefer the first path")
+    {
+        VirtualFileSystem::register_file("b/test.txt", make_factory("b"));
+        VirtualFileSystem::register_file("a/test.dat", make_factory("a"));
+        VirtualFileSystem::register_file("c/test.txt", make_factory("c"));
+        REQUIRE(read(VirtualFileSystem::get_by_stem("test")) == "a");
+        REQUIRE(read(VirtualFileSystem::get_by_name("test.txt")) == "b");
+        VirtualFileSystem::unregister_file("A/TEST.DAT");
+        VirtualFileSystem::unregister_file("b/test.txt");
+        REQUIRE(read(VirtualFileSystem::get_by_stem("test")) == "c");
+        REQUIRE(read(VirtualFileSystem::get_by_name("test.txt")) == "c");
+        VirtualFileSystem::unregister_file("c/test.txt");
+        REQUIRE(!VirtualFileSystem::get_by_stem("test"));
+        REQUIRE(!VirtualFileSystem::get_by_name("test.txt"));
+    }
+
+    SECTION("Registering the same path twice replaces the factory")
+    {
+        VirtualFileSystem::register_file("test.txt", make_factory("a"));
+        VirtualFileSystem::register_file("TEST.txt", make_factory("b"));
+        REQUIRE(read(VirtualFileSystem::get_by_stem("test")) == "b");
+        VirtualFileSystem::unregister_file("test.txt");
+        REQUIRE(!VirtualFileSystem::get_by_stem("test"));
+    }
+
+    SECTION("Factories can perform nested lookups")
+    {
+        VirtualFileSystem::register_file("inner.txt", make_factory("a"));
+        VirtualFileSystem::register_file("outer.txt", []()
+        {
+            return VirtualFileSystem::get_by_name("inner.txt");
+        });
+        REQUIRE(read(VirtualFileSystem::get_by_stem("outer")) == "a");
+    }
+
+    SECTION("Disabled")
+    {
+        VirtualFileSystem::register_file("test.txt", make_factory("a"));
+        VirtualFileSystem::disable();
+        REQUIRE(!VirtualFileSystem::get_by_stem("test"));
+        VirtualFileSystem::enable();
+        REQUIRE(read(VirtualFileSystem::get_by_stem("test")) == "a");
+    }
+
+    SECTION("Directories")
+    {
+        const io::path directory = "tests/dec/silky/files/akb";
+        const auto path = directory / "HINT02.AKB";
+        REQUIRE(!VirtualFileSystem::get_by_name("hint02.akb"));
+        VirtualFileSystem::register_directory(directory);
+        const auto size = io::FileByteStream(path, io::FileMode::Read).size();
+        const auto file1 = VirtualFileSystem::get_by_stem("hint02");
+        const auto file2 = VirtualFileSystem::get_by_name("hint02.akb");
+        const auto file3 = VirtualFileSystem::get_by_path(
+            algo::lower(path.str()));
+        REQUIRE(file1);
+        REQUIRE(file2);
+        REQUIRE(file3);
+        REQUIRE(file1->stream.size() == size);
+        REQUIRE(file2->path == path);
+        REQUIRE(file3->path == path);
+        VirtualFileSystem::register_file("hint02.txt", make_factory("a"));
+        REQUIRE(read(VirtualFileSystem::get_by_stem("hint02")) == "a");
+        VirtualFileSystem::unregister_directory(directory);
+        REQUIRE(!VirtualFileSystem::get_by_name("hint02.akb"));
+    }
+}
+
+TEST_CASE("VirtualFileSystem lookup throughput", "[.benchmark]")
+{
+    static const size_t file_count = 10000;
+    static const size_t lookup_count = 20000;
+    for (const auto i : algo::range(file_count))
+    {
+        VirtualFileSystem::register_file(
+            algo::format("archive/dir/file%05d.dat", i), make_factory(""));
+    }
+
+    size_t found = 0;
+    const auto seconds = tests::measure_seconds([&]()
+    {
+        for (const auto i : algo::range(lookup_count))
+        {
+            const auto stem = algo::format(
+                "FILE%05d", (i * 7919) % file_count);
+            if (VirtualFileSystem::get_by_stem(stem))
+                found++;
+        }
+    });
+    REQUIRE(found == lookup_count);
+    tests::report_throughput(
+        "get_by_stem, 10k files", lookup_count, "lookups", seconds);
+}